@@ -0,0 +1,530 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_util.h"
+#include "dungeon_controller.h"
+#include "dungeon_loader.h"
+#include "tree.h"
+#include "worldgen_config.h"
+
+/*
+ * Benchmark driver for the tree, loader, movement and render APIs.
+ *
+ *   a1_bench [--suite tree|loader|movement|render|all] [--format json|csv|text]
+ *            [--out FILE] [--max-elements N] [--rooms N] [--room-width W]
+ *            [--room-height H] [--seed S] [--quick]
+ *
+ * Tree cases run at 1e3, 1e4, ... up to --max-elements. Controller cases use a
+ * synthetic world of --rooms rooms written to a temporary .ini.
+ */
+
+#define TARGET_SAMPLES 100
+
+typedef struct {
+    const char *suite;
+    BenchFormat format;
+    const char *out_path;
+    long max_elements;
+    int rooms;
+    int room_width;
+    int room_height;
+    unsigned seed;
+    int quick;
+} BenchOptions;
+
+static unsigned rng_state;
+
+static unsigned next_rand(void){
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void shuffle(int *a, long n){
+    for (long i = n - 1; i > 0; i--) {
+        long j = (long)(next_rand() % (unsigned)(i + 1));
+        int t = a[i];
+        a[i] = a[j];
+        a[j] = t;
+    }
+}
+
+static int compare_ints(const void *a, const void *b){
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static long long int_key(const void *data){
+    return *(const int *)data;
+}
+
+static void print_int(const void *data){
+    printf("%d\n", *(const int *)data);
+}
+
+static int wants(const BenchOptions *opt, const char *suite){
+    return strcmp(opt->suite, "all") == 0 || strcmp(opt->suite, suite) == 0;
+}
+
+// -------------------------
+// Tree
+// -------------------------
+
+static void bench_tree_size(BenchReport *report, long n){
+    int *keys = malloc((size_t)n * sizeof(int));
+    int *order = malloc((size_t)n * sizeof(int));
+    if (!keys || !order) {
+        free(keys);
+        free(order);
+        return;
+    }
+    for (long i = 0; i < n; i++) keys[i] = (int)i;
+    shuffle(keys, n);
+    memcpy(order, keys, (size_t)n * sizeof(int));
+    shuffle(order, n);
+
+    long batch = n / TARGET_SAMPLES > 0 ? n / TARGET_SAMPLES : 1;
+    BenchSamples s = {0};
+
+    Tree *tree = createTree(print_int, compare_ints, NULL);
+    for (long i = 0; i < n; i += batch) {
+        long end = i + batch < n ? i + batch : n;
+        uint64_t t0 = bench_now_ns();
+        for (long k = i; k < end; k++) insertData(tree, &keys[k]);
+        bench_samples_add(&s, (uint64_t)(end - i), bench_now_ns() - t0, 0);
+    }
+    bench_report_add(report, "tree", "insertData", n, &s);
+    bench_samples_free(&s);
+
+    volatile uintptr_t sink = 0;
+    for (long i = 0; i < n; i += batch) {
+        long end = i + batch < n ? i + batch : n;
+        uint64_t t0 = bench_now_ns();
+        for (long k = i; k < end; k++) sink += (uintptr_t)findData(tree, &order[k]);
+        bench_samples_add(&s, (uint64_t)(end - i), bench_now_ns() - t0, 0);
+    }
+    bench_report_add(report, "tree", "findData", n, &s);
+    bench_samples_free(&s);
+
+    // Repeat full walks until roughly a million elements have been visited.
+    long walks = 1000000 / n > 5 ? 1000000 / n : 5;
+    for (long w = 0; w < walks; w++) {
+        uint64_t t0 = bench_now_ns();
+        TreeIterator *iter = createIterator(tree);
+        uint64_t visited = 0;
+        while (nextData(iter) != NULL) visited++;
+        destroyIterator(iter);
+        bench_samples_add(&s, visited, bench_now_ns() - t0, 0);
+    }
+    bench_report_add(report, "tree", "iterate", n, &s);
+    bench_samples_free(&s);
+
+    // The same lookups once the tree is frozen into its Eytzinger layout.
+    if (freezeTree(tree, int_key) == TREE_OK) {
+        for (long i = 0; i < n; i += batch) {
+            long end = i + batch < n ? i + batch : n;
+            uint64_t t0 = bench_now_ns();
+            for (long k = i; k < end; k++) sink += (uintptr_t)findData(tree, &order[k]);
+            bench_samples_add(&s, (uint64_t)(end - i), bench_now_ns() - t0, 0);
+        }
+        bench_report_add(report, "tree", "findData_frozen", n, &s);
+        bench_samples_free(&s);
+    }
+
+    // Empty the tree one item at a time, then refill it and erase it in runs of 100 keys.
+    for (long i = 0; i < n; i += batch) {
+        long end = i + batch < n ? i + batch : n;
+        uint64_t t0 = bench_now_ns();
+        for (long k = i; k < end; k++) removeData(tree, &order[k], NULL);
+        bench_samples_add(&s, (uint64_t)(end - i), bench_now_ns() - t0, 0);
+    }
+    bench_report_add(report, "tree", "removeData", n, &s);
+    bench_samples_free(&s);
+
+    for (long k = 0; k < n; k++) insertData(tree, &keys[k]);
+    const int run = 100;
+    for (long lo = 0; lo < n; lo += run) {
+        int from = (int)lo;
+        int to = (int)(lo + run - 1 < n ? lo + run - 1 : n - 1);
+        size_t removed = 0;
+        uint64_t t0 = bench_now_ns();
+        removeRange(tree, &from, &to, 0, &removed);
+        bench_samples_add(&s, (uint64_t)removed, bench_now_ns() - t0, 0);
+    }
+    bench_report_add(report, "tree", "removeRange_100", n, &s);
+    bench_samples_free(&s);
+    (void)sink;
+
+    destroyTree(tree);
+    free(keys);
+    free(order);
+}
+
+static void bench_tree(BenchReport *report, const BenchOptions *opt){
+    for (long n = 1000; n <= opt->max_elements; n *= 10) {
+        bench_tree_size(report, n);
+    }
+}
+
+// -------------------------
+// Loader
+// -------------------------
+
+static void bench_loader(BenchReport *report, const BenchOptions *opt){
+    char path[] = "/tmp/a1_bench_worldXXXXXX";
+    if (bench_temp_path(path) != 0) return;
+
+    for (int rooms = 10; rooms <= opt->rooms; rooms *= 10) {
+        if (bench_write_world_ini(path, rooms, opt->room_width, opt->room_height, opt->seed) != 0) break;
+        BenchSamples s = {0};
+        int reps = opt->quick ? 3 : 10;
+        for (int r = 0; r < reps; r++) {
+            int loaded = 0;
+            uint64_t t0 = bench_now_ns();
+            Tree *tree = load_dungeon(path, NULL, &loaded);
+            uint64_t elapsed = bench_now_ns() - t0;
+            destroyTree(tree);
+            if (tree == NULL || loaded <= 0) break;
+            bench_samples_add(&s, (uint64_t)loaded, elapsed, 0);   // ns per room
+        }
+        bench_report_add(report, "loader", "load_dungeon_per_room", rooms, &s);
+        bench_samples_free(&s);
+
+        // Same world through the native generator: parse once, build from memory.
+        DungeonConfig config;
+        if (worldgen_config_load(path, &config, NULL) != CONFIG_OK) continue;
+        for (int r = 0; r < reps; r++) {
+            int loaded = 0;
+            uint64_t t0 = bench_now_ns();
+            Tree *tree = load_dungeon_from_config(&config, NULL, &loaded);
+            uint64_t elapsed = bench_now_ns() - t0;
+            destroyTree(tree);
+            if (tree == NULL || loaded <= 0) break;
+            bench_samples_add(&s, (uint64_t)loaded, elapsed, 0);
+        }
+        bench_report_add(report, "loader", "load_dungeon_from_config_per_room", rooms, &s);
+        bench_samples_free(&s);
+
+        // ... and again with one shard per CPU.
+        for (int r = 0; r < reps; r++) {
+            int loaded = 0;
+            uint64_t t0 = bench_now_ns();
+            Tree *tree = load_dungeon_sharded(&config, 0, NULL, NULL, &loaded);
+            uint64_t elapsed = bench_now_ns() - t0;
+            destroyTree(tree);
+            if (tree == NULL || loaded <= 0) break;
+            bench_samples_add(&s, (uint64_t)loaded, elapsed, 0);
+        }
+        bench_report_add(report, "loader", "load_dungeon_sharded_per_room", rooms, &s);
+        bench_samples_free(&s);
+    }
+    remove(path);
+}
+
+// -------------------------
+// Movement and rendering
+// -------------------------
+
+static Controller *synthetic_controller(const BenchOptions *opt){
+    char path[] = "/tmp/a1_bench_worldXXXXXX";
+    if (bench_temp_path(path) != 0) return NULL;
+    Controller *ctrl = NULL;
+    if (bench_write_world_ini(path, opt->rooms, opt->room_width, opt->room_height, opt->seed) == 0) {
+        ctrl = controller_init(path);
+    }
+    remove(path);
+    return ctrl;
+}
+
+static Direction opposite(Direction d){
+    switch (d) {
+        case DIR_NORTH: return DIR_SOUTH;
+        case DIR_SOUTH: return DIR_NORTH;
+        case DIR_EAST:  return DIR_WEST;
+        default:        return DIR_EAST;
+    }
+}
+
+static void bench_movement(BenchReport *report, const BenchOptions *opt){
+    Controller *ctrl = synthetic_controller(opt);
+    if (!ctrl) {
+        fprintf(stderr, "movement: could not create synthetic world\n");
+        return;
+    }
+    const int batch = 1000;
+    const int samples = opt->quick ? 20 : TARGET_SAMPLES;
+    BenchSamples s = {0};
+
+    const Room *room = NULL;
+    get_current_room(ctrl, &room);
+    volatile int sink = 0;
+    for (int i = 0; i < samples; i++) {
+        uint64_t t0 = bench_now_ns();
+        for (int k = 0; k < batch; k++) {
+            bool ok = false;
+            is_walkable(room, k % room->width, (k / room->width) % room->height, &ok);
+            sink += ok;
+        }
+        bench_samples_add(&s, (uint64_t)batch, bench_now_ns() - t0, 0);
+    }
+    bench_report_add(report, "movement", "is_walkable", opt->rooms, &s);
+    bench_samples_free(&s);
+
+    // Bounce between two tiles so every move is a legal one.
+    static const int steps[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+    int dx = 0, dy = 0;
+    for (int i = 0; i < 4; i++) {
+        if (move_player_within_room(ctrl, steps[i][0], steps[i][1]) == CONTROLLER_OK) {
+            dx = -steps[i][0];
+            dy = -steps[i][1];
+            break;
+        }
+    }
+    if (dx != 0 || dy != 0) {
+        for (int i = 0; i < samples; i++) {
+            uint64_t t0 = bench_now_ns();
+            for (int k = 0; k < batch; k++) {
+                move_player_within_room(ctrl, dx, dy);
+                dx = -dx;
+                dy = -dy;
+            }
+            bench_samples_add(&s, (uint64_t)batch, bench_now_ns() - t0, 0);
+        }
+        bench_report_add(report, "movement", "move_player_within_room", opt->rooms, &s);
+        bench_samples_free(&s);
+    }
+
+    // Walk back and forth through one door pair.
+    Direction dir = NUM_DIRECTIONS;
+    for (int d = DIR_NORTH; d < NUM_DIRECTIONS; d++) {
+        if (move_player_direction(ctrl, (Direction)d) == CONTROLLER_OK) {
+            dir = opposite((Direction)d);
+            break;
+        }
+    }
+    if (dir != NUM_DIRECTIONS) {
+        for (int i = 0; i < samples; i++) {
+            uint64_t t0 = bench_now_ns();
+            for (int k = 0; k < batch; k++) {
+                move_player_direction(ctrl, dir);
+                dir = opposite(dir);
+            }
+            bench_samples_add(&s, (uint64_t)batch, bench_now_ns() - t0, 0);
+        }
+        bench_report_add(report, "movement", "move_player_direction", opt->rooms, &s);
+        bench_samples_free(&s);
+    }
+    (void)sink;
+    controller_free(ctrl);
+}
+
+static void bench_render(BenchReport *report, const BenchOptions *opt){
+    Controller *ctrl = synthetic_controller(opt);
+    if (!ctrl) {
+        fprintf(stderr, "render: could not create synthetic world\n");
+        return;
+    }
+    const int batch = 200;
+    const int samples = opt->quick ? 20 : TARGET_SAMPLES;
+    BenchSamples s = {0};
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t bytes = 0;
+        uint64_t t0 = bench_now_ns();
+        for (int k = 0; k < batch; k++) {
+            char *str = NULL;
+            if (render_current_room(ctrl, &str) == CONTROLLER_OK) {
+                bytes += strlen(str);
+                free(str);
+            }
+        }
+        bench_samples_add(&s, (uint64_t)batch, bench_now_ns() - t0, bytes);
+    }
+    bench_report_add(report, "render", "render_current_room", opt->rooms, &s);
+    bench_samples_free(&s);
+
+    int id = 0;
+    for (int i = 0; i < samples; i++) {
+        uint64_t bytes = 0;
+        uint64_t t0 = bench_now_ns();
+        for (int k = 0; k < batch; k++) {
+            char *str = NULL;
+            if (render_room_by_id(ctrl, id, &str) == CONTROLLER_OK) {
+                bytes += strlen(str);
+                free(str);
+            }
+            id = id < ctrl->max_room_id ? id + 1 : 0;
+        }
+        bench_samples_add(&s, (uint64_t)batch, bench_now_ns() - t0, bytes);
+    }
+    bench_report_add(report, "render", "render_room_by_id", opt->rooms, &s);
+    bench_samples_free(&s);
+
+    // The same rooms, a batch at a time into one buffer.
+    int *ids = malloc((size_t)batch * sizeof(int));
+    if (ids) {
+        id = 0;
+        for (int i = 0; i < samples; i++) {
+            for (int k = 0; k < batch; k++) {
+                ids[k] = id;
+                id = id < ctrl->max_room_id ? id + 1 : 0;
+            }
+            RenderBatch rendered;
+            uint64_t t0 = bench_now_ns();
+            if (render_rooms_batch(ctrl, ids, (size_t)batch, &rendered) == CONTROLLER_OK) {
+                bench_samples_add(&s, (uint64_t)batch, bench_now_ns() - t0, rendered.size);
+                render_batch_free(&rendered);
+            }
+        }
+        bench_report_add(report, "render", "render_rooms_batch", opt->rooms, &s);
+        bench_samples_free(&s);
+        free(ids);
+    }
+
+    // Encoded frames of the player's room, as key frames and as deltas between ticks.
+    for (int delta = 0; delta <= 1; delta++) {
+        RenderEncoder *enc = render_encoder_create(delta);
+        if (!enc) {
+            break;
+        }
+        for (int i = 0; i < samples; i++) {
+            uint64_t bytes = 0;
+            uint64_t t0 = bench_now_ns();
+            for (int k = 0; k < batch; k++) {
+                const uint8_t *frame = NULL;
+                size_t size = 0;
+                int room_id = 0;
+                controller_tick(ctrl);
+                get_player_room_id(ctrl, &room_id);
+                if (render_room_encoded(ctrl, room_id, enc, &frame, &size) == CONTROLLER_OK) {
+                    bytes += size;
+                }
+            }
+            bench_samples_add(&s, (uint64_t)batch, bench_now_ns() - t0, bytes);
+        }
+        bench_report_add(report, "render", delta ? "tick_and_render_delta" : "tick_and_render_key",
+                         opt->rooms, &s);
+        bench_samples_free(&s);
+        render_encoder_free(enc);
+    }
+
+    // Whole-dungeon map: one full draw, then a tick and an incremental update per frame.
+    MapCanvas *canvas = NULL;
+    if (map_canvas_create(ctrl, false, &canvas) == CONTROLLER_OK) {
+        const char *map = NULL;
+        uint64_t t0 = bench_now_ns();
+        render_map(ctrl, canvas, &map, NULL);
+        uint64_t elapsed = bench_now_ns() - t0;
+        bench_samples_add(&s, 1, elapsed, map != NULL ? strlen(map) : 0);
+        bench_report_add(report, "render", "render_map_full", opt->rooms, &s);
+        bench_samples_free(&s);
+
+        for (int i = 0; i < samples; i++) {
+            t0 = bench_now_ns();
+            for (int k = 0; k < batch; k++) {
+                controller_tick(ctrl);
+                render_map(ctrl, canvas, &map, NULL);
+            }
+            bench_samples_add(&s, (uint64_t)batch, bench_now_ns() - t0, 0);
+        }
+        bench_report_add(report, "render", "tick_and_render_map", opt->rooms, &s);
+        bench_samples_free(&s);
+        map_canvas_free(canvas);
+    }
+
+    controller_free(ctrl);
+}
+
+// -------------------------
+// Driver
+// -------------------------
+
+static void usage(const char *argv0){
+    fprintf(stderr,
+            "usage: %s [--suite tree|loader|movement|render|all] [--format json|csv|text]\n"
+            "          [--out FILE] [--max-elements N] [--rooms N] [--room-width W]\n"
+            "          [--room-height H] [--seed S] [--quick]\n", argv0);
+}
+
+static int parse_args(int argc, char **argv, BenchOptions *opt){
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--quick") == 0) {
+            opt->quick = 1;
+            continue;
+        }
+        if (val == NULL) return -1;
+        i++;
+        if (strcmp(arg, "--suite") == 0) {
+            opt->suite = val;
+        } else if (strcmp(arg, "--format") == 0) {
+            if (strcmp(val, "json") == 0) opt->format = BENCH_FORMAT_JSON;
+            else if (strcmp(val, "csv") == 0) opt->format = BENCH_FORMAT_CSV;
+            else if (strcmp(val, "text") == 0) opt->format = BENCH_FORMAT_TEXT;
+            else return -1;
+        } else if (strcmp(arg, "--out") == 0) {
+            opt->out_path = val;
+        } else if (strcmp(arg, "--max-elements") == 0) {
+            opt->max_elements = atol(val);
+        } else if (strcmp(arg, "--rooms") == 0) {
+            opt->rooms = atoi(val);
+        } else if (strcmp(arg, "--room-width") == 0) {
+            opt->room_width = atoi(val);
+        } else if (strcmp(arg, "--room-height") == 0) {
+            opt->room_height = atoi(val);
+        } else if (strcmp(arg, "--seed") == 0) {
+            opt->seed = (unsigned)strtoul(val, NULL, 10);
+        } else {
+            return -1;
+        }
+    }
+    if (opt->max_elements < 1000 || opt->rooms < 1 || opt->room_width < 3 || opt->room_height < 3) {
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv){
+    BenchOptions opt = {
+        .suite = "all",
+        .format = BENCH_FORMAT_TEXT,
+        .out_path = NULL,
+        .max_elements = 1000000,
+        .rooms = 100,
+        .room_width = 9,
+        .room_height = 7,
+        .seed = 1234,
+        .quick = 0,
+    };
+    if (parse_args(argc, argv, &opt) != 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (opt.quick && opt.max_elements > 100000) {
+        opt.max_elements = 100000;
+    }
+    rng_state = opt.seed ? opt.seed : 1;
+
+    BenchReport report = {0};
+    if (wants(&opt, "tree")) bench_tree(&report, &opt);
+    if (wants(&opt, "loader")) bench_loader(&report, &opt);
+    if (wants(&opt, "movement")) bench_movement(&report, &opt);
+    if (wants(&opt, "render")) bench_render(&report, &opt);
+
+    FILE *out = stdout;
+    if (opt.out_path) {
+        out = fopen(opt.out_path, "w");
+        if (!out) {
+            perror(opt.out_path);
+            bench_report_free(&report);
+            return 1;
+        }
+    }
+    bench_report_write(&report, out, opt.format);
+    if (out != stdout) fclose(out);
+    bench_report_free(&report);
+    return 0;
+}
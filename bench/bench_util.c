@@ -0,0 +1,171 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "bench_util.h"
+
+uint64_t bench_now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void bench_samples_add(BenchSamples *s, uint64_t ops, uint64_t ns, uint64_t bytes){
+    if (ops == 0) return;
+    if (s->count == s->capacity) {
+        size_t new_capacity = s->capacity ? s->capacity * 2 : 64;
+        double *grown = realloc(s->ns_per_op, new_capacity * sizeof(double));
+        if (!grown) return;
+        s->ns_per_op = grown;
+        s->capacity = new_capacity;
+    }
+    s->ns_per_op[s->count++] = (double)ns / (double)ops;
+    s->total_ops += ops;
+    s->total_ns += ns;
+    s->total_bytes += bytes;
+}
+
+void bench_samples_free(BenchSamples *s){
+    free(s->ns_per_op);
+    memset(s, 0, sizeof(*s));
+}
+
+static int compare_doubles(const void *a, const void *b){
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+double bench_percentile(const double *sorted, size_t n, double p){
+    if (n == 0) return 0.0;
+    if (n == 1) return sorted[0];
+    double rank = (p / 100.0) * (double)(n - 1);
+    size_t lo = (size_t)rank;
+    size_t hi = lo + 1 < n ? lo + 1 : lo;
+    double frac = rank - (double)lo;
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * frac;
+}
+
+int bench_report_add(BenchReport *report, const char *suite, const char *name,
+                     long long param, const BenchSamples *s){
+    if (report->count == report->capacity) {
+        size_t new_capacity = report->capacity ? report->capacity * 2 : 32;
+        BenchResult *grown = realloc(report->results, new_capacity * sizeof(BenchResult));
+        if (!grown) return -1;
+        report->results = grown;
+        report->capacity = new_capacity;
+    }
+
+    BenchResult *r = &report->results[report->count];
+    memset(r, 0, sizeof(*r));
+    snprintf(r->suite, sizeof(r->suite), "%s", suite);
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->param = param;
+    r->samples = s->count;
+    r->ops = s->total_ops;
+
+    if (s->count > 0) {
+        double *sorted = malloc(s->count * sizeof(double));
+        if (!sorted) return -1;
+        memcpy(sorted, s->ns_per_op, s->count * sizeof(double));
+        qsort(sorted, s->count, sizeof(double), compare_doubles);
+        r->p50_ns = bench_percentile(sorted, s->count, 50.0);
+        r->p90_ns = bench_percentile(sorted, s->count, 90.0);
+        r->p99_ns = bench_percentile(sorted, s->count, 99.0);
+        r->min_ns = sorted[0];
+        r->max_ns = sorted[s->count - 1];
+        free(sorted);
+    }
+    if (s->total_ns > 0) {
+        double secs = (double)s->total_ns / 1e9;
+        r->mean_ns = (double)s->total_ns / (double)s->total_ops;
+        r->ops_per_sec = (double)s->total_ops / secs;
+        r->bytes_per_sec = (double)s->total_bytes / secs;
+    }
+    report->count++;
+    return 0;
+}
+
+void bench_report_write(const BenchReport *report, FILE *out, BenchFormat format){
+    switch (format) {
+    case BENCH_FORMAT_JSON:
+        fprintf(out, "{\n  \"results\": [\n");
+        for (size_t i = 0; i < report->count; i++) {
+            const BenchResult *r = &report->results[i];
+            fprintf(out,
+                    "    {\"suite\": \"%s\", \"name\": \"%s\", \"param\": %lld, "
+                    "\"samples\": %zu, \"ops\": %llu, \"ops_per_sec\": %.1f, "
+                    "\"bytes_per_sec\": %.1f, \"mean_ns\": %.2f, \"p50_ns\": %.2f, "
+                    "\"p90_ns\": %.2f, \"p99_ns\": %.2f, \"min_ns\": %.2f, \"max_ns\": %.2f}%s\n",
+                    r->suite, r->name, r->param, r->samples, (unsigned long long)r->ops,
+                    r->ops_per_sec, r->bytes_per_sec, r->mean_ns, r->p50_ns, r->p90_ns,
+                    r->p99_ns, r->min_ns, r->max_ns, i + 1 < report->count ? "," : "");
+        }
+        fprintf(out, "  ],\n  \"peak_rss_kb\": %ld\n}\n", bench_peak_rss_kb());
+        break;
+    case BENCH_FORMAT_CSV:
+        fprintf(out, "suite,name,param,samples,ops,ops_per_sec,bytes_per_sec,"
+                     "mean_ns,p50_ns,p90_ns,p99_ns,min_ns,max_ns\n");
+        for (size_t i = 0; i < report->count; i++) {
+            const BenchResult *r = &report->results[i];
+            fprintf(out, "%s,%s,%lld,%zu,%llu,%.1f,%.1f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+                    r->suite, r->name, r->param, r->samples, (unsigned long long)r->ops,
+                    r->ops_per_sec, r->bytes_per_sec, r->mean_ns, r->p50_ns, r->p90_ns,
+                    r->p99_ns, r->min_ns, r->max_ns);
+        }
+        break;
+    case BENCH_FORMAT_TEXT:
+        fprintf(out, "%-10s %-26s %10s %14s %14s %10s %10s %10s\n",
+                "suite", "name", "param", "ops/sec", "MB/sec", "p50 ns", "p90 ns", "p99 ns");
+        for (size_t i = 0; i < report->count; i++) {
+            const BenchResult *r = &report->results[i];
+            fprintf(out, "%-10s %-26s %10lld %14.0f %14.2f %10.1f %10.1f %10.1f\n",
+                    r->suite, r->name, r->param, r->ops_per_sec, r->bytes_per_sec / 1e6,
+                    r->p50_ns, r->p90_ns, r->p99_ns);
+        }
+        fprintf(out, "peak RSS: %ld KiB\n", bench_peak_rss_kb());
+        break;
+    }
+}
+
+void bench_report_free(BenchReport *report){
+    free(report->results);
+    memset(report, 0, sizeof(*report));
+}
+
+long bench_peak_rss_kb(void){
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return -1;
+    return ru.ru_maxrss;    // kilobytes on Linux
+}
+
+int bench_write_world_ini(const char *path, int num_rooms, int room_width,
+                          int room_height, unsigned seed){
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+
+    // Lay rooms out on a square-ish grid of cells with a little slack around each room.
+    int side = (int)ceil(sqrt((double)num_rooms));
+    if (side < 1) side = 1;
+    fprintf(f, "seed=%u\n", seed);
+    fprintf(f, "num_rooms=%d\n", num_rooms);
+    fprintf(f, "map_width=%d\n", side * (room_width + 3));
+    fprintf(f, "map_height=%d\n", side * (room_height + 3));
+    fprintf(f, "base_room_width=%d\n", room_width);
+    fprintf(f, "base_room_height=%d\n", room_height);
+    fprintf(f, "room_size_variance=0\n");
+    fprintf(f, "max_monsters_per_room=2\n");
+    fprintf(f, "max_items_per_room=2\n");
+    fprintf(f, "monster_spawn_chance=50\n");
+    fprintf(f, "item_spawn_chance=50\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+int bench_temp_path(char *tmpl){
+    int fd = mkstemp(tmpl);
+    if (fd < 0) return -1;
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,107 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Shared helpers for the benchmark and load-test executables.
+ *
+ * Measurements are taken as a series of samples, each covering a batch of
+ * operations. Percentiles are computed over per-sample nanoseconds-per-op,
+ * which keeps timer overhead out of the numbers for very cheap calls.
+ */
+
+typedef enum {
+    BENCH_FORMAT_JSON,
+    BENCH_FORMAT_CSV,
+    BENCH_FORMAT_TEXT
+} BenchFormat;
+
+/**
+ * Raw samples collected for one benchmark case.
+ */
+typedef struct {
+    double *ns_per_op;      // one entry per sample
+    size_t count;
+    size_t capacity;
+    uint64_t total_ops;
+    uint64_t total_ns;
+    uint64_t total_bytes;   // optional; for throughput in bytes/sec
+} BenchSamples;
+
+/**
+ * Summary row for one benchmark case.
+ */
+typedef struct {
+    char suite[32];         // e.g. "tree", "render"
+    char name[48];          // e.g. "insertData"
+    long long param;        // size parameter (elements, rooms, ...)
+    size_t samples;
+    uint64_t ops;
+    double ops_per_sec;
+    double bytes_per_sec;   // 0 when not applicable
+    double mean_ns;
+    double p50_ns;
+    double p90_ns;
+    double p99_ns;
+    double min_ns;
+    double max_ns;
+} BenchResult;
+
+/**
+ * Growable list of results, written out in one go at the end of a run.
+ */
+typedef struct {
+    BenchResult *results;
+    size_t count;
+    size_t capacity;
+} BenchReport;
+
+/** Monotonic clock in nanoseconds. */
+uint64_t bench_now_ns(void);
+
+/** Records one sample of `ops` operations that took `ns` and produced `bytes`. */
+void bench_samples_add(BenchSamples *s, uint64_t ops, uint64_t ns, uint64_t bytes);
+
+/** Releases sample storage and resets the struct. */
+void bench_samples_free(BenchSamples *s);
+
+/** Returns the p-th percentile (0..100) of a sorted array, interpolated. */
+double bench_percentile(const double *sorted, size_t n, double p);
+
+/**
+ * Summarises `s` into a new row of `report`.
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int bench_report_add(BenchReport *report, const char *suite, const char *name,
+                     long long param, const BenchSamples *s);
+
+/** Writes every row of `report` to `out` in the chosen format. */
+void bench_report_write(const BenchReport *report, FILE *out, BenchFormat format);
+
+/** Frees the rows of `report`. */
+void bench_report_free(BenchReport *report);
+
+/** Peak resident set size of this process, in kilobytes. */
+long bench_peak_rss_kb(void);
+
+/**
+ * Writes a worldgen .ini describing a synthetic world of `num_rooms` rooms,
+ * each `room_width` x `room_height`, sized so the map fits all rooms.
+ *
+ * @return 0 on success, -1 if the file could not be written
+ */
+int bench_write_world_ini(const char *path, int num_rooms, int room_width,
+                          int room_height, unsigned seed);
+
+/**
+ * Creates a unique temporary path from `tmpl` (which must end in "XXXXXX").
+ *
+ * @return 0 on success, -1 on failure
+ */
+int bench_temp_path(char *tmpl);
+
+#endif // BENCH_UTIL_H
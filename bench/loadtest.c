@@ -0,0 +1,667 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include "bench_util.h"
+#include "dungeon_controller.h"
+#include "scheduler.h"
+#include "trace.h"
+
+/*
+ * End-to-end load test: many bots, each driving its own controller through
+ * the public API, spread over worker threads.
+ *
+ *   a1_loadtest [--config FILE] [--controllers N] [--threads T] [--steps S]
+ *               [--agent random|explore] [--render-every K] [--seed S]
+ *               [--format text|json] [--trace FILE]
+ *               [--driver direct|scheduler] [--window W]
+ *
+ * Bot i always runs on thread i % T and draws from an RNG seeded by (seed, i),
+ * so the final dungeon states, and the checksum printed over them, depend only
+ * on the seed and not on T or scheduling. Throughput and latency vary per run.
+ *
+ * --driver scheduler instead hands the controllers to a Scheduler (see
+ * scheduler.h) and feeds it from a local command generator: each step queues
+ * a random move per controller, plus a render every K steps and a visited
+ * query every GEN_VISITED_EVERY steps, keeping at most W commands in flight
+ * per controller. The run is repeated with 1, 2, 4, ... up to T workers and
+ * reports throughput, speedup over one worker, queue depth and latency for
+ * each. Per-controller ordering makes the checksum the same on every row,
+ * and the same as the direct driver's for equal --seed and --steps.
+ *
+ * --trace records load phases, moves and renders (see trace.h) and writes
+ * them to FILE as Chrome trace-event JSON.
+ */
+
+#define SUB_BUCKETS 16          // linear sub-buckets per power of two (~6% resolution)
+#define GEN_VISITED_EVERY 64    // scheduler driver: steps between visited-room queries
+
+typedef enum {
+    AGENT_RANDOM,
+    AGENT_EXPLORE
+} AgentKind;
+
+typedef enum {
+    DRIVER_DIRECT,
+    DRIVER_SCHEDULER
+} DriverKind;
+
+typedef struct {
+    const char *config;
+    int controllers;
+    int threads;
+    long steps;
+    AgentKind agent;
+    int render_every;
+    unsigned long long seed;
+    BenchFormat format;
+    const char *trace;          // output path, or NULL for no tracing
+    DriverKind driver;
+    int window;                 // scheduler driver: commands in flight per controller
+} LoadOptions;
+
+typedef struct {
+    uint64_t counts[64][SUB_BUCKETS];
+    uint64_t total;
+} LatencyHist;
+
+typedef struct {
+    Controller *ctrl;
+    uint64_t rng;
+    Direction *path;            // explore agent: directions taken, for backtracking
+    size_t path_len;
+    size_t path_cap;
+    unsigned char *seen;        // explore agent: rooms this bot has entered, by ID
+    size_t seen_cap;
+    uint64_t checksum;
+} Bot;
+
+typedef struct {
+    const LoadOptions *opt;
+    Bot *bots;
+    int thread_index;
+    uint64_t moves;
+    uint64_t moves_ok;
+    uint64_t renders;
+    uint64_t render_bytes;
+    LatencyHist latency;
+} WorkerState;
+
+// -------------------------
+// RNG and latency helpers
+// -------------------------
+
+static uint64_t splitmix64(uint64_t *state){
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static void hist_record(LatencyHist *h, uint64_t ns){
+    int msb = 0;
+    for (uint64_t v = ns; v > 1; v >>= 1) msb++;
+    // Below 2^4 the sub-bucket is the value itself; above, the next 4 bits below the MSB.
+    int sub = msb < 4 ? (int)ns : (int)((ns >> (msb - 4)) & (SUB_BUCKETS - 1));
+    h->counts[msb][sub]++;
+    h->total++;
+}
+
+static void hist_merge(LatencyHist *into, const LatencyHist *from){
+    for (int b = 0; b < 64; b++)
+        for (int s = 0; s < SUB_BUCKETS; s++)
+            into->counts[b][s] += from->counts[b][s];
+    into->total += from->total;
+}
+
+static double hist_percentile(const LatencyHist *h, double p){
+    if (h->total == 0) return 0.0;
+    uint64_t rank = (uint64_t)(p / 100.0 * (double)h->total);
+    if (rank >= h->total) rank = h->total - 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < 64; b++) {
+        for (int s = 0; s < SUB_BUCKETS; s++) {
+            seen += h->counts[b][s];
+            if (seen > rank) {
+                if (b < 4) return (double)s;
+                double width = (double)(1ull << (b - 4));
+                return (double)(1ull << b) + width * ((double)s + 0.5);
+            }
+        }
+    }
+    return 0.0;
+}
+
+// -------------------------
+// Agents
+// -------------------------
+
+static Direction opposite(Direction d){
+    switch (d) {
+        case DIR_NORTH: return DIR_SOUTH;
+        case DIR_SOUTH: return DIR_NORTH;
+        case DIR_EAST:  return DIR_WEST;
+        default:        return DIR_EAST;
+    }
+}
+
+static bool has_door(const Room *room, Direction d){
+    for (int i = 0; i < room->num_doors; i++) {
+        if (room->doors[i].dir == d) return true;
+    }
+    return false;
+}
+
+static bool bot_seen(const Bot *bot, int id){
+    return id >= 0 && (size_t)id < bot->seen_cap && bot->seen[id];
+}
+
+static void bot_mark_seen(Bot *bot, int id){
+    if (id < 0) return;
+    if ((size_t)id >= bot->seen_cap) {
+        size_t cap = bot->seen_cap ? bot->seen_cap : 64;
+        while (cap <= (size_t)id) cap *= 2;
+        unsigned char *grown = realloc(bot->seen, cap);
+        if (!grown) return;
+        memset(grown + bot->seen_cap, 0, cap - bot->seen_cap);
+        bot->seen = grown;
+        bot->seen_cap = cap;
+    }
+    bot->seen[id] = 1;
+}
+
+static ControllerStatusCode timed_move_direction(WorkerState *w, Bot *bot, Direction d){
+    uint64_t t0 = bench_now_ns();
+    ControllerStatusCode st = move_player_direction(bot->ctrl, d);
+    hist_record(&w->latency, bench_now_ns() - t0);
+    w->moves++;
+    if (st == CONTROLLER_OK) w->moves_ok++;
+    return st;
+}
+
+static ControllerStatusCode timed_move_within(WorkerState *w, Bot *bot, int dx, int dy){
+    uint64_t t0 = bench_now_ns();
+    ControllerStatusCode st = move_player_within_room(bot->ctrl, dx, dy);
+    hist_record(&w->latency, bench_now_ns() - t0);
+    w->moves++;
+    if (st == CONTROLLER_OK) w->moves_ok++;
+    return st;
+}
+
+static void random_step(WorkerState *w, Bot *bot){
+    static const int deltas[4][2] = { {0, -1}, {0, 1}, {1, 0}, {-1, 0} };
+    uint64_t r = splitmix64(&bot->rng);
+    int d = (int)(r % NUM_DIRECTIONS);
+    if ((r >> 8) % 10 < 7) {
+        timed_move_within(w, bot, deltas[d][0], deltas[d][1]);
+    } else {
+        timed_move_direction(w, bot, (Direction)d);
+    }
+}
+
+// Depth-first: step into an unvisited neighbour if one has a door, otherwise backtrack.
+static void explore_step(WorkerState *w, Bot *bot){
+    const Room *room = NULL;
+    if (get_current_room(bot->ctrl, &room) != CONTROLLER_OK) return;
+
+    int start = (int)(splitmix64(&bot->rng) % NUM_DIRECTIONS);
+    for (int i = 0; i < NUM_DIRECTIONS; i++) {
+        Direction d = (Direction)((start + i) % NUM_DIRECTIONS);
+        int next = room->neighbor_ids[d];
+        if (next < 0 || !has_door(room, d) || bot_seen(bot, next)) continue;
+        if (timed_move_direction(w, bot, d) == CONTROLLER_OK) {
+            bot_mark_seen(bot, next);
+            if (bot->path_len == bot->path_cap) {
+                size_t cap = bot->path_cap ? bot->path_cap * 2 : 64;
+                Direction *grown = realloc(bot->path, cap * sizeof(Direction));
+                if (!grown) return;
+                bot->path = grown;
+                bot->path_cap = cap;
+            }
+            bot->path[bot->path_len++] = d;
+            return;
+        }
+    }
+    if (bot->path_len > 0) {
+        timed_move_direction(w, bot, opposite(bot->path[--bot->path_len]));
+    } else {
+        random_step(w, bot);    // everything reachable is explored
+    }
+}
+
+static uint64_t fnv_mix(uint64_t h, uint64_t v){
+    for (int i = 0; i < 8; i++) {
+        h ^= (v >> (i * 8)) & 0xff;
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+static uint64_t state_checksum(const Controller *ctrl){
+    uint64_t h = 0xCBF29CE484222325ull;
+    int room = -1, x = 0, y = 0, hp = 0;
+    get_player_room_id(ctrl, &room);
+    get_player_position(ctrl, &x, &y);
+    get_player_health(ctrl, &hp);
+    h = fnv_mix(h, (uint64_t)(uint32_t)room);
+    h = fnv_mix(h, (uint64_t)(uint32_t)x);
+    h = fnv_mix(h, (uint64_t)(uint32_t)y);
+    h = fnv_mix(h, (uint64_t)(uint32_t)hp);
+    int *ids = NULL;
+    size_t n = 0;
+    if (get_visited_room_ids(ctrl, &ids, &n) == CONTROLLER_OK) {
+        for (size_t i = 0; i < n; i++) h = fnv_mix(h, (uint64_t)(uint32_t)ids[i]);
+        free(ids);
+    }
+    return h;
+}
+
+static void *worker_main(void *arg){
+    WorkerState *w = arg;
+    const LoadOptions *opt = w->opt;
+
+    // Interleave this thread's bots step by step so they all stay live for the whole run.
+    for (long step = 0; step < opt->steps; step++) {
+        for (int b = w->thread_index; b < opt->controllers; b += opt->threads) {
+            Bot *bot = &w->bots[b];
+            if (opt->agent == AGENT_EXPLORE) {
+                explore_step(w, bot);
+            } else {
+                random_step(w, bot);
+            }
+            if (opt->render_every > 0 && step % opt->render_every == 0) {
+                char *str = NULL;
+                uint64_t t0 = bench_now_ns();
+                if (render_current_room(bot->ctrl, &str) == CONTROLLER_OK) {
+                    hist_record(&w->latency, bench_now_ns() - t0);
+                    w->renders++;
+                    w->render_bytes += strlen(str);
+                    free(str);
+                }
+            }
+        }
+    }
+    for (int b = w->thread_index; b < opt->controllers; b += opt->threads) {
+        w->bots[b].checksum = state_checksum(w->bots[b].ctrl);
+    }
+    return NULL;
+}
+
+// -------------------------
+// Scheduler driver
+// -------------------------
+
+// One controller's command stream. The counters are only updated from completion
+// callbacks, which the scheduler runs one at a time per controller.
+typedef struct {
+    uint64_t rng;
+    atomic_int in_flight;
+    uint64_t renders;
+    uint64_t render_bytes;
+    uint64_t visited_queries;
+} GenStream;
+
+typedef struct {
+    int workers;
+    double secs;
+    uint64_t commands;
+    uint64_t submit_failed;
+    uint64_t renders;
+    uint64_t render_bytes;
+    uint64_t visited_queries;
+    SchedulerStats stats;
+    uint64_t checksum;
+} SchedRun;
+
+static void gen_complete(const SchedulerResult *result, void *user_data){
+    GenStream *g = user_data;
+    if (result->render != NULL) {
+        g->renders++;
+        g->render_bytes += strlen(result->render);
+        free(result->render);
+    }
+    if (result->type == SCHED_GET_VISITED && result->status == CONTROLLER_OK) {
+        g->visited_queries++;
+    }
+    free(result->visited_ids);
+    atomic_fetch_sub_explicit(&g->in_flight, 1, memory_order_release);
+}
+
+static void gen_submit(Scheduler *sched, size_t index, GenStream *g, SchedulerCommand *cmd,
+                       SchedRun *run){
+    cmd->on_complete = gen_complete;
+    cmd->user_data = g;
+    atomic_fetch_add_explicit(&g->in_flight, 1, memory_order_relaxed);
+    if (scheduler_submit(sched, index, cmd) == CONTROLLER_OK) {
+        run->commands++;
+    } else {
+        atomic_fetch_sub_explicit(&g->in_flight, 1, memory_order_relaxed);
+        run->submit_failed++;
+    }
+}
+
+// Queues one step's commands for controller `index`: the same mix of moves as random_step.
+static void gen_step(const LoadOptions *opt, Scheduler *sched, size_t index, GenStream *g,
+                     long step, SchedRun *run){
+    uint64_t r = splitmix64(&g->rng);
+    int d = (int)(r % NUM_DIRECTIONS);
+    SchedulerCommand cmd = {0};
+    if ((r >> 8) % 10 < 7) {
+        static const int deltas[4][2] = { {0, -1}, {0, 1}, {1, 0}, {-1, 0} };
+        cmd.type = SCHED_MOVE_WITHIN_ROOM;
+        cmd.dx = deltas[d][0];
+        cmd.dy = deltas[d][1];
+    } else {
+        cmd.type = SCHED_MOVE_DIRECTION;
+        cmd.dir = (Direction)d;
+    }
+    gen_submit(sched, index, g, &cmd, run);
+    if (opt->render_every > 0 && step % opt->render_every == 0) {
+        cmd = (SchedulerCommand){ .type = SCHED_RENDER_CURRENT };
+        gen_submit(sched, index, g, &cmd, run);
+    }
+    if (step % GEN_VISITED_EVERY == 0) {
+        cmd = (SchedulerCommand){ .type = SCHED_GET_VISITED };
+        gen_submit(sched, index, g, &cmd, run);
+    }
+}
+
+// Builds fresh controllers, drives them through a scheduler with `workers` workers and
+// fills `run`. Returns 0 on success, -1 if setup failed.
+static int run_scheduler(const LoadOptions *opt, int workers, SchedRun *run){
+    size_t n = (size_t)opt->controllers;
+    Controller **ctrls = calloc(n, sizeof(Controller *));
+    GenStream *streams = calloc(n, sizeof(GenStream));
+    if (!ctrls || !streams) {
+        free(ctrls);
+        free(streams);
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        ctrls[i] = controller_init(opt->config);
+        if (!ctrls[i]) {
+            fprintf(stderr, "controller_init(%s) failed for controller %zu\n", opt->config, i);
+            for (size_t k = 0; k < i; k++) controller_free(ctrls[k]);
+            free(ctrls);
+            free(streams);
+            return -1;
+        }
+        uint64_t s = opt->seed ^ ((uint64_t)i * 0xD1B54A32D192ED03ull);
+        streams[i].rng = splitmix64(&s);
+        atomic_init(&streams[i].in_flight, 0);
+    }
+    Scheduler *sched = scheduler_create(ctrls, n, workers);
+    if (!sched) {
+        for (size_t i = 0; i < n; i++) controller_free(ctrls[i]);
+        free(ctrls);
+        free(streams);
+        return -1;
+    }
+
+    *run = (SchedRun){ .workers = workers };
+    uint64_t t0 = bench_now_ns();
+    for (long step = 0; step < opt->steps; step++) {
+        for (size_t i = 0; i < n; i++) {
+            // A step queues at most three commands; wait for room in the window first.
+            while (atomic_load_explicit(&streams[i].in_flight, memory_order_acquire) + 3 > opt->window) {
+                sched_yield();
+            }
+            gen_step(opt, sched, i, &streams[i], step, run);
+        }
+    }
+    scheduler_drain(sched);
+    run->secs = (double)(bench_now_ns() - t0) / 1e9;
+
+    scheduler_get_stats(sched, SCHEDULER_ALL, &run->stats);
+    run->checksum = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < n; i++) {
+        run->renders += streams[i].renders;
+        run->render_bytes += streams[i].render_bytes;
+        run->visited_queries += streams[i].visited_queries;
+        run->checksum = fnv_mix(run->checksum, state_checksum(scheduler_controller(sched, i)));
+    }
+    scheduler_destroy(sched);
+    free(ctrls);
+    free(streams);
+    return 0;
+}
+
+static void print_sched_run(const LoadOptions *opt, const SchedRun *run, double base_rate){
+    double rate = (double)run->commands / run->secs;
+    double speedup = base_rate > 0 ? rate / base_rate : 0.0;
+    if (opt->format == BENCH_FORMAT_JSON) {
+        printf("{\"driver\": \"scheduler\", \"controllers\": %d, \"workers\": %d, \"steps\": %ld, "
+               "\"window\": %d, \"seed\": %llu, \"run_s\": %.3f, \"commands\": %llu, "
+               "\"submit_failed\": %llu, \"commands_per_sec\": %.1f, \"speedup\": %.2f, "
+               "\"efficiency\": %.2f, \"renders\": %llu, \"render_bytes\": %llu, "
+               "\"visited_queries\": %llu, \"max_queue_depth\": %zu, \"latency_mean_ns\": %llu, "
+               "\"latency_p50_ns\": %llu, \"latency_p99_ns\": %llu, \"latency_max_ns\": %llu, "
+               "\"checksum\": \"%016llx\"}\n",
+               opt->controllers, run->workers, opt->steps, opt->window, opt->seed, run->secs,
+               (unsigned long long)run->commands, (unsigned long long)run->submit_failed, rate,
+               speedup, speedup / run->workers, (unsigned long long)run->renders,
+               (unsigned long long)run->render_bytes, (unsigned long long)run->visited_queries,
+               run->stats.max_queue_depth, (unsigned long long)run->stats.latency_mean_ns,
+               (unsigned long long)run->stats.latency_p50_ns,
+               (unsigned long long)run->stats.latency_p99_ns,
+               (unsigned long long)run->stats.latency_max_ns, (unsigned long long)run->checksum);
+    } else {
+        printf("%7d %12.0f %8.2f %10.2f %9d %11llu %11llu %11llu  %016llx\n",
+               run->workers, rate, speedup, speedup / run->workers, (int)run->stats.max_queue_depth,
+               (unsigned long long)run->stats.latency_mean_ns,
+               (unsigned long long)run->stats.latency_p50_ns,
+               (unsigned long long)run->stats.latency_p99_ns, (unsigned long long)run->checksum);
+    }
+}
+
+// Runs the scheduler driver once per worker count and prints a scaling table.
+static int scheduler_main(const LoadOptions *opt){
+    if (opt->format == BENCH_FORMAT_TEXT) {
+        printf("scheduler driver: controllers %d, steps %ld, render every %d, window %d, seed %llu\n",
+               opt->controllers, opt->steps, opt->render_every, opt->window, opt->seed);
+        printf("workers     cmds/sec  speedup efficiency max_depth     mean_ns      p50_ns      p99_ns  checksum\n");
+    }
+    if (opt->trace) trace_start(0);
+    double base_rate = 0.0;
+    uint64_t failed = 0;
+    for (int workers = 1; ; workers = workers * 2 < opt->threads ? workers * 2 : opt->threads) {
+        SchedRun run;
+        if (run_scheduler(opt, workers, &run) != 0) {
+            fprintf(stderr, "could not set up a scheduler with %d workers\n", workers);
+            return 1;
+        }
+        if (workers == 1) base_rate = (double)run.commands / run.secs;
+        failed += run.submit_failed;
+        print_sched_run(opt, &run, base_rate);
+        if (workers == opt->threads) break;
+    }
+    if (opt->trace) {
+        trace_stop();
+        TraceStatusCode ts = trace_write(opt->trace);
+        if (ts != TRACE_OK) {
+            fprintf(stderr, "could not write trace to %s: %s\n", opt->trace, trace_status_string(ts));
+        }
+        trace_reset();
+    }
+    if (failed > 0) {
+        fprintf(stderr, "%llu commands could not be submitted\n", (unsigned long long)failed);
+        return 1;
+    }
+    return 0;
+}
+
+// -------------------------
+// Driver
+// -------------------------
+
+static void usage(const char *argv0){
+    fprintf(stderr,
+            "usage: %s [--config FILE] [--controllers N] [--threads T] [--steps S]\n"
+            "          [--agent random|explore] [--render-every K] [--seed S]\n"
+            "          [--format text|json] [--trace FILE]\n"
+            "          [--driver direct|scheduler] [--window W]\n", argv0);
+}
+
+static int parse_args(int argc, char **argv, LoadOptions *opt){
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char *arg = argv[i];
+        const char *val = argv[i + 1];
+        if (strcmp(arg, "--config") == 0) {
+            opt->config = val;
+        } else if (strcmp(arg, "--controllers") == 0) {
+            opt->controllers = atoi(val);
+        } else if (strcmp(arg, "--threads") == 0) {
+            opt->threads = atoi(val);
+        } else if (strcmp(arg, "--steps") == 0) {
+            opt->steps = atol(val);
+        } else if (strcmp(arg, "--agent") == 0) {
+            if (strcmp(val, "random") == 0) opt->agent = AGENT_RANDOM;
+            else if (strcmp(val, "explore") == 0) opt->agent = AGENT_EXPLORE;
+            else return -1;
+        } else if (strcmp(arg, "--render-every") == 0) {
+            opt->render_every = atoi(val);
+        } else if (strcmp(arg, "--seed") == 0) {
+            opt->seed = strtoull(val, NULL, 10);
+        } else if (strcmp(arg, "--format") == 0) {
+            if (strcmp(val, "text") == 0) opt->format = BENCH_FORMAT_TEXT;
+            else if (strcmp(val, "json") == 0) opt->format = BENCH_FORMAT_JSON;
+            else return -1;
+        } else if (strcmp(arg, "--trace") == 0) {
+            opt->trace = val;
+        } else if (strcmp(arg, "--driver") == 0) {
+            if (strcmp(val, "direct") == 0) opt->driver = DRIVER_DIRECT;
+            else if (strcmp(val, "scheduler") == 0) opt->driver = DRIVER_SCHEDULER;
+            else return -1;
+        } else if (strcmp(arg, "--window") == 0) {
+            opt->window = atoi(val);
+        } else {
+            return -1;
+        }
+    }
+    if (argc % 2 == 0) return -1;   // dangling flag without a value
+    if (opt->controllers < 1 || opt->threads < 1 || opt->steps < 0 || opt->render_every < 0) return -1;
+    // The generator cannot see command results, so it can only drive the random agent.
+    if (opt->driver == DRIVER_SCHEDULER && (opt->agent != AGENT_RANDOM || opt->window < 3)) return -1;
+    if (opt->threads > opt->controllers) opt->threads = opt->controllers;
+    return 0;
+}
+
+int main(int argc, char **argv){
+    LoadOptions opt = {
+        .config = "studentworld.ini",
+        .controllers = 8,
+        .threads = 4,
+        .steps = 100000,
+        .agent = AGENT_RANDOM,
+        .render_every = 10,
+        .seed = 1,
+        .format = BENCH_FORMAT_TEXT,
+        .driver = DRIVER_DIRECT,
+        .window = 64,
+    };
+    if (parse_args(argc, argv, &opt) != 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (opt.driver == DRIVER_SCHEDULER) {
+        return scheduler_main(&opt);
+    }
+
+    Bot *bots = calloc((size_t)opt.controllers, sizeof(Bot));
+    WorkerState *workers = calloc((size_t)opt.threads, sizeof(WorkerState));
+    pthread_t *threads = calloc((size_t)opt.threads, sizeof(pthread_t));
+    if (!bots || !workers || !threads) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    if (opt.trace) trace_start(0);
+    uint64_t init_t0 = bench_now_ns();
+    for (int i = 0; i < opt.controllers; i++) {
+        bots[i].ctrl = controller_init(opt.config);
+        if (!bots[i].ctrl) {
+            fprintf(stderr, "controller_init(%s) failed for bot %d\n", opt.config, i);
+            return 1;
+        }
+        uint64_t s = opt.seed ^ ((uint64_t)i * 0xD1B54A32D192ED03ull);
+        bots[i].rng = splitmix64(&s);
+        int start_room = -1;
+        get_player_room_id(bots[i].ctrl, &start_room);
+        bot_mark_seen(&bots[i], start_room);
+    }
+    uint64_t init_ns = bench_now_ns() - init_t0;
+
+    uint64_t run_t0 = bench_now_ns();
+    for (int t = 0; t < opt.threads; t++) {
+        workers[t].opt = &opt;
+        workers[t].bots = bots;
+        workers[t].thread_index = t;
+        if (pthread_create(&threads[t], NULL, worker_main, &workers[t]) != 0) {
+            fprintf(stderr, "could not start thread %d\n", t);
+            return 1;
+        }
+    }
+    for (int t = 0; t < opt.threads; t++) pthread_join(threads[t], NULL);
+    double secs = (double)(bench_now_ns() - run_t0) / 1e9;
+    if (opt.trace) {
+        trace_stop();
+        TraceStatusCode ts = trace_write(opt.trace);
+        if (ts != TRACE_OK) {
+            fprintf(stderr, "could not write trace to %s: %s\n", opt.trace, trace_status_string(ts));
+        }
+        trace_reset();
+    }
+
+    LatencyHist *all = calloc(1, sizeof(LatencyHist));
+    uint64_t moves = 0, moves_ok = 0, renders = 0, render_bytes = 0;
+    for (int t = 0; t < opt.threads; t++) {
+        moves += workers[t].moves;
+        moves_ok += workers[t].moves_ok;
+        renders += workers[t].renders;
+        render_bytes += workers[t].render_bytes;
+        if (all) hist_merge(all, &workers[t].latency);
+    }
+    uint64_t checksum = 0xCBF29CE484222325ull;
+    for (int i = 0; i < opt.controllers; i++) checksum = fnv_mix(checksum, bots[i].checksum);
+
+    double p50 = all ? hist_percentile(all, 50.0) : 0.0;
+    double p99 = all ? hist_percentile(all, 99.0) : 0.0;
+    if (opt.format == BENCH_FORMAT_JSON) {
+        printf("{\"controllers\": %d, \"threads\": %d, \"steps\": %ld, \"agent\": \"%s\", "
+               "\"seed\": %llu, \"init_ms\": %.3f, \"run_s\": %.3f, \"moves\": %llu, "
+               "\"moves_ok\": %llu, \"moves_per_sec\": %.1f, \"renders\": %llu, "
+               "\"renders_per_sec\": %.1f, \"render_bytes\": %llu, \"p50_ns\": %.0f, "
+               "\"p99_ns\": %.0f, \"peak_rss_kb\": %ld, \"checksum\": \"%016llx\"}\n",
+               opt.controllers, opt.threads, opt.steps,
+               opt.agent == AGENT_EXPLORE ? "explore" : "random", opt.seed,
+               (double)init_ns / 1e6, secs, (unsigned long long)moves,
+               (unsigned long long)moves_ok, (double)moves / secs, (unsigned long long)renders,
+               (double)renders / secs, (unsigned long long)render_bytes, p50, p99,
+               bench_peak_rss_kb(), (unsigned long long)checksum);
+    } else {
+        printf("controllers %d, threads %d, steps %ld, agent %s, seed %llu\n",
+               opt.controllers, opt.threads, opt.steps,
+               opt.agent == AGENT_EXPLORE ? "explore" : "random", opt.seed);
+        printf("init:     %.3f ms total\n", (double)init_ns / 1e6);
+        printf("moves:    %llu (%llu ok) in %.3f s = %.0f moves/sec\n", (unsigned long long)moves,
+               (unsigned long long)moves_ok, secs, (double)moves / secs);
+        printf("renders:  %llu = %.0f renders/sec, %.2f MB/sec\n", (unsigned long long)renders,
+               (double)renders / secs, (double)render_bytes / secs / 1e6);
+        printf("latency:  p50 %.0f ns, p99 %.0f ns\n", p50, p99);
+        printf("peak RSS: %ld KiB\n", bench_peak_rss_kb());
+        printf("checksum: %016llx\n", (unsigned long long)checksum);
+    }
+
+    free(all);
+    for (int i = 0; i < opt.controllers; i++) {
+        controller_free(bots[i].ctrl);
+        free(bots[i].path);
+        free(bots[i].seen);
+    }
+    free(bots);
+    free(workers);
+    free(threads);
+    return 0;
+}
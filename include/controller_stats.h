@@ -0,0 +1,115 @@
+#ifndef CONTROLLER_STATS_H
+#define CONTROLLER_STATS_H
+
+#include <stdint.h>
+#include "dungeon_controller.h"
+
+/**
+ * Optional runtime statistics for the controller and tree.
+ *
+ * Build with -DCONTROLLER_STATS to enable. When enabled, every public
+ * controller call records:
+ *   - a call count and a breakdown by ControllerStatusCode,
+ *   - its latency in a log2-bucketed histogram,
+ * and the tree records findData descent depth and node allocations.
+ *
+ * Counters live in per-thread shards that only their owning thread writes,
+ * so recording never contends; controller_stats_dump merges all shards.
+ *
+ * Without -DCONTROLLER_STATS the recording macros below expand to nothing,
+ * and controller_stats_dump reports that statistics are disabled.
+ */
+
+typedef enum {
+    STATS_FORMAT_TEXT,
+    STATS_FORMAT_JSON
+} StatsFormat;
+
+/**
+ * Instrumented controller entry points.
+ */
+typedef enum {
+    STAT_CONTROLLER_INIT,
+    STAT_CONTROLLER_FREE,
+    STAT_GET_CURRENT_ROOM,
+    STAT_GET_PLAYER_ROOM_ID,
+    STAT_GET_ROOM_BY_ID,
+    STAT_GET_PLAYER_POSITION,
+    STAT_GET_PLAYER_HEALTH,
+    STAT_IS_PLAYER_ALIVE,
+    STAT_MOVE_WITHIN_ROOM,
+    STAT_MOVE_DIRECTION,
+    STAT_CONTROLLER_TICK,
+    STAT_SET_ACTIVE_RADIUS,
+    STAT_ATTACH_EVENTS,
+    STAT_ATTACH_JOURNAL,
+    STAT_RENDER_CURRENT_ROOM,
+    STAT_RENDER_ROOM_BY_ID,
+    STAT_RENDER_ROOMS_BATCH,
+    STAT_RENDER_ROOM_ENCODED,
+    STAT_SET_TEMPLATE_CACHE_LIMIT,
+    STAT_TEMPLATE_CACHE_STATS,
+    STAT_RENDER_MAP,
+    STAT_GET_VISITED_ROOM_IDS,
+    STAT_IS_WALKABLE,
+    STAT_PLAYER_FOV,
+    STAT_MEMORY_USAGE,
+    STAT_FUNCTION_COUNT
+} StatFunction;
+
+/**
+ * Allocation sites that are counted.
+ */
+typedef enum {
+    STAT_ALLOC_TREE_NODE,
+    STAT_ALLOC_CONTROLLER,
+    STAT_ALLOC_RENDER_BUFFER,
+    STAT_ALLOC_VISITED_ARRAY,
+    STAT_ALLOC_SITE_COUNT
+} StatAllocSite;
+
+/**
+ * Renders the merged statistics of all threads as text or JSON.
+ *
+ * The string is heap-allocated; the caller must free() it.
+ *
+ * @return CONTROLLER_OK, CONTROLLER_INVALID_ARGUMENT, or CONTROLLER_ALLOCATION_FAILED
+ */
+ControllerStatusCode controller_stats_dump(char **out, StatsFormat format);
+
+/**
+ * Zeroes every counter in every thread's shard.
+ *
+ * Counts recorded concurrently with a reset may survive it.
+ */
+void controller_stats_reset(void);
+
+#ifdef CONTROLLER_STATS
+
+uint64_t stats_clock_ns(void);
+void stats_record_call(StatFunction fn, ControllerStatusCode status, uint64_t elapsed_ns);
+void stats_record_tree_depth(int depth);
+void stats_record_alloc(StatAllocSite site, uint64_t bytes);
+void stats_record_free(StatAllocSite site);
+
+#define STATS_CALL_BEGIN()              uint64_t stats_t0_ = stats_clock_ns()
+#define STATS_CALL_END(fn, status)      stats_record_call((fn), (status), stats_clock_ns() - stats_t0_)
+#define STATS_DEPTH_INIT(d)             int d = 0
+#define STATS_DEPTH_STEP(d)             ((d)++)
+#define STATS_DEPTH_RECORD(d)           stats_record_tree_depth(d)
+#define STATS_ALLOC(site, bytes)        stats_record_alloc((site), (bytes))
+#define STATS_FREE(site)                stats_record_free(site)
+
+#else
+
+#define STATS_CALL_BEGIN()              ((void)0)
+#define STATS_CALL_END(fn, status)      ((void)0)
+#define STATS_DEPTH_INIT(d)             ((void)0)
+#define STATS_DEPTH_STEP(d)             ((void)0)
+#define STATS_DEPTH_RECORD(d)           ((void)0)
+#define STATS_ALLOC(site, bytes)        ((void)0)
+#define STATS_FREE(site)                ((void)0)
+
+#endif // CONTROLLER_STATS
+
+#endif // CONTROLLER_STATS_H
@@ -3,8 +3,17 @@
 
 #include "structs.h"
 #include "tree.h"
+#include "worldgen_config.h"
+#include "simulation.h"
+#include "event_stream.h"
+#include "fov.h"
+#include "journal.h"
+#include "memory_account.h"
+#include "render_codec.h"
+#include "render_template.h"
 #include <stddef.h> // for size_t
 #include <stdbool.h>
+#include <stdatomic.h>
 
 /**
  * This module manages the player and dungeon state during gameplay.
@@ -15,6 +24,28 @@
  * 
  * Students must call only the public functions listed below and
  * must not modify the controller internals directly.
+ *
+ * Concurrency model:
+ * - A single writer thread owns the controller: it alone may call
+ *   controller_init, controller_free, the move_player_* functions and
+ *   controller_tick, controller_set_active_radius and the controller_attach_*
+ *   functions.
+ * - Any number of reader threads may call the getters, render_* and
+ *   get_visited_room_ids concurrently with that writer, without locking.
+ *   Readers take a consistent snapshot of the player through a seqlock and
+ *   retry if a move lands while they are reading; they never block the writer.
+ *   (Renders share a background cache behind its own reader-writer lock,
+ *   which the writer thread never takes.)
+ * - The room tree never changes after load, so Room pointers handed out by
+ *   the getters stay valid until controller_free. The only room data that
+ *   changes is monster positions, which controller_tick and move_player_direction
+ *   update inside the same seqlock write section as the player; the render_*
+ *   functions therefore always see a consistent frame. Code on other threads
+ *   must not read Monster positions from a Room pointer directly.
+ *
+ * Monsters are simulated by an active-region scheduler (see simulation.h):
+ * each controller_tick steps only the rooms within a few hops of the player,
+ * and a distant room is fast-forwarded when the player walks into it.
  */
 
 // -------------------------
@@ -42,7 +73,7 @@ typedef enum {
 // Controller Struct
 // -------------------------
 
-#define MAX_ROOMS 256  // Assumes room IDs range from 0 to MAX_ROOMS-1
+#define CONTROLLER_DEFAULT_ACTIVE_RADIUS 1  // Hops around the player's room simulated every tick
 
 /**
  * Represents the global dungeon controller state.
@@ -54,12 +85,42 @@ typedef enum {
  * the public controller_* functions.
  */
 typedef struct Controller {
-    Tree *room_tree;            // Tree of Room*, keyed by room ID
-    Player player;              // Current player state
-    int visited[MAX_ROOMS];     // visited[i] = 1 if room with ID i has been visited
+    Tree *room_tree;            // Tree of Room*, keyed by room ID; frozen once loaded
+    Player player;              // Current player state (written only by the writer thread)
+    atomic_int *visited;        // By room ID; 1 once the room has been visited
     int max_room_id;            // Highest room ID encountered (inclusive)
+    atomic_uint seq;            // Seqlock sequence guarding `player`; odd while a move is in progress
+    DungeonConfig config;       // Config the dungeon was built from (as scanned, for controller_init)
+    bool generated;             // Built by the native generator from `config` (not libworldgen)
+    Simulation *sim;            // Monster simulation over room_tree (writer thread only)
+    EventStream *events;        // Optional observer ring; the writer thread is its producer
+    Journal *journal;           // Optional write-ahead journal of successful moves and ticks
+    atomic_uint *room_versions; // By room ID; bumped whenever a render of the room would change
+    TemplateCache *templates;   // Prebuilt room backgrounds shared by all renders
+    MemoryAccount *memory;      // Bytes held by the controller and its dungeon, by category
 } Controller;
 
+/**
+ * Bytes held by one controller, by category (see controller_memory_usage).
+ */
+typedef struct {
+    size_t tree_nodes;          // room tree nodes
+    size_t rooms;               // Room structs
+    size_t entities;            // monster, item and door arrays
+    size_t render;              // cached room backgrounds and map canvases
+    size_t indexes;             // frozen lookup arrays, simulation tables, per-room versions, the controller
+    size_t total;               // sum of the above
+    size_t peak;                // highest total seen
+    uint64_t refused;           // allocations refused for the budget
+    size_t budget;              // 0 when unlimited
+} ControllerMemoryUsage;
+
+/**
+ * A preallocated whole-dungeon map that render_map redraws incrementally.
+ * Opaque; see map_canvas_create.
+ */
+typedef struct MapCanvas MapCanvas;
+
 // -------------------------
 // Initialization & Cleanup
 // -------------------------
@@ -69,12 +130,91 @@ typedef struct Controller {
  * 
  * This function loads the dungeon using the world generator config
  * and places the player in the starting room.
+ *
+ * The file is handed to libworldgen as is. It is only read beforehand
+ * (see worldgen_config_scan) to size progress reports and the composite
+ * map, so an unreadable file makes this return NULL instead of exiting
+ * the process, but no setting libworldgen accepts is rejected.
  * 
  * @param config_file Path to the worldgen .ini file
  * @return Pointer to the new controller, or NULL on failure
  */
 Controller *controller_init(const char *config_file);
 
+/**
+ * Creates a controller from an already-parsed config.
+ *
+ * The dungeon is built by the native generator (dungeon_gen.h), so no file
+ * is read. Parse once with worldgen_config_load() and call this as often as
+ * needed; the config is copied and may be reused or freed afterwards.
+ *
+ * @param config Config that passes worldgen_config_validate()
+ * @return Pointer to the new controller, or NULL if the config is invalid
+ *         or memory runs out
+ */
+Controller *controller_init_with_config(const DungeonConfig *config);
+
+/**
+ * Creates a controller from a config file, refusing to grow past a memory
+ * budget.
+ *
+ * Every tree node, Room, entity array and index the controller allocates,
+ * at load time and afterwards, is counted against `budget_bytes`. A
+ * dungeon that clearly cannot fit is refused before anything is
+ * generated. Otherwise the first allocation that would cross the budget
+ * fails, the partial dungeon is freed and CONTROLLER_ALLOCATION_FAILED is
+ * returned, so an oversized config costs at most the budget rather than
+ * pushing the host into swap. Cached room backgrounds and map canvases
+ * count against the budget too; a background that does not fit is just
+ * not cached, and map_canvas_create fails with
+ * CONTROLLER_ALLOCATION_FAILED.
+ *
+ * @param config_file Path to the worldgen .ini file
+ * @param budget_bytes Most bytes the controller may hold; 0 for no limit
+ * @param out Receives the new controller on success, NULL otherwise
+ * @return CONTROLLER_OK, CONTROLLER_INVALID_ARGUMENT for a NULL argument or
+ *         a bad config, CONTROLLER_ALLOCATION_FAILED over budget or out of
+ *         memory, or CONTROLLER_ERROR if the dungeon could not be loaded or
+ *         the player could not be placed
+ */
+ControllerStatusCode controller_init_budgeted(const char *config_file, size_t budget_bytes, Controller **out);
+
+/**
+ * controller_init_budgeted for an already-parsed config.
+ */
+ControllerStatusCode controller_init_with_config_budgeted(const DungeonConfig *config, size_t budget_bytes,
+                                                          Controller **out);
+
+/**
+ * Reports how many bytes a controller holds, by category.
+ *
+ * Counts are kept as the controller allocates and frees, so this is a few
+ * atomic loads. They cover the controller's own allocations plus its
+ * template cache and map canvases (as `render`); rendered strings, batches
+ * and encoders belong to the caller.
+ *
+ * @param out Receives the counts
+ * @return CONTROLLER_OK or CONTROLLER_INVALID_ARGUMENT
+ */
+ControllerStatusCode controller_memory_usage(const Controller *ctrl, ControllerMemoryUsage *out);
+
+/**
+ * Rebuilds a controller from its journal after a crash.
+ *
+ * The dungeon is regenerated from `config`, the journal's checkpoint is
+ * loaded, and the records logged after it are replayed, so recovery time
+ * is bounded by the checkpoint interval rather than the session length.
+ * The journal is then attached to the new controller (which writes a fresh
+ * checkpoint), and play can continue where it left off. An empty journal
+ * yields a freshly initialized controller.
+ *
+ * @param config The config the journaled session was created with
+ * @param journal Journal opened with journal_open for the same config
+ * @return Pointer to the recovered controller, or NULL if the journal
+ *         cannot be read or does not match the regenerated dungeon
+ */
+Controller *controller_recover(const DungeonConfig *config, Journal *journal);
+
 /**
  * Frees all memory associated with the controller.
  * 
@@ -82,6 +222,97 @@ Controller *controller_init(const char *config_file);
  */
 void controller_free(Controller *ctrl);
 
+// -------------------------
+// Asynchronous Initialization
+// -------------------------
+
+/**
+ * A controller being built on a background thread. Opaque; see
+ * controller_init_async.
+ */
+typedef struct ControllerLoad ControllerLoad;
+
+/**
+ * Where an asynchronous load stands. Every state but RUNNING is final.
+ */
+typedef enum {
+    CONTROLLER_LOAD_RUNNING,
+    CONTROLLER_LOAD_DONE,       // the controller is ready for controller_load_take
+    CONTROLLER_LOAD_FAILED,     // bad config or out of memory
+    CONTROLLER_LOAD_CANCELLED
+} ControllerLoadState;
+
+/**
+ * Called once, on the loading thread, right after a load reaches its
+ * final state. It may poll and take the controller, but must not call
+ * controller_load_free on the same load.
+ */
+typedef void (*ControllerLoadCallback)(ControllerLoad *load, ControllerLoadState state, void *user_data);
+
+/**
+ * Starts building a controller from a config file on a new thread and
+ * returns at once.
+ *
+ * The loading thread does the same work as controller_init: it parses
+ * the file, generates and indexes every room, and sets up the player. A
+ * caller that must stay responsive can poll the returned handle from its
+ * own loop, or pass a callback and be told when the load ends. Loads run
+ * on one thread each, so they compete with the caller for at most one
+ * core, and any number of them may be in flight at once (file-based
+ * loads take turns on the world generator).
+ *
+ * @param config_file Path to the worldgen .ini file; copied
+ * @param callback Optional completion callback
+ * @param user_data Passed to `callback`
+ * @return Handle to free with controller_load_free, or NULL if the load
+ *         could not be started
+ */
+ControllerLoad *controller_init_async(const char *config_file, ControllerLoadCallback callback,
+                                      void *user_data);
+
+/**
+ * controller_init_async for an already-parsed config, built like
+ * controller_init_with_config. The config is copied.
+ */
+ControllerLoad *controller_init_with_config_async(const DungeonConfig *config,
+                                                  ControllerLoadCallback callback, void *user_data);
+
+/**
+ * Reads a load's state and progress without blocking.
+ *
+ * @param loaded Optional; receives the rooms generated so far
+ * @param total Optional; receives the rooms in the dungeon, or 0 while the
+ *        config file is still being read
+ * @return The current state
+ */
+ControllerLoadState controller_load_poll(const ControllerLoad *load, int *loaded, int *total);
+
+/**
+ * Blocks until the load reaches a final state and returns it.
+ */
+ControllerLoadState controller_load_wait(ControllerLoad *load);
+
+/**
+ * Asks the load to stop. It stops at the next room, frees everything it
+ * built and ends as CANCELLED. Has no effect on a load already finished.
+ */
+void controller_load_cancel(ControllerLoad *load);
+
+/**
+ * Hands over the finished controller; the caller then frees it with
+ * controller_free.
+ *
+ * @return The controller once the load is DONE and only the first time;
+ *         NULL otherwise
+ */
+Controller *controller_load_take(ControllerLoad *load);
+
+/**
+ * Cancels the load if it is still running, waits for its thread and frees
+ * the handle, along with the controller if it was never taken.
+ */
+void controller_load_free(ControllerLoad *load);
+
 // -------------------------
 // Player and Room Access
 // -------------------------
@@ -146,6 +377,80 @@ ControllerStatusCode move_player_within_room(Controller *ctrl, int dx, int dy);
  */
 ControllerStatusCode move_player_direction(Controller *ctrl, Direction dir);
 
+// -------------------------
+// Simulation
+// -------------------------
+
+/**
+ * Advances the monster simulation by one tick.
+ *
+ * Rooms within the active radius of the player's room are stepped; all
+ * other rooms are left untouched and caught up later, when the player
+ * enters them. Cost scales with the number of active rooms, not with the
+ * size of the dungeon. Writer thread only.
+ *
+ * @return CONTROLLER_OK, or CONTROLLER_INVALID_ARGUMENT for null input
+ */
+ControllerStatusCode controller_tick(Controller *ctrl);
+
+/**
+ * Sets how many hops (through neighbor_ids) around the player's room are
+ * simulated every tick. 0 keeps only the player's own room active.
+ * Writer thread only.
+ *
+ * @return CONTROLLER_OK, or CONTROLLER_INVALID_ARGUMENT for null input or
+ *         a negative radius
+ */
+ControllerStatusCode controller_set_active_radius(Controller *ctrl, int hops);
+
+// -------------------------
+// Events
+// -------------------------
+
+/**
+ * Starts (or, with NULL, stops) publishing state changes to `stream`.
+ *
+ * After every move_player_* call the writer thread pushes typed events
+ * (room entered, tile moved, first visit, blocked move) into the ring, so
+ * observers no longer need to poll the getters. Pushing never locks or allocates; if the consumer falls behind,
+ * events are dropped and counted (see event_stream.h).
+ *
+ * The controller does not take ownership of the stream. Writer thread only.
+ *
+ * @return CONTROLLER_OK, or CONTROLLER_INVALID_ARGUMENT for a null controller
+ */
+ControllerStatusCode controller_attach_events(Controller *ctrl, EventStream *stream);
+
+// -------------------------
+// Persistence
+// -------------------------
+
+/**
+ * Starts (or, with NULL, stops) journaling state changes to `journal`.
+ *
+ * Attaching writes a checkpoint of the current state, so the journal
+ * always describes this controller from then on. Afterwards every
+ * successful move_player_* call and every controller_tick is appended to
+ * the journal, and a new checkpoint is written every checkpoint_interval
+ * operations (see journal.h). Journal I/O errors do not fail the moves
+ * themselves; they are sticky and reported by journal_sync, journal_poll
+ * and journal_close. Between moves the writer thread should call
+ * journal_poll so an idle session's last moves are still synced within
+ * group_commit_ms.
+ *
+ * Recovery regenerates the dungeon from the config with the native
+ * generator, so only controllers it built (controller_init_with_config and
+ * its variants) can be journaled; a controller from controller_init is
+ * refused. The controller does not take ownership of the journal. Writer
+ * thread only.
+ *
+ * @return CONTROLLER_OK, CONTROLLER_INVALID_ARGUMENT for a null controller
+ *         or one built by controller_init,
+ *         CONTROLLER_ALLOCATION_FAILED, or CONTROLLER_ERROR if the initial
+ *         checkpoint cannot be written
+ */
+ControllerStatusCode controller_attach_journal(Controller *ctrl, Journal *journal);
+
 // -------------------------
 // Rendering
 // -------------------------
@@ -166,6 +471,121 @@ ControllerStatusCode render_current_room(const Controller *ctrl, char **str);
  */
 ControllerStatusCode render_room_by_id(const Controller *ctrl, const int room_id, char **str);
 
+/**
+ * The result of render_rooms_batch: many room renders in one allocation.
+ */
+typedef struct {
+    char *data;                 // every render back to back, each NUL-terminated
+    size_t *offsets;            // offsets[i]: start of the i-th requested room in `data`
+    size_t count;               // number of rooms rendered
+    size_t size;                // total bytes in `data`
+} RenderBatch;
+
+/**
+ * Renders many rooms at once into a single contiguous buffer.
+ *
+ * The exact size of every render is known up front, so a prefix sum gives
+ * each room a disjoint slice of one buffer, and the rooms are then drawn
+ * in parallel on a shared worker pool (small batches are drawn on the
+ * calling thread). `data + offsets[i]` is byte-for-byte what
+ * render_room_by_id(ctrl, ids[i]) would return. As with separate calls,
+ * each room is a consistent snapshot on its own; a move landing mid-batch
+ * may show up in some rooms and not others.
+ *
+ * Free the result with render_batch_free.
+ *
+ * @return CONTROLLER_OK, CONTROLLER_INVALID_ARGUMENT, CONTROLLER_NOT_FOUND
+ *         if any ID does not exist (nothing is rendered), or
+ *         CONTROLLER_ALLOCATION_FAILED
+ */
+ControllerStatusCode render_rooms_batch(const Controller *ctrl, const int *ids, size_t n,
+                                        RenderBatch *out);
+
+/**
+ * Frees the buffers of a RenderBatch and zeroes it.
+ */
+void render_batch_free(RenderBatch *batch);
+
+/**
+ * Renders a room as a compact encoded frame (see render_codec.h).
+ *
+ * The frame is built from the room directly, as run-length encoded rows
+ * plus an entity overlay, or, when `enc` was created for deltas and sent
+ * this room last time, as just the tiles that changed since then. Decoding
+ * it yields exactly what render_room_by_id returns.
+ *
+ * @param enc The receiving client's encoder; holds what it was last sent
+ * @param data Receives the frame; owned by `enc` and valid until its next use
+ * @param size Receives the frame length in bytes
+ * @return CONTROLLER_OK, CONTROLLER_INVALID_ARGUMENT, CONTROLLER_NOT_FOUND
+ *         or CONTROLLER_ALLOCATION_FAILED
+ */
+ControllerStatusCode render_room_encoded(const Controller *ctrl, int room_id, RenderEncoder *enc,
+                                         const uint8_t **data, size_t *size);
+
+/**
+ * Bounds the memory used by cached room backgrounds (see render_template.h).
+ *
+ * Room renders copy their walls, floor and doors from a background cached
+ * per (width, height, door mask), then draw entities on top. The default
+ * limit is TEMPLATE_CACHE_DEFAULT_BYTES; 0 turns the cache off. Any thread.
+ *
+ * @return CONTROLLER_OK, or CONTROLLER_INVALID_ARGUMENT for null input
+ */
+ControllerStatusCode controller_set_template_cache_limit(Controller *ctrl, size_t max_bytes);
+
+/**
+ * Reads the hit, miss and eviction counters of the background cache.
+ * Any thread.
+ *
+ * @return CONTROLLER_OK, or CONTROLLER_INVALID_ARGUMENT for null input
+ */
+ControllerStatusCode controller_template_cache_stats(const Controller *ctrl, TemplateCacheStats *out);
+
+/**
+ * Allocates a composite map of the whole dungeon.
+ *
+ * When every room has its own grid_placement (the native generator), the
+ * map is config.map_width x config.map_height tiles laid out as in
+ * worldgen_config.h: the room with grid_placement `g` is drawn in grid
+ * cell `g`, clipped to the cell. Otherwise (libworldgen leaves
+ * grid_placement at -1) rooms are placed by walking neighbor_ids from the
+ * start room, each next to the room it links to; rooms that do not fit
+ * that way are drawn in rows below, and the map is sized to hold them all.
+ * With `fog_of_war` only visited rooms are drawn; unvisited cells stay
+ * blank.
+ *
+ * A canvas belongs to one controller and may be used from any single
+ * reader thread. Its memory is charged to the controller (see
+ * controller_memory_usage), so free it with map_canvas_free before
+ * freeing the controller.
+ *
+ * @return CONTROLLER_OK, CONTROLLER_INVALID_ARGUMENT, or
+ *         CONTROLLER_ALLOCATION_FAILED
+ */
+ControllerStatusCode map_canvas_create(const Controller *ctrl, bool fog_of_war, MapCanvas **canvas);
+
+/**
+ * Frees a canvas created by map_canvas_create.
+ */
+void map_canvas_free(MapCanvas *canvas);
+
+/**
+ * Brings the composite map up to date and returns it.
+ *
+ * Only rooms whose contents changed since the previous call (monsters
+ * moved, the player came or went, the room was first visited) are
+ * redrawn; the rest of the buffer is reused as is. The first call draws
+ * every room.
+ *
+ * @param map Receives the map: rows of equal width, each ending
+ *            in '\n', then a terminating NUL. Owned by the canvas and valid
+ *            until the next render_map or map_canvas_free.
+ * @param redrawn Receives the number of rooms redrawn; may be NULL
+ */
+ControllerStatusCode render_map(const Controller *ctrl, MapCanvas *canvas, const char **map,
+                                size_t *redrawn);
+
 // -------------------------
 // Visited Rooms
 // -------------------------
@@ -192,4 +612,25 @@ ControllerStatusCode get_visited_room_ids(const Controller *ctrl, int **ids, siz
  */
 ControllerStatusCode is_walkable(const Room *room, int x, int y, bool *result);
 
+/**
+ * Computes which tiles of the player's room the player can see.
+ *
+ * Uses recursive shadowcasting (see fov.h): walls and monsters block
+ * sight, doors and items do not. The result is cached in `fov` against the
+ * room's version, so asking again before any monster or the player moves
+ * costs one copy. Use fov_is_visible to test tiles, e.g. to check whether
+ * a monster can see the player. Any thread, with one context per thread.
+ *
+ * @param fov Context from fov_create, with max_radius >= radius
+ * @param visible Receives the bitset for the player's room
+ * @param words Capacity of `visible`; size it with fov_bitset_words for
+ *              the largest room
+ * @param room_id Receives the ID of the room the bitset is for; may be NULL
+ * @return CONTROLLER_OK, CONTROLLER_INVALID_ARGUMENT (including a bitset too
+ *         small for the room), CONTROLLER_NOT_FOUND or
+ *         CONTROLLER_ALLOCATION_FAILED
+ */
+ControllerStatusCode controller_player_fov(const Controller *ctrl, FovContext *fov, int radius,
+                                           uint64_t *visible, size_t words, int *room_id);
+
 #endif // DUNGEON_CONTROLLER_H
\ No newline at end of file
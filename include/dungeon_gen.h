@@ -0,0 +1,74 @@
+#ifndef DUNGEON_GEN_H
+#define DUNGEON_GEN_H
+
+#include <stdatomic.h>
+#include "structs.h"
+#include "worldgen_config.h"
+
+/**
+ * Native dungeon generator driven by a parsed DungeonConfig.
+ *
+ * Rooms fill the map grid (see worldgen_grid_columns) in row-major order:
+ * room `id` sits in cell `id`, which is also its grid_placement. Room 0 is
+ * the start room and room num_rooms-1 the exit.
+ *
+ * Every room is a pure function of (config, id): its size, monsters and
+ * items come from an RNG stream derived from `seed` and the room ID, and
+ * each door is decided by hashing the seed with the shared edge. Rooms can
+ * therefore be generated in any order, or in parallel, and adjacent rooms
+ * always agree on the doors between them.
+ *
+ * Connectivity: every east-west edge has a door, as does every north-south
+ * edge in column 0, so all rooms are reachable from the start room. Other
+ * north-south edges get a door with 40% probability.
+ */
+
+/**
+ * Progress of a dungeon load, shared with other threads.
+ *
+ * Loaders count every room they finish in `loaded` and, once `cancelled`
+ * is set, stop at the next room and free everything they built. `total`
+ * is left to whoever starts the load.
+ */
+typedef struct {
+    atomic_int loaded;          // rooms generated so far
+    atomic_int total;           // rooms expected; 0 until known
+    atomic_bool cancelled;      // set from any thread to abandon the load
+} LoadProgress;
+
+/**
+ * Generates room `id` of the dungeon described by `config`.
+ *
+ * The config must already have passed worldgen_config_validate().
+ *
+ * @return A heap-allocated Room (free with destroy_room), or NULL if `id`
+ *         is out of range or allocation fails
+ */
+Room *generate_room(const DungeonConfig *config, int id);
+
+/**
+ * Generates every room of the dungeon, `num_shards` parts at a time.
+ *
+ * The grid rows holding rooms are split into `num_shards` bands of about
+ * equal height; each band is one shard, generated on its own worker thread.
+ * A shard needs nothing from its neighbours: its rooms draw from their own
+ * per-room streams of `seed`, and the neighbor_ids and doors on a band's
+ * top and bottom edges come from the same edge hashes the adjacent band
+ * uses, so the shards fit together without a separate stitching pass. The
+ * result is therefore identical for any shard count, including 1, which
+ * runs on the calling thread.
+ *
+ * Rooms are charged to the calling thread's memory account (see
+ * memory_account.h), whichever thread generates them.
+ *
+ * The config must already have passed worldgen_config_validate().
+ *
+ * @param num_shards Number of shards; 0 or less uses one per online CPU
+ * @param progress Optional; counts rooms and is checked for cancellation
+ * @param rooms Receives config->world.num_rooms rooms, indexed by room ID
+ * @return true on success; on allocation failure or cancellation false,
+ *         with every room freed and `rooms` cleared
+ */
+bool generate_rooms(const DungeonConfig *config, int num_shards, LoadProgress *progress, Room **rooms);
+
+#endif // DUNGEON_GEN_H
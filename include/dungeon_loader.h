@@ -1,5 +1,10 @@
+#ifndef DUNGEON_LOADER_H
+#define DUNGEON_LOADER_H
+
 #include "tree.h"     // For Tree*
 #include "structs.h"  // For Room
+#include "worldgen_config.h" // For DungeonConfig
+#include "dungeon_gen.h" // For LoadProgress
 
 /**
  * Loads a procedurally generated dungeon from a config file.
@@ -11,6 +16,9 @@
  * 
  * The caller owns the returned Tree* and must call destroyTree() when done.
  *
+ * The world generator keeps global state, so concurrent calls are serialized
+ * internally; it is safe to load dungeons from several threads.
+ *
  * Optional output parameters:
  *  - `first_room_out`: receives a pointer to the starting room (i.e., the room with is_start = true).
  *  - `num_rooms_out`: receives the total number of rooms inserted into the tree.
@@ -22,4 +30,54 @@
  * @return Pointer to the tree containing all Room* nodes, or NULL on failure
  *         (e.g., file not found, parsing error, memory allocation failure).
  */
-Tree *load_dungeon(const char *config_file, Room **first_room_out, int *num_rooms_out);
\ No newline at end of file
+Tree *load_dungeon(const char *config_file, Room **first_room_out, int *num_rooms_out);
+
+/**
+ * load_dungeon() that reports progress and can be cancelled.
+ *
+ * Every room copied into the tree is counted in progress->loaded. Setting
+ * progress->cancelled from another thread stops the load at the next room;
+ * the partial tree is freed and NULL returned. A load still waiting for
+ * another thread to finish with the world generator checks for
+ * cancellation as soon as it gets its turn.
+ *
+ * @param progress Optional progress and cancellation state
+ * @return As load_dungeon(), and NULL once cancelled
+ */
+Tree *load_dungeon_with_progress(const char *config_file, LoadProgress *progress,
+                                 Room **first_room_out, int *num_rooms_out);
+
+/**
+ * Builds a dungeon from an already-parsed config using the native generator
+ * (see dungeon_gen.h), without touching the filesystem.
+ *
+ * Has the same ownership rules and optional outputs as load_dungeon(). Unlike
+ * the file-based loader it has no global state, so any number of threads may
+ * call it at once.
+ *
+ * @return Pointer to the tree, or NULL if the config fails validation or
+ *         memory runs out
+ */
+Tree *load_dungeon_from_config(const DungeonConfig *config, Room **first_room_out, int *num_rooms_out);
+
+/**
+ * Builds a dungeon from an already-parsed config, generating it in
+ * `num_shards` parallel shards (see generate_rooms in dungeon_gen.h).
+ *
+ * The dungeon is the same for every shard count and the same one
+ * load_dungeon_from_config() builds. Rooms come out in ID order, so the
+ * tree is built directly in linear time rather than by inserting them one
+ * at a time. Ownership rules and optional outputs match load_dungeon().
+ *
+ * `progress`, when given, counts rooms and is checked for cancellation as
+ * described for load_dungeon_with_progress().
+ *
+ * @param num_shards Number of shards; 0 or less uses one per online CPU
+ * @param progress   Optional progress and cancellation state
+ * @return Pointer to the tree, or NULL if the config fails validation,
+ *         memory runs out or the load was cancelled
+ */
+Tree *load_dungeon_sharded(const DungeonConfig *config, int num_shards, LoadProgress *progress,
+                           Room **first_room_out, int *num_rooms_out);
+
+#endif // DUNGEON_LOADER_H
@@ -0,0 +1,88 @@
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "structs.h"
+
+/**
+ * A lock-free single-producer / single-consumer ring of controller events.
+ *
+ * The controller's writer thread is the only producer (see
+ * controller_attach_events); exactly one other thread may consume. Slots
+ * are allocated once at creation, so pushing never locks or allocates.
+ * When the ring is full the new event is dropped and counted instead of
+ * blocking the game thread; a consumer that sees event_stream_dropped()
+ * grow knows it has a gap.
+ */
+
+typedef struct EventStream EventStream;
+
+/**
+ * Kinds of controller events.
+ */
+typedef enum {
+    EVENT_ROOM_ENTERED,         // player went through a door
+    EVENT_TILE_MOVED,           // player moved within a room
+    EVENT_FIRST_VISIT,          // player entered a room for the first time
+    EVENT_MOVE_BLOCKED          // a move_player_* call failed; see `status`
+} ControllerEventType;
+
+/**
+ * One state change. Fields that do not apply to `type` are left at -1.
+ */
+typedef struct {
+    ControllerEventType type;
+    uint64_t sequence;          // position in the stream, counting dropped events
+    uint64_t tick;              // simulation tick the event happened at
+    int room_id;                // room the player is in after the event
+    int x, y;                   // player tile after the event
+    int from_room_id;           // ROOM_ENTERED, TILE_MOVED: room before the move
+    int from_x, from_y;         // ROOM_ENTERED, TILE_MOVED: tile before the move
+    int dx, dy;                 // MOVE_BLOCKED: requested step, for move_player_within_room
+    int dir;                    // MOVE_BLOCKED: requested Direction, for move_player_direction
+    int status;                 // MOVE_BLOCKED: the ControllerStatusCode returned
+} ControllerEvent;
+
+/**
+ * Creates a ring with room for at least `capacity` events.
+ *
+ * The capacity is rounded up to a power of two.
+ *
+ * @return Pointer to the new stream, or NULL if `capacity` is 0 or
+ *         allocation fails
+ */
+EventStream *event_stream_create(size_t capacity);
+
+/**
+ * Frees the stream. No thread may be using it.
+ */
+void event_stream_destroy(EventStream *stream);
+
+/**
+ * Appends an event, filling in its `sequence`. Producer thread only.
+ *
+ * @return true if queued, false if the ring was full and the event dropped
+ */
+bool event_stream_push(EventStream *stream, const ControllerEvent *event);
+
+/**
+ * Removes up to `max` events in order. Consumer thread only.
+ *
+ * @return Number of events copied into `out`
+ */
+size_t event_stream_pop(EventStream *stream, ControllerEvent *out, size_t max);
+
+/**
+ * Returns the number of events dropped because the ring was full.
+ * Safe from any thread.
+ */
+uint64_t event_stream_dropped(const EventStream *stream);
+
+/**
+ * Returns the ring's capacity in events.
+ */
+size_t event_stream_capacity(const EventStream *stream);
+
+#endif // EVENT_STREAM_H
@@ -0,0 +1,90 @@
+#ifndef FOV_H
+#define FOV_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "structs.h"
+
+/**
+ * Field of view inside a room, by recursive shadowcasting.
+ *
+ * Walls (except where a door is) and monsters block sight; floor, doors
+ * and items do not. An opaque tile is itself visible when nothing stands
+ * in front of it. The view reaches every tile within `radius` (Euclidean,
+ * dx^2 + dy^2 <= radius^2) that is in line of sight from the origin.
+ *
+ * Each octant is scanned row by row from the origin outward. The slopes
+ * bounding every (row, column) cell and the last column inside each
+ * radius are computed once when the context is created, so the scan does
+ * no division or square roots.
+ *
+ * Results go into a bitset: tile (x, y) of a room of width w is bit
+ * (y * w + x) % 64 of word (y * w + x) / 64.
+ *
+ * A context belongs to one thread at a time. It keeps, for the last few
+ * rooms it was used on, the room's opacity bitmap and the last result,
+ * each tagged with a caller-supplied room version; asking again with the
+ * same version, origin and radius just copies the result.
+ */
+
+typedef struct FovContext FovContext;
+
+/**
+ * Return codes for FOV functions.
+ */
+typedef enum {
+    FOV_OK,
+    FOV_INVALID_ARGUMENT,       // bad radius, origin outside the room, or bitset too small
+    FOV_ALLOCATION_FAILED
+} FovStatusCode;
+
+#define FOV_MAX_RADIUS 64
+
+/**
+ * Creates a context for radii up to `max_radius`, precomputing its tables.
+ *
+ * @param max_radius 1 to FOV_MAX_RADIUS
+ * @return Pointer to the context, or NULL on bad input or allocation failure
+ */
+FovContext *fov_create(int max_radius);
+
+/**
+ * Frees the context and its cached bitmaps.
+ */
+void fov_destroy(FovContext *fov);
+
+/**
+ * Returns how many uint64_t words a visibility bitset of a room needs.
+ */
+size_t fov_bitset_words(int width, int height);
+
+/**
+ * Returns true if tile (x, y) is set in a bitset for a room of `width`.
+ */
+bool fov_is_visible(const uint64_t *visible, int width, int x, int y);
+
+/**
+ * Computes the tiles of `room` visible from (x, y).
+ *
+ * `version` must change whenever a monster in the room moves (the
+ * controller's room_versions do). When version, origin and radius match a
+ * committed earlier result for the same room, that result is copied
+ * instead of recomputed. Like render_encode_room, a new result is only
+ * remembered once fov_commit is called, so a caller reading the room
+ * under a seqlock can drop a torn attempt by simply computing again.
+ *
+ * @param version Room version, or 0 to bypass the cache
+ * @param visible Receives the bitset; cleared first
+ * @param words Capacity of `visible`; at least fov_bitset_words(room)
+ * @return FOV_OK, FOV_INVALID_ARGUMENT or FOV_ALLOCATION_FAILED
+ */
+FovStatusCode fov_compute(FovContext *fov, const Room *room, unsigned version, int x, int y,
+                          int radius, uint64_t *visible, size_t words);
+
+/**
+ * Remembers the result (and opacity bitmap) of the last fov_compute.
+ */
+void fov_commit(FovContext *fov);
+
+#endif // FOV_H
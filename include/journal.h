@@ -0,0 +1,196 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "structs.h"
+#include "worldgen_config.h"
+
+/**
+ * Write-ahead journal of controller state changes, for crash recovery.
+ *
+ * A journal is a pair of files:
+ *   <path>        append-only log of fixed 8-byte records, one per
+ *                 successful move_player_* call; consecutive ticks are
+ *                 folded into a single record
+ *   <path>.ckpt   the latest checkpoint: player, visited rooms and the
+ *                 monster simulation state, replaced atomically
+ *                 (write to <path>.ckpt.tmp, fsync, rename)
+ *
+ * Records are buffered in memory and written and fsync'ed in groups
+ * (group commit): a group is flushed once it holds `group_commit_records`
+ * records or its oldest record is `group_commit_ms` old, whichever comes
+ * first, so a crash loses at most one group. Group size is checked on
+ * every append, but age can only be checked when the journal is called:
+ * a writer that goes idle must call journal_poll (for instance as the
+ * timeout of whatever it blocks on) for `group_commit_ms` to hold.
+ * Every `checkpoint_interval`
+ * operations the controller writes a checkpoint and the log is truncated,
+ * so both the log's size and recovery time are bounded by the checkpoint
+ * interval rather than by the length of the session.
+ *
+ * Each log starts with a generation number that the checkpoint also
+ * records; a log whose generation is older than the checkpoint's is
+ * already folded into it and is skipped on recovery. Records carry a
+ * checksum, and a torn record at the end of the log is discarded.
+ *
+ * A journal belongs to one controller and is only used from that
+ * controller's writer thread (see controller_attach_journal).
+ */
+
+typedef struct Journal Journal;
+
+/**
+ * Return codes for journal functions.
+ */
+typedef enum {
+    JOURNAL_OK,
+    JOURNAL_INVALID_ARGUMENT,
+    JOURNAL_IO_ERROR,           // a read, write, fsync or rename failed
+    JOURNAL_CORRUPT,            // header or checkpoint failed validation
+    JOURNAL_CONFIG_MISMATCH,    // files were written for a different DungeonConfig
+    JOURNAL_ALLOCATION_FAILED
+} JournalStatusCode;
+
+/**
+ * Durability and checkpoint knobs. Zero fields take the defaults below.
+ */
+typedef struct {
+    int group_commit_records;   // records per fsync group
+    int group_commit_ms;        // maximum age of an unsynced record
+    int checkpoint_interval;    // operations between checkpoints
+} JournalOptions;
+
+#define JOURNAL_DEFAULT_GROUP_RECORDS 64
+#define JOURNAL_DEFAULT_GROUP_MS 10
+#define JOURNAL_DEFAULT_CHECKPOINT_INTERVAL 4096
+
+/**
+ * Kinds of journal records.
+ */
+typedef enum {
+    JOURNAL_RECORD_MOVE_WITHIN_ROOM = 1,
+    JOURNAL_RECORD_MOVE_DIRECTION,
+    JOURNAL_RECORD_TICK
+} JournalRecordType;
+
+/**
+ * One decoded journal record.
+ */
+typedef struct {
+    JournalRecordType type;
+    int dx, dy;                 // MOVE_WITHIN_ROOM
+    Direction dir;              // MOVE_DIRECTION
+    int count;                  // TICK: number of consecutive ticks
+} JournalRecord;
+
+/**
+ * Controller state captured by a checkpoint.
+ *
+ * `visited_ids` and `sim_state` point to caller memory when writing, and
+ * to memory owned by the struct after journal_read_checkpoint (release it
+ * with journal_checkpoint_free).
+ */
+typedef struct {
+    int room_id;
+    int tile_x, tile_y;
+    int health;
+    bool alive;
+    int *visited_ids;
+    size_t visited_count;
+    void *sim_state;            // see simulation_save_state
+    size_t sim_state_size;
+    uint64_t generation;        // filled in by the journal
+    uint64_t offset;
+} JournalCheckpoint;
+
+/**
+ * Opens the journal at `path`, creating it if needed.
+ *
+ * Existing files must have been written for the same config. A torn
+ * record at the end of the log is cut off, so new records follow the last
+ * complete one.
+ *
+ * @param options May be NULL for the defaults
+ * @param status Receives the reason on failure; may be NULL
+ * @return Pointer to the journal, or NULL on failure
+ */
+Journal *journal_open(const char *path, const DungeonConfig *config,
+                      const JournalOptions *options, JournalStatusCode *status);
+
+/**
+ * Flushes and fsyncs pending records, then closes the journal.
+ *
+ * @return JOURNAL_OK, or the first I/O error the journal ran into
+ */
+JournalStatusCode journal_close(Journal *journal);
+
+/**
+ * Appends a record to the current group. Ticks are coalesced.
+ *
+ * I/O errors during a group flush are sticky: they are returned here and
+ * by every later call.
+ */
+JournalStatusCode journal_append(Journal *journal, const JournalRecord *record);
+
+/**
+ * Flushes the current group if its oldest record is `group_commit_ms`
+ * old. Appends only check the age when the next record arrives, so the
+ * writer thread must call this while idle to bound how long a record
+ * stays unsynced.
+ *
+ * @param next_ms Receives the milliseconds until the pending group is
+ *                due, or -1 if nothing is pending; may be NULL
+ * @return JOURNAL_OK, or the journal's sticky I/O error
+ */
+JournalStatusCode journal_poll(Journal *journal, int *next_ms);
+
+/**
+ * Writes and fsyncs all pending records now.
+ */
+JournalStatusCode journal_sync(Journal *journal);
+
+/**
+ * Returns true once `checkpoint_interval` operations have been appended
+ * since the last checkpoint.
+ */
+bool journal_checkpoint_due(const Journal *journal);
+
+/**
+ * Durably replaces the checkpoint with `checkpoint` and truncates the log.
+ *
+ * The checkpoint must describe the state after every record appended so
+ * far.
+ */
+JournalStatusCode journal_write_checkpoint(Journal *journal, const JournalCheckpoint *checkpoint);
+
+/**
+ * Reads the current checkpoint.
+ *
+ * @param found Set to false (and JOURNAL_OK returned) if there is none
+ */
+JournalStatusCode journal_read_checkpoint(Journal *journal, JournalCheckpoint *out, bool *found);
+
+/**
+ * Releases memory owned by a checkpoint from journal_read_checkpoint.
+ */
+void journal_checkpoint_free(JournalCheckpoint *checkpoint);
+
+/**
+ * Calls `apply` for every record written after `from`, in order.
+ *
+ * @param from Checkpoint returned by journal_read_checkpoint, or NULL to
+ *             replay the whole log
+ * @param apply Returns 0 to continue, non-zero to stop with JOURNAL_CORRUPT
+ */
+JournalStatusCode journal_replay(Journal *journal, const JournalCheckpoint *from,
+                                 int (*apply)(const JournalRecord *record, void *user_data),
+                                 void *user_data);
+
+/**
+ * Returns a short description of a JournalStatusCode.
+ */
+const char *journal_status_string(JournalStatusCode status);
+
+#endif // JOURNAL_H
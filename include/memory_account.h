@@ -0,0 +1,107 @@
+#ifndef MEMORY_ACCOUNT_H
+#define MEMORY_ACCOUNT_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Per-owner memory accounting with an optional budget.
+ *
+ * A MemoryAccount counts the bytes held on behalf of one owner (a
+ * controller and the dungeon it loaded), by category. Allocation sites
+ * that take part call mem_alloc, mem_calloc, mem_realloc and mem_free
+ * with a category; these charge whichever account the calling thread has
+ * entered with mem_account_enter. An owner enters its account around any
+ * work that allocates or frees on its behalf. With no account entered the
+ * wrappers are plain malloc and free, plus one thread-local load.
+ *
+ * A block must be freed with the category and size it holds, under the
+ * same account it was charged to.
+ *
+ * When an account has a budget, a charge that would take the total past
+ * it fails; the wrapper then returns NULL without allocating, and the
+ * caller's ordinary out-of-memory path takes over. Refused charges and
+ * allocations the system could not satisfy are both counted, so an owner
+ * can tell running out of memory from other failures.
+ */
+
+/**
+ * What the bytes are for.
+ */
+typedef enum {
+    MEM_TREE_NODES,             // search tree nodes
+    MEM_ROOMS,                  // Room structs
+    MEM_ENTITIES,               // monster, item and door arrays
+    MEM_RENDER,                 // render caches
+    MEM_INDEXES,                // lookup tables, per-room state and bookkeeping
+    MEM_CATEGORY_COUNT
+} MemCategory;
+
+/**
+ * Counters of one account. Initialize with mem_account_init; all fields
+ * may be read at any time.
+ */
+typedef struct {
+    atomic_size_t bytes[MEM_CATEGORY_COUNT];
+    atomic_size_t total;
+    atomic_size_t peak;             // highest total so far
+    atomic_uint_fast64_t refused;   // charges refused for the budget
+    atomic_uint_fast64_t failed;    // allocations the system could not satisfy
+    size_t budget;                  // 0 for no limit
+} MemoryAccount;
+
+/**
+ * Zeroes the counters and sets the budget (0 for none).
+ */
+void mem_account_init(MemoryAccount *account, size_t budget);
+
+/**
+ * Makes `account` (or NULL for none) the calling thread's current account.
+ *
+ * @return The previously current account, to be passed back to restore it
+ */
+MemoryAccount *mem_account_enter(MemoryAccount *account);
+
+/**
+ * Returns the calling thread's current account, or NULL.
+ */
+MemoryAccount *mem_account_current(void);
+
+/**
+ * Charges `bytes` to the current account without allocating.
+ *
+ * @return false if that would exceed the budget; nothing is charged then
+ */
+bool mem_charge(MemCategory category, size_t bytes);
+
+/**
+ * Returns `bytes` charged earlier to the current account.
+ */
+void mem_credit(MemCategory category, size_t bytes);
+
+/**
+ * malloc charged to the current account. Returns NULL over budget.
+ */
+void *mem_alloc(MemCategory category, size_t size);
+
+/**
+ * calloc charged to the current account. Returns NULL over budget.
+ */
+void *mem_calloc(MemCategory category, size_t count, size_t size);
+
+/**
+ * Resizes a block charged with `old_size` to `new_size`.
+ *
+ * @return The moved block, or NULL (leaving `ptr` as it was) over budget
+ *         or out of memory
+ */
+void *mem_realloc(MemCategory category, void *ptr, size_t old_size, size_t new_size);
+
+/**
+ * free that credits `size` bytes back. Does nothing for NULL.
+ */
+void mem_free(MemCategory category, void *ptr, size_t size);
+
+#endif // MEMORY_ACCOUNT_H
@@ -0,0 +1,144 @@
+#ifndef RENDER_CODEC_H
+#define RENDER_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "structs.h"
+
+/**
+ * Compact room render encoding for bandwidth-constrained clients.
+ *
+ * A plain render (render_room_by_id) is mostly runs of wall and floor
+ * characters. An encoded frame instead carries the static layer (walls,
+ * floor, doors) as run-length encoded rows, plus an overlay of the few
+ * tiles that hold an item, a monster or the player. Frames are built
+ * straight from the Room, never from a text render, and decode back to
+ * exactly the text render_room_by_id returns.
+ *
+ * Frame layout. Multi-byte header fields are little-endian, and "varint"
+ * is unsigned LEB128 (7 bits per byte, high bit set on all but the last).
+ *
+ *   header (14 bytes)
+ *     u8  'R'
+ *     u8  kind: 'K' key frame, 'D' delta frame
+ *     u16 width, u16 height
+ *     u32 room id
+ *     u32 frame sequence number, counting up per encoder
+ *
+ *   key frame body
+ *     rows, top to bottom, each one of:
+ *       varint n > 0, then n runs of (u8 char, varint length)
+ *       varint 0, varint k: the previous row repeated k more times
+ *     overlay: varint count, then count cells of
+ *       (varint x, varint y, u8 char), each drawn over the rows
+ *
+ *   delta frame body
+ *     varint count, then count cells of (varint x, varint y, u8 char):
+ *     every tile that differs from the frame numbered sequence - 1 of
+ *     the same room
+ *
+ * Since walls and doors never change, a delta frame only lists the tiles
+ * entities moved off and onto. It can be applied only to its base frame;
+ * a decoder that missed a frame reports RENDER_CODEC_NEED_KEYFRAME, and
+ * the sender should then call render_encoder_reset.
+ */
+
+typedef struct RenderEncoder RenderEncoder;
+typedef struct RenderDecoder RenderDecoder;
+
+#define RENDER_FRAME_HEADER_SIZE 14
+#define RENDER_FRAME_KEY   'K'
+#define RENDER_FRAME_DELTA 'D'
+
+/**
+ * Return codes for codec functions.
+ */
+typedef enum {
+    RENDER_CODEC_OK,
+    RENDER_CODEC_INVALID_ARGUMENT,
+    RENDER_CODEC_ALLOCATION_FAILED,
+    RENDER_CODEC_CORRUPT,           // frame is truncated or malformed
+    RENDER_CODEC_NEED_KEYFRAME      // delta frame does not follow the decoder's last frame
+} RenderCodecStatusCode;
+
+/**
+ * Creates an encoder for one client.
+ *
+ * @param delta If true, a frame of the same room as the previous one is
+ *              sent as a delta; otherwise every frame is a key frame
+ * @return Pointer to the encoder, or NULL on allocation failure
+ */
+RenderEncoder *render_encoder_create(bool delta);
+
+/**
+ * Frees the encoder and its frame buffer.
+ */
+void render_encoder_free(RenderEncoder *enc);
+
+/**
+ * Makes the next frame a key frame, e.g. after a client (re)connects or
+ * its decoder asked for one.
+ */
+void render_encoder_reset(RenderEncoder *enc);
+
+/**
+ * Encodes `room` as the encoder's pending frame.
+ *
+ * Encoding is two-phase so that a caller reading the room under a seqlock
+ * can simply encode again when its snapshot turns out to be torn: nothing
+ * is committed until render_encoder_commit. The frame buffer is reused, so
+ * steady-state encoding does not allocate.
+ *
+ * @param player Drawn if it is in `room`; may be NULL
+ * @return RENDER_CODEC_OK, RENDER_CODEC_INVALID_ARGUMENT or
+ *         RENDER_CODEC_ALLOCATION_FAILED
+ */
+RenderCodecStatusCode render_encode_room(RenderEncoder *enc, const Room *room, const Player *player);
+
+/**
+ * Commits the pending frame and returns it.
+ *
+ * @param data Receives the frame; owned by the encoder and valid until
+ *             the next render_encode_room
+ * @param size Receives its length in bytes
+ */
+void render_encoder_commit(RenderEncoder *enc, const uint8_t **data, size_t *size);
+
+/**
+ * Creates a decoder holding the client's copy of the current frame.
+ *
+ * @return Pointer to the decoder, or NULL on allocation failure
+ */
+RenderDecoder *render_decoder_create(void);
+
+/**
+ * Frees the decoder.
+ */
+void render_decoder_free(RenderDecoder *dec);
+
+/**
+ * Applies one frame.
+ *
+ * A malformed frame leaves the decoder needing a key frame.
+ *
+ * @return RENDER_CODEC_OK, RENDER_CODEC_INVALID_ARGUMENT,
+ *         RENDER_CODEC_ALLOCATION_FAILED, RENDER_CODEC_CORRUPT or
+ *         RENDER_CODEC_NEED_KEYFRAME
+ */
+RenderCodecStatusCode render_decode(RenderDecoder *dec, const uint8_t *data, size_t size);
+
+/**
+ * Returns the decoded frame as plain text, in render_room_by_id format.
+ *
+ * @param room_id Receives the frame's room ID; may be NULL
+ * @return The text, owned by the decoder, or NULL before the first key frame
+ */
+const char *render_decoder_text(const RenderDecoder *dec, int *room_id);
+
+/**
+ * Returns a short description of a RenderCodecStatusCode.
+ */
+const char *render_codec_status_string(RenderCodecStatusCode status);
+
+#endif // RENDER_CODEC_H
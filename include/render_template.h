@@ -0,0 +1,84 @@
+#ifndef RENDER_TEMPLATE_H
+#define RENDER_TEMPLATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "structs.h"
+
+/**
+ * Cache of prebuilt room backgrounds.
+ *
+ * A room's background (walls, floor and doors, with row newlines and the
+ * final NUL) depends only on its width, height and door layout, and many
+ * rooms share all three. The cache keeps one ready-made background per
+ * (width, height, door mask), so rendering a room is one memcpy followed
+ * by drawing its items, monsters and the player on top.
+ *
+ * The door mask has one bit per Direction, set when the room has a door
+ * in the middle of that wall, where the generator puts them. A room with a
+ * door anywhere else is drawn the slow way and counted as bypassed.
+ *
+ * The total size of cached backgrounds is bounded; when a new one does not
+ * fit, older ones are evicted in CLOCK (second chance) order. Lookups
+ * take a shared lock and may run on any number of threads at once.
+ *
+ * Everything the cache allocates is charged to MEM_RENDER of the memory
+ * account current when it was created (see memory_account.h), whichever
+ * thread does the allocating. A background that would take that account
+ * past its budget is simply not cached.
+ */
+
+typedef struct TemplateCache TemplateCache;
+
+/**
+ * Counters and occupancy of a template cache.
+ */
+typedef struct {
+    uint64_t hits;              // renders served by a cached background
+    uint64_t misses;            // renders that had to build the background
+    uint64_t bypassed;          // renders of rooms whose doors do not fit a mask
+    uint64_t evictions;         // backgrounds dropped to stay under the limit
+    size_t entries;             // backgrounds currently cached
+    size_t bytes;               // their total size
+    size_t limit;               // maximum total size; 0 disables the cache
+} TemplateCacheStats;
+
+#define TEMPLATE_CACHE_DEFAULT_BYTES (256 * 1024)
+
+/**
+ * Creates an empty cache holding at most `max_bytes` of backgrounds.
+ *
+ * @return Pointer to the cache, or NULL on allocation failure
+ */
+TemplateCache *template_cache_create(size_t max_bytes);
+
+/**
+ * Frees the cache and every background in it.
+ */
+void template_cache_destroy(TemplateCache *cache);
+
+/**
+ * Changes the size limit, evicting backgrounds until the cache fits.
+ * A limit of 0 empties and disables the cache.
+ */
+void template_cache_set_limit(TemplateCache *cache, size_t max_bytes);
+
+/**
+ * Writes the background of `room` into `buf`.
+ *
+ * `buf` receives (width + 1) * height + 1 bytes: the rows of walls, floor
+ * and doors, each ending in '\n', then a NUL. On a miss the background is
+ * drawn into `buf` and then cached if it fits.
+ *
+ * @return false if the room's doors cannot be expressed as a door mask;
+ *         `buf` is then untouched and the caller must draw the room itself
+ */
+bool template_cache_render(TemplateCache *cache, const Room *room, char *buf);
+
+/**
+ * Reads the cache's counters and occupancy.
+ */
+void template_cache_stats(TemplateCache *cache, TemplateCacheStats *out);
+
+#endif // RENDER_TEMPLATE_H
@@ -27,6 +27,16 @@
  */
 int compare_rooms(const void *a, const void *b);
 
+/**
+ * Returns the ID of a Room as a search key (see freezeTree).
+ *
+ * Orders rooms exactly as compare_rooms does.
+ *
+ * @param data Pointer to a Room (as void*)
+ * @return The room's ID
+ */
+long long room_key(const void *data);
+
 /**
  * Creates a deep copy of a Room.
  *
@@ -80,4 +90,13 @@ int get_room_id(const Room *room);
  */
 bool is_in_bounds(const Room *room, int x, int y);
 
+/**
+ * Characters used when rendering a room. Monsters and items draw with
+ * their own `symbol`.
+ */
+#define TILE_FLOOR  '.'
+#define TILE_WALL   '#'
+#define TILE_DOOR   '+'
+#define TILE_PLAYER '@'
+
 #endif // ROOM_H
\ No newline at end of file
@@ -0,0 +1,132 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dungeon_controller.h"
+
+/**
+ * This module runs many independent dungeon controllers on one worker pool.
+ *
+ * The scheduler owns N controllers. Callers queue commands (moves, renders,
+ * visited-room queries) against a controller by index, and a work-stealing
+ * pool (see thread_pool.h) executes them.
+ *
+ * Ordering: commands for the same controller run one at a time, in the order
+ * they were submitted. Commands for different controllers run in parallel.
+ * Because each controller is driven by at most one worker at a time, the
+ * controller's single-writer rule is upheld without extra locking.
+ *
+ * Results are delivered through a per-command callback on a worker thread.
+ */
+
+typedef struct Scheduler Scheduler;
+
+/**
+ * Kinds of commands that can be queued against a controller.
+ */
+typedef enum {
+    SCHED_MOVE_WITHIN_ROOM,     // move_player_within_room(dx, dy)
+    SCHED_MOVE_DIRECTION,       // move_player_direction(dir)
+    SCHED_RENDER_CURRENT,       // render_current_room
+    SCHED_RENDER_ROOM,          // render_room_by_id(room_id)
+    SCHED_GET_VISITED,          // get_visited_room_ids
+    SCHED_TICK                  // controller_tick
+} SchedulerCommandType;
+
+/**
+ * Outcome of one command, handed to the command's callback.
+ *
+ * `render` and `visited_ids` are heap-allocated and owned by the callback,
+ * which must free() them. When no callback is set they are freed for you.
+ */
+typedef struct {
+    size_t controller_index;
+    SchedulerCommandType type;
+    ControllerStatusCode status;
+    char *render;               // SCHED_RENDER_*: rendered room
+    int *visited_ids;           // SCHED_GET_VISITED: visited room IDs
+    size_t visited_count;
+    uint64_t latency_ns;        // from submit to completion
+} SchedulerResult;
+
+/**
+ * A command to run against one controller.
+ */
+typedef struct {
+    SchedulerCommandType type;
+    int dx, dy;                 // SCHED_MOVE_WITHIN_ROOM
+    Direction dir;              // SCHED_MOVE_DIRECTION
+    int room_id;                // SCHED_RENDER_ROOM
+    void (*on_complete)(const SchedulerResult *result, void *user_data); // optional
+    void *user_data;
+} SchedulerCommand;
+
+/**
+ * Queue and latency counters, for one controller or for the whole scheduler.
+ *
+ * Latency percentiles are read from a log2-bucketed histogram, so they are
+ * upper bounds accurate to within a factor of two.
+ */
+typedef struct {
+    uint64_t submitted;
+    uint64_t completed;
+    size_t queue_depth;         // commands waiting or running right now
+    size_t max_queue_depth;     // deepest single-controller queue since creation
+    uint64_t latency_mean_ns;
+    uint64_t latency_p50_ns;
+    uint64_t latency_p99_ns;
+    uint64_t latency_max_ns;
+} SchedulerStats;
+
+/**
+ * Creates a scheduler that takes ownership of `count` controllers.
+ *
+ * @param controllers Array of initialised controllers; the array itself is copied
+ * @param count       Number of controllers
+ * @param num_workers Worker threads; 0 or less uses one per online CPU
+ * @return Pointer to the new scheduler, or NULL on failure (controllers are
+ *         then still owned by the caller)
+ */
+Scheduler *scheduler_create(Controller **controllers, size_t count, int num_workers);
+
+/**
+ * Finishes every queued command, stops the workers and frees all controllers.
+ */
+void scheduler_destroy(Scheduler *sched);
+
+/**
+ * Queues a command for the controller at `index`.
+ *
+ * @return CONTROLLER_OK, CONTROLLER_INVALID_ARGUMENT for a bad index or
+ *         command, or CONTROLLER_ALLOCATION_FAILED, in which case nothing
+ *         was queued and the command will not run
+ */
+ControllerStatusCode scheduler_submit(Scheduler *sched, size_t index, const SchedulerCommand *cmd);
+
+/**
+ * Blocks until every command submitted so far has completed.
+ */
+void scheduler_drain(Scheduler *sched);
+
+/**
+ * Returns the number of controllers owned by the scheduler.
+ */
+size_t scheduler_count(const Scheduler *sched);
+
+/**
+ * Returns the controller at `index` for direct read-only access, or NULL.
+ *
+ * Only the concurrent-reader API from dungeon_controller.h may be used on it;
+ * moves must go through scheduler_submit.
+ */
+const Controller *scheduler_controller(const Scheduler *sched, size_t index);
+
+/**
+ * Fills `out` with statistics for one controller, or for all controllers
+ * combined when `index` is SCHEDULER_ALL.
+ */
+#define SCHEDULER_ALL ((size_t)-1)
+ControllerStatusCode scheduler_get_stats(const Scheduler *sched, size_t index, SchedulerStats *out);
+
+#endif // SCHEDULER_H
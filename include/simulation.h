@@ -0,0 +1,114 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "structs.h"
+#include "tree.h"
+
+/**
+ * Active-region monster simulation.
+ *
+ * Only rooms within `radius` hops of the player (following neighbor_ids)
+ * are stepped each tick. Every other room just remembers the tick it was
+ * last simulated at, and is fast-forwarded in closed form the moment it
+ * becomes active again. Per-tick cost is therefore proportional to the
+ * number of active rooms, not to the size of the world.
+ *
+ * Monster behaviour: each monster patrols back and forth along its row.
+ * At creation every monster is given a lane, a run of interior tiles on
+ * its row bounded by walls, items and half the gap to the next monster on
+ * the same row. Lanes never overlap, so a monster's position is a pure
+ * function of its phase and the phase simply advances by one per tick.
+ * The only exception is the player: a monster whose next tile holds the
+ * player waits in place, which is why rooms containing the player are
+ * always stepped tick by tick.
+ *
+ * The simulation moves Monster entries of the rooms in the tree in place.
+ * It is not thread-safe; the controller drives it from its writer thread
+ * inside seqlock write sections (see dungeon_controller.h).
+ */
+
+typedef struct Simulation Simulation;
+
+/**
+ * Creates a simulation over the rooms of `room_tree`.
+ *
+ * The tree must outlive the simulation and must not gain or lose rooms.
+ *
+ * @param room_tree Tree of Room*, keyed by room ID
+ * @param max_room_id Highest room ID in the tree
+ * @param radius Number of hops around the player's room that stay active
+ * @return Pointer to the new simulation, or NULL on failure
+ */
+Simulation *simulation_create(Tree *room_tree, int max_room_id, int radius);
+
+/**
+ * Frees the simulation. Rooms keep their monsters' current positions.
+ */
+void simulation_destroy(Simulation *sim);
+
+/**
+ * Changes the active radius. Takes effect on the next step.
+ *
+ * @return 0 on success, -1 if `radius` is negative
+ */
+int simulation_set_radius(Simulation *sim, int radius);
+
+/**
+ * Brings one room up to the current tick.
+ *
+ * Called when the player is about to enter a room, so the room is seen in
+ * the state it would have reached had it been simulated all along. Cheap
+ * when the room is already current.
+ *
+ * @param player The player, so no monster is placed on their tile; may be NULL
+ */
+void simulation_catch_up(Simulation *sim, int room_id, const Player *player);
+
+/**
+ * Advances the simulation by one tick around the player's room.
+ */
+void simulation_step(Simulation *sim, const Player *player);
+
+/**
+ * Returns the size in bytes of a saved simulation state.
+ */
+size_t simulation_state_size(const Simulation *sim);
+
+/**
+ * Saves the tick counter and every room's and monster's progress into
+ * `out`, which must hold simulation_state_size() bytes. The format is
+ * native-endian and only meant to be loaded back into a simulation built
+ * from the same world.
+ */
+void simulation_save_state(const Simulation *sim, void *out);
+
+/**
+ * Restores a state saved by simulation_save_state and moves every monster
+ * to the matching tile.
+ *
+ * @return 0 on success, -1 if `size` does not match this world
+ */
+int simulation_load_state(Simulation *sim, const void *state, size_t size);
+
+/**
+ * Returns the number of ticks simulated so far.
+ */
+uint64_t simulation_tick(const Simulation *sim);
+
+/**
+ * Returns the number of rooms stepped by the last simulation_step.
+ */
+size_t simulation_active_count(const Simulation *sim);
+
+/**
+ * Returns the IDs of the rooms stepped by the last simulation_step.
+ *
+ * The array is owned by the simulation and valid until the next step.
+ *
+ * @return Number of IDs in `*ids`
+ */
+size_t simulation_active_rooms(const Simulation *sim, const int **ids);
+
+#endif // SIMULATION_H
@@ -0,0 +1,71 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/**
+ * A fixed-size work-stealing thread pool.
+ *
+ * Each worker owns a deque of tasks. A worker pushes and pops tasks it
+ * spawns itself at the bottom of its own deque (LIFO, cache-warm), and when
+ * it runs dry it steals from the top of another worker's deque (FIFO, oldest
+ * work first). Tasks submitted from outside the pool are spread round-robin
+ * across the workers' deques.
+ *
+ * Tasks may submit further tasks. The pool makes no ordering guarantees
+ * between tasks; callers that need ordering (see scheduler.h) must build it
+ * on top.
+ */
+
+typedef struct ThreadPool ThreadPool;
+
+/**
+ * Return codes for thread pool functions.
+ */
+typedef enum {
+    POOL_OK,
+    POOL_INVALID_ARGUMENT,
+    POOL_ALLOCATION_FAILED,
+    POOL_SHUTDOWN
+} PoolStatusCode;
+
+/**
+ * A unit of work. Runs on one of the pool's worker threads.
+ */
+typedef void (*PoolTaskFunction)(void *arg);
+
+/**
+ * Creates a pool and starts its worker threads.
+ *
+ * @param num_workers Number of worker threads; 0 or less uses one per online CPU
+ * @return Pointer to the new pool, or NULL on failure
+ */
+ThreadPool *thread_pool_create(int num_workers);
+
+/**
+ * Runs every task still queued, stops the workers and frees the pool.
+ */
+void thread_pool_destroy(ThreadPool *pool);
+
+/**
+ * Queues `fn(arg)` for execution.
+ *
+ * Safe to call from any thread, including from inside a running task.
+ *
+ * @return POOL_OK, POOL_INVALID_ARGUMENT for a NULL pool or function,
+ *         POOL_ALLOCATION_FAILED if a deque could not grow, or
+ *         POOL_SHUTDOWN once thread_pool_destroy has begun
+ */
+PoolStatusCode thread_pool_submit(ThreadPool *pool, PoolTaskFunction fn, void *arg);
+
+/**
+ * Blocks until every submitted task (including tasks they spawned) has finished.
+ *
+ * Must not be called from inside a task.
+ */
+void thread_pool_wait(ThreadPool *pool);
+
+/**
+ * Returns the number of worker threads in the pool.
+ */
+int thread_pool_size(const ThreadPool *pool);
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,115 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Opt-in timeline tracing, exported as Chrome trace-event JSON.
+ *
+ * Instrumented code marks spans with TRACE_BEGIN / TRACE_END. While
+ * tracing is off, TRACE_BEGIN is one load of a global flag and a branch
+ * that is predicted not taken, and TRACE_END a branch on the local it
+ * left at zero; nothing is recorded and no clock is read.
+ *
+ * trace_start() turns tracing on. Each thread that then ends a span gets
+ * its own buffer, allocated once with room for a fixed number of spans;
+ * recording a span is a clock read and a store into that buffer, with no
+ * locks and no allocation. A thread whose buffer is full drops further
+ * spans and counts them. trace_stop() turns tracing off, and
+ * trace_dump_json() or trace_write() export everything recorded as
+ * complete ("X") events, one track per thread, for chrome://tracing,
+ * Perfetto or any other viewer of the format.
+ *
+ * Span names and categories must be string literals (or otherwise outlive
+ * the trace); only the pointers are stored.
+ */
+
+/**
+ * Return codes for trace functions.
+ */
+typedef enum {
+    TRACE_OK,
+    TRACE_INVALID_ARGUMENT,
+    TRACE_ALLOCATION_FAILED,
+    TRACE_IO_ERROR
+} TraceStatusCode;
+
+#define TRACE_DEFAULT_SPANS_PER_THREAD (64 * 1024)
+
+extern atomic_bool trace_active;
+
+/**
+ * Returns true while tracing is on.
+ */
+static inline bool trace_enabled(void){
+    return __builtin_expect(atomic_load_explicit(&trace_active, memory_order_relaxed), 0);
+}
+
+/**
+ * Nanoseconds on the trace clock.
+ */
+uint64_t trace_clock_ns(void);
+
+/**
+ * Records a span from `start_ns` until now on the calling thread's track.
+ * Use through TRACE_END.
+ */
+void trace_record(const char *category, const char *name, uint64_t start_ns);
+
+// Declares `span` and starts timing it if tracing is on.
+#define TRACE_BEGIN(span)               uint64_t span = trace_enabled() ? trace_clock_ns() : 0
+// Records `span` under `category` and `name` if TRACE_BEGIN started it.
+#define TRACE_END(span, category, name) do { if ((span) != 0) trace_record((category), (name), (span)); } while (0)
+
+/**
+ * Discards any earlier trace and starts recording.
+ *
+ * @param spans_per_thread Capacity of each thread's buffer; 0 uses
+ *        TRACE_DEFAULT_SPANS_PER_THREAD
+ * @return TRACE_OK
+ */
+TraceStatusCode trace_start(size_t spans_per_thread);
+
+/**
+ * Stops recording. What was recorded stays available for export.
+ */
+void trace_stop(void);
+
+/**
+ * Frees every buffer. Call only when no traced code is running.
+ */
+void trace_reset(void);
+
+/**
+ * Renders the recorded spans as a Chrome trace-event JSON object.
+ *
+ * Call after trace_stop(), once traced threads are done. The string is
+ * heap-allocated; the caller must free() it.
+ *
+ * @param json Receives the NUL-terminated JSON
+ * @param len Optional; receives its length
+ * @return TRACE_OK, TRACE_INVALID_ARGUMENT or TRACE_ALLOCATION_FAILED
+ */
+TraceStatusCode trace_dump_json(char **json, size_t *len);
+
+/**
+ * Writes trace_dump_json() output to `path`.
+ *
+ * @return TRACE_OK, TRACE_INVALID_ARGUMENT, TRACE_ALLOCATION_FAILED or TRACE_IO_ERROR
+ */
+TraceStatusCode trace_write(const char *path);
+
+/**
+ * Returns how many spans were dropped because a thread's buffer was full.
+ */
+uint64_t trace_dropped(void);
+
+/**
+ * Returns a human-readable name for a trace status code.
+ */
+const char *trace_status_string(TraceStatusCode status);
+
+#endif // TRACE_H
@@ -2,6 +2,8 @@
 #ifndef TREE_H
 #define TREE_H
 
+#include <stddef.h>
+
 typedef struct Tree Tree;
 
 /*
@@ -21,6 +23,12 @@ typedef enum {
  * - Duplicate values are inserted to the right (duplicates allowed).
  * - Returned pointers from findData should not be modified or assumed valid after tree changes.
  * - Tree does not free user data unless a destroy function is provided.
+ *
+ * Concurrency:
+ * - findData, printInOrder and iterators never modify the tree, so any number of
+ *   threads may call them at once without locking.
+ * - insertData, removeData, removeRange, freezeTree and destroyTree must not run
+ *   concurrently with any other call on the same tree.
  */
 
 /*
@@ -35,6 +43,20 @@ Tree *createTree(void (*printFunction)(const void *data),
                  int (*compareFunction)(const void *a, const void *b),
                  void (*destroyFunction)( void *data));
 
+/*
+ * Create a tree from `count` items already in strictly ascending order
+ * (by compareFunction), building a perfectly balanced tree in linear time
+ * instead of inserting them one by one.
+ *
+ * The tree takes ownership of the items only on success. Returns NULL if
+ * the functions are missing, the items are out of order or repeat, or
+ * allocation fails; the items are then left untouched.
+ */
+Tree *createTreeFromSorted(void (*printFunction)(const void *data),
+                           int (*compareFunction)(const void *a, const void *b),
+                           void (*destroyFunction)(void *data),
+                           void **sorted, size_t count);
+
 /*
  * Destroy the tree and all its nodes.
  * If destroyFunction was provided, it will be called on each data element.
@@ -47,6 +69,32 @@ void destroyTree(Tree *tree);
  */
 TreeStatusCode insertData(Tree *tree, void *data);
 
+/*
+ * Remove the item matching key, rebalancing on the way back up.
+ *
+ * If removed is non-NULL the item is handed back through it and the tree
+ * lets go of it. Otherwise destroyFunction (if any) is called on it.
+ *
+ * Returns TREE_OK, TREE_NOT_FOUND if nothing matches, or TREE_ERROR on bad
+ * input. A frozen tree is thawed first (see freezeTree).
+ */
+TreeStatusCode removeData(Tree *tree, const void *key, void **removed);
+
+/*
+ * Remove every item from lo to hi inclusive, as ordered by compareFunction.
+ *
+ * The tree is split at lo and at hi, the middle part is discarded, and the
+ * two outer parts are joined back together. That costs O(k + log n) for k
+ * removed items, instead of k separate deletions or a rebuild of the tree.
+ * If destroy is non-zero, destroyFunction (if any) is called on each
+ * removed item.
+ *
+ * count (optional) receives the number of items removed. Returns TREE_OK
+ * (also when nothing was in range), or TREE_ERROR on bad input or if a
+ * frozen tree could not be thawed.
+ */
+TreeStatusCode removeRange(Tree *tree, const void *lo, const void *hi, int destroy, size_t *count);
+
 /*
  * Search for a matching data item.
  * Returns a pointer to the matching data, or NULL if not found.
@@ -54,11 +102,43 @@ TreeStatusCode insertData(Tree *tree, void *data);
  */
 void *findData(Tree *tree, const void *key);
 
+/*
+ * Compact the tree for read-mostly use.
+ *
+ * The nodes are replaced by one array holding the data in Eytzinger (BFS)
+ * order: the root at index 1 and the children of i at 2i and 2i+1. Searches
+ * then walk the array without following pointers, with no unpredictable
+ * branches, prefetching the next levels as they go. findData, printInOrder
+ * and iterators work unchanged on a frozen tree.
+ *
+ * keyFunction is optional. It maps data to an integer that orders exactly
+ * as compareFunction does. When given, keys are extracted once here and
+ * kept next to the array, so a search compares integers and calls
+ * compareFunction only once, to confirm the final match.
+ *
+ * insertData on a frozen tree first rebuilds the nodes (in linear time),
+ * so the tree simply goes back to normal; freeze it again afterwards.
+ * Freezing a frozen tree rebuilds the array.
+ *
+ * Returns TREE_OK, or TREE_ERROR on bad input or allocation failure, in
+ * which case the tree is left as it was.
+ */
+TreeStatusCode freezeTree(Tree *tree, long long (*keyFunction)(const void *data));
+
 /*
  * Print the contents of the tree in sorted order using the printFunction.
  */
 void printInOrder(Tree *tree);
 
+/*
+ * Check the tree's invariants: items strictly ascending in order, and, when
+ * not frozen, every node's height correct and its subtrees' heights within
+ * one of each other. Meant for tests and debugging; O(n).
+ *
+ * Returns TREE_OK, or TREE_ERROR on bad input or a broken invariant.
+ */
+TreeStatusCode verifyTree(const Tree *tree);
+
 
 // Tree Iterator
 typedef struct TreeIterator TreeIterator;
@@ -0,0 +1,116 @@
+#ifndef WORLDGEN_CONFIG_H
+#define WORLDGEN_CONFIG_H
+
+#include <stddef.h>
+#include "worldgen.h"
+
+/**
+ * Native loader and validator for worldgen .ini files.
+ *
+ * The parser makes a single pass over the input and never allocates: file
+ * input is streamed through a fixed stack buffer. Problems are reported as
+ * status codes (with the offending line and key in a ConfigError) instead of
+ * terminating the process.
+ *
+ * A parsed DungeonConfig can be kept and reused to create any number of
+ * dungeons with controller_init_with_config(), without touching the
+ * filesystem again.
+ *
+ * Format: one `key=value` per line, integer values, `#` or `;` comments,
+ * blank lines and `[section]` headers ignored. Keys not present keep the
+ * defaults from worldgen_config_defaults().
+ */
+
+/**
+ * A WorldGenConfig plus the settings only the native generator reads.
+ *
+ * WorldGenConfig (worldgen.h) is shared with the prebuilt libworldgen and
+ * must keep the layout the library was built with, so native-only
+ * settings live here instead.
+ */
+typedef struct {
+    WorldGenConfig world;       // the settings libworldgen reads too
+    unsigned int seed;          // RNG seed for the native generator (dungeon_gen.h)
+} DungeonConfig;
+
+/**
+ * Return codes for config loading and validation.
+ */
+typedef enum {
+    CONFIG_OK,
+    CONFIG_INVALID_ARGUMENT,
+    CONFIG_FILE_ERROR,          // file missing or unreadable
+    CONFIG_SYNTAX_ERROR,        // line is not `key=value`, or is too long
+    CONFIG_UNKNOWN_KEY,
+    CONFIG_BAD_VALUE,           // value is not an integer
+    CONFIG_OUT_OF_RANGE,        // value outside its allowed range
+    CONFIG_INCONSISTENT         // values conflict (e.g. rooms do not fit the map)
+} ConfigStatusCode;
+
+#define CONFIG_MAX_LINE 256
+
+/**
+ * Where and why loading failed. `line` is 1-based, 0 if not line-specific.
+ */
+typedef struct {
+    int line;
+    char key[32];
+} ConfigError;
+
+/**
+ * Fills `config` with the defaults used for keys missing from a file.
+ */
+void worldgen_config_defaults(DungeonConfig *config);
+
+/**
+ * Parses and validates an in-memory .ini document of `len` bytes.
+ *
+ * @param error Optional; receives the failing line and key
+ */
+ConfigStatusCode worldgen_config_parse(const char *text, size_t len,
+                                       DungeonConfig *config, ConfigError *error);
+
+/**
+ * Reads, parses and validates the .ini file at `path`.
+ *
+ * @param error Optional; receives the failing line and key
+ */
+ConfigStatusCode worldgen_config_load(const char *path, DungeonConfig *config,
+                                      ConfigError *error);
+
+/**
+ * Reads the .ini file at `path` as leniently as libworldgen does, for
+ * dungeons the library builds (controller_init).
+ *
+ * Each line is read as `key=value` the way the library's
+ * `%63[^=]=%63s` scan does. Lines naming a known key with an integer value
+ * set it; everything else is skipped. Nothing is validated, so any file
+ * the library accepts is read, and fields it does not set keep their
+ * defaults.
+ *
+ * @return CONFIG_OK, CONFIG_INVALID_ARGUMENT or CONFIG_FILE_ERROR
+ */
+ConfigStatusCode worldgen_config_scan(const char *path, DungeonConfig *config);
+
+/**
+ * Checks every field of `config` for range and consistency.
+ *
+ * @param error Optional; receives the name of the first bad field
+ */
+ConfigStatusCode worldgen_config_validate(const DungeonConfig *config, ConfigError *error);
+
+/**
+ * Number of room cells across and down the map grid.
+ *
+ * Each cell holds the largest possible room plus a one-tile gutter;
+ * Room.grid_placement indexes these cells in row-major order.
+ */
+int worldgen_grid_columns(const WorldGenConfig *config);
+int worldgen_grid_rows(const WorldGenConfig *config);
+
+/**
+ * Returns a short human-readable description of a status code.
+ */
+const char *config_status_string(ConfigStatusCode status);
+
+#endif // WORLDGEN_CONFIG_H
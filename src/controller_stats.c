@@ -0,0 +1,310 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "controller_stats.h"
+
+#ifdef CONTROLLER_STATS
+
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+#define LATENCY_BUCKETS 40      // bucket b: [2^b, 2^(b+1)) ns; the last bucket is open-ended
+#define DEPTH_BUCKETS 64
+#define NUM_STATUS_CODES (CONTROLLER_ERROR + 1)
+
+typedef struct {
+    atomic_uint_fast64_t calls;
+    atomic_uint_fast64_t total_ns;
+    atomic_uint_fast64_t by_status[NUM_STATUS_CODES];
+    atomic_uint_fast64_t latency[LATENCY_BUCKETS];
+} FunctionCounters;
+
+// One per thread; only the owner writes, readers merge with relaxed loads.
+typedef struct StatsShard {
+    FunctionCounters functions[STAT_FUNCTION_COUNT];
+    atomic_uint_fast64_t depth[DEPTH_BUCKETS];
+    atomic_uint_fast64_t allocs[STAT_ALLOC_SITE_COUNT];
+    atomic_uint_fast64_t alloc_bytes[STAT_ALLOC_SITE_COUNT];
+    atomic_uint_fast64_t frees[STAT_ALLOC_SITE_COUNT];
+    struct StatsShard *next;
+} StatsShard;
+
+// Shards outlive their threads so counts from finished threads are kept.
+static StatsShard *shard_list = NULL;
+static pthread_mutex_t shard_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local StatsShard *local_shard = NULL;
+
+static const char *function_names[STAT_FUNCTION_COUNT] = {
+    "controller_init", "controller_free", "get_current_room", "get_player_room_id",
+    "get_room_by_id", "get_player_position", "get_player_health", "is_player_alive",
+    "move_player_within_room", "move_player_direction", "controller_tick",
+    "controller_set_active_radius", "controller_attach_events",
+    "controller_attach_journal", "render_current_room",
+    "render_room_by_id", "render_rooms_batch", "render_room_encoded",
+    "controller_set_template_cache_limit", "controller_template_cache_stats",
+    "render_map", "get_visited_room_ids", "is_walkable",
+    "controller_player_fov", "controller_memory_usage"
+};
+
+static const char *status_names[NUM_STATUS_CODES] = {
+    "OK", "INVALID_ARGUMENT", "NOT_FOUND", "NO_DOOR", "OUT_OF_BOUNDS",
+    "ALREADY_IN_ROOM", "ALLOCATION_FAILED", "ERROR"
+};
+
+static const char *alloc_names[STAT_ALLOC_SITE_COUNT] = {
+    "tree_node", "controller", "render_buffer", "visited_array"
+};
+
+static StatsShard *get_shard(void){
+    if (local_shard) return local_shard;
+    StatsShard *shard = calloc(1, sizeof(StatsShard));
+    if (!shard) return NULL;
+    pthread_mutex_lock(&shard_lock);
+    shard->next = shard_list;
+    shard_list = shard;
+    pthread_mutex_unlock(&shard_lock);
+    local_shard = shard;
+    return shard;
+}
+
+// Single-writer increment: a plain load/store pair avoids a locked RMW on the hot path.
+static inline void bump(atomic_uint_fast64_t *c, uint64_t n){
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static int log2_bucket(uint64_t v, int buckets){
+    int b = 0;
+    while (v > 1 && b < buckets - 1) {
+        v >>= 1;
+        b++;
+    }
+    return b;
+}
+
+uint64_t stats_clock_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void stats_record_call(StatFunction fn, ControllerStatusCode status, uint64_t elapsed_ns){
+    StatsShard *shard = get_shard();
+    if (!shard || fn < 0 || fn >= STAT_FUNCTION_COUNT) return;
+    FunctionCounters *f = &shard->functions[fn];
+    bump(&f->calls, 1);
+    bump(&f->total_ns, elapsed_ns);
+    if (status >= 0 && status < NUM_STATUS_CODES) bump(&f->by_status[status], 1);
+    bump(&f->latency[log2_bucket(elapsed_ns, LATENCY_BUCKETS)], 1);
+}
+
+void stats_record_tree_depth(int depth){
+    StatsShard *shard = get_shard();
+    if (!shard) return;
+    bump(&shard->depth[depth < DEPTH_BUCKETS ? depth : DEPTH_BUCKETS - 1], 1);
+}
+
+void stats_record_alloc(StatAllocSite site, uint64_t bytes){
+    StatsShard *shard = get_shard();
+    if (!shard) return;
+    bump(&shard->allocs[site], 1);
+    bump(&shard->alloc_bytes[site], bytes);
+}
+
+void stats_record_free(StatAllocSite site){
+    StatsShard *shard = get_shard();
+    if (!shard) return;
+    bump(&shard->frees[site], 1);
+}
+
+typedef struct {
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t by_status[NUM_STATUS_CODES];
+    uint64_t latency[LATENCY_BUCKETS];
+} MergedFunction;
+
+typedef struct {
+    MergedFunction functions[STAT_FUNCTION_COUNT];
+    uint64_t depth[DEPTH_BUCKETS];
+    uint64_t allocs[STAT_ALLOC_SITE_COUNT];
+    uint64_t alloc_bytes[STAT_ALLOC_SITE_COUNT];
+    uint64_t frees[STAT_ALLOC_SITE_COUNT];
+    int threads;
+} MergedStats;
+
+#define LOAD(c) atomic_load_explicit(&(c), memory_order_relaxed)
+
+static void merge_shards(MergedStats *m){
+    memset(m, 0, sizeof(*m));
+    pthread_mutex_lock(&shard_lock);
+    for (StatsShard *s = shard_list; s; s = s->next) {
+        m->threads++;
+        for (int f = 0; f < STAT_FUNCTION_COUNT; f++) {
+            m->functions[f].calls += LOAD(s->functions[f].calls);
+            m->functions[f].total_ns += LOAD(s->functions[f].total_ns);
+            for (int c = 0; c < NUM_STATUS_CODES; c++)
+                m->functions[f].by_status[c] += LOAD(s->functions[f].by_status[c]);
+            for (int b = 0; b < LATENCY_BUCKETS; b++)
+                m->functions[f].latency[b] += LOAD(s->functions[f].latency[b]);
+        }
+        for (int d = 0; d < DEPTH_BUCKETS; d++)
+            m->depth[d] += LOAD(s->depth[d]);
+        for (int a = 0; a < STAT_ALLOC_SITE_COUNT; a++) {
+            m->allocs[a] += LOAD(s->allocs[a]);
+            m->alloc_bytes[a] += LOAD(s->alloc_bytes[a]);
+            m->frees[a] += LOAD(s->frees[a]);
+        }
+    }
+    pthread_mutex_unlock(&shard_lock);
+}
+
+// Upper edge of the bucket holding the p-th percentile sample.
+static uint64_t latency_percentile(const uint64_t *hist, uint64_t total, double p){
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(p * (double)total);
+    if (rank >= total) rank = total - 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += hist[b];
+        if (seen > rank) return ((uint64_t)2 << b) - 1;
+    }
+    return 0;
+}
+
+static void write_text(FILE *out, const MergedStats *m){
+    fprintf(out, "controller stats (%d thread shard%s)\n", m->threads, m->threads == 1 ? "" : "s");
+    fprintf(out, "%-24s %10s %12s %12s %12s  outcomes\n", "function", "calls", "mean ns", "p50 ns", "p99 ns");
+    for (int f = 0; f < STAT_FUNCTION_COUNT; f++) {
+        const MergedFunction *fn = &m->functions[f];
+        if (fn->calls == 0) continue;
+        fprintf(out, "%-24s %10llu %12llu %12llu %12llu ", function_names[f],
+                (unsigned long long)fn->calls,
+                (unsigned long long)(fn->total_ns / fn->calls),
+                (unsigned long long)latency_percentile(fn->latency, fn->calls, 0.50),
+                (unsigned long long)latency_percentile(fn->latency, fn->calls, 0.99));
+        for (int c = 0; c < NUM_STATUS_CODES; c++) {
+            if (fn->by_status[c])
+                fprintf(out, " %s=%llu", status_names[c], (unsigned long long)fn->by_status[c]);
+        }
+        fputc('\n', out);
+    }
+
+    uint64_t lookups = 0, depth_sum = 0;
+    int depth_max = 0;
+    for (int d = 0; d < DEPTH_BUCKETS; d++) {
+        lookups += m->depth[d];
+        depth_sum += m->depth[d] * (uint64_t)d;
+        if (m->depth[d]) depth_max = d;
+    }
+    fprintf(out, "tree findData: %llu lookups, mean depth %.2f, max depth %d\n",
+            (unsigned long long)lookups, lookups ? (double)depth_sum / (double)lookups : 0.0, depth_max);
+
+    for (int a = 0; a < STAT_ALLOC_SITE_COUNT; a++) {
+        fprintf(out, "alloc %-14s %10llu allocs %14llu bytes %10llu frees\n", alloc_names[a],
+                (unsigned long long)m->allocs[a], (unsigned long long)m->alloc_bytes[a],
+                (unsigned long long)m->frees[a]);
+    }
+}
+
+static void write_json(FILE *out, const MergedStats *m){
+    fprintf(out, "{\"enabled\": true, \"threads\": %d, \"functions\": {", m->threads);
+    int first = 1;
+    for (int f = 0; f < STAT_FUNCTION_COUNT; f++) {
+        const MergedFunction *fn = &m->functions[f];
+        fprintf(out, "%s\"%s\": {\"calls\": %llu, \"total_ns\": %llu, \"p50_ns\": %llu, \"p99_ns\": %llu, \"status\": {",
+                first ? "" : ", ", function_names[f], (unsigned long long)fn->calls,
+                (unsigned long long)fn->total_ns,
+                (unsigned long long)latency_percentile(fn->latency, fn->calls, 0.50),
+                (unsigned long long)latency_percentile(fn->latency, fn->calls, 0.99));
+        first = 0;
+        for (int c = 0; c < NUM_STATUS_CODES; c++) {
+            fprintf(out, "%s\"%s\": %llu", c ? ", " : "", status_names[c],
+                    (unsigned long long)fn->by_status[c]);
+        }
+        fprintf(out, "}, \"latency_log2_ns\": [");
+        for (int b = 0; b < LATENCY_BUCKETS; b++) {
+            fprintf(out, "%s%llu", b ? ", " : "", (unsigned long long)fn->latency[b]);
+        }
+        fprintf(out, "]}");
+    }
+    fprintf(out, "}, \"tree_depth\": [");
+    for (int d = 0; d < DEPTH_BUCKETS; d++) {
+        fprintf(out, "%s%llu", d ? ", " : "", (unsigned long long)m->depth[d]);
+    }
+    fprintf(out, "], \"allocations\": {");
+    for (int a = 0; a < STAT_ALLOC_SITE_COUNT; a++) {
+        fprintf(out, "%s\"%s\": {\"count\": %llu, \"bytes\": %llu, \"frees\": %llu}", a ? ", " : "",
+                alloc_names[a], (unsigned long long)m->allocs[a],
+                (unsigned long long)m->alloc_bytes[a], (unsigned long long)m->frees[a]);
+    }
+    fprintf(out, "}}\n");
+}
+
+ControllerStatusCode controller_stats_dump(char **out, StatsFormat format){
+    if (out == NULL || (format != STATS_FORMAT_TEXT && format != STATS_FORMAT_JSON)) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    MergedStats *m = malloc(sizeof(MergedStats));
+    if (m == NULL) {
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    merge_shards(m);
+
+    char *buf = NULL;
+    size_t len = 0;
+    FILE *stream = open_memstream(&buf, &len);
+    if (stream == NULL) {
+        free(m);
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    if (format == STATS_FORMAT_JSON) {
+        write_json(stream, m);
+    } else {
+        write_text(stream, m);
+    }
+    int failed = fclose(stream) != 0;
+    free(m);
+    if (failed) {
+        free(buf);
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    *out = buf;
+    return CONTROLLER_OK;
+}
+
+void controller_stats_reset(void){
+    pthread_mutex_lock(&shard_lock);
+    for (StatsShard *s = shard_list; s; s = s->next) {
+        // Every field is a relaxed atomic counter, so zeroing word by word is well-defined.
+        atomic_uint_fast64_t *words = (atomic_uint_fast64_t *)s;
+        size_t n = offsetof(StatsShard, next) / sizeof(atomic_uint_fast64_t);
+        for (size_t i = 0; i < n; i++)
+            atomic_store_explicit(&words[i], 0, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&shard_lock);
+}
+
+#else // !CONTROLLER_STATS
+
+ControllerStatusCode controller_stats_dump(char **out, StatsFormat format){
+    if (out == NULL || (format != STATS_FORMAT_TEXT && format != STATS_FORMAT_JSON)) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    const char *msg = format == STATS_FORMAT_JSON
+        ? "{\"enabled\": false}\n"
+        : "controller stats disabled (rebuild with -DCONTROLLER_STATS)\n";
+    char *buf = malloc(strlen(msg) + 1);
+    if (buf == NULL) {
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    strcpy(buf, msg);
+    *out = buf;
+    return CONTROLLER_OK;
+}
+
+void controller_stats_reset(void){
+}
+
+#endif // CONTROLLER_STATS
@@ -1,31 +1,842 @@
-include "dungeon_controller.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dungeon_controller.h"
+#include "controller_stats.h"
+#include "dungeon_loader.h"
+#include "memory_account.h"
+#include "render_template.h"
+#include "room.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include "worldgen_config.h"
+
+#define PLAYER_START_HEALTH 100
+
+#define BATCH_SERIAL_BYTES (64 * 1024)  // batches smaller than this are rendered on the caller
+#define BATCH_CHUNK_BYTES (32 * 1024)   // target bytes per parallel work item
+#define SEQ_SPINS_BEFORE_YIELD 64       // seqlock read attempts before a reader yields the CPU
+
+static ControllerStatusCode is_walkable_impl(const Room *room, int x, int y, bool *result);
+
+// -------------------------
+// Seqlock helpers
+// -------------------------
+
+// Tells the CPU this is a spin-wait, so it backs off the cache line and yields the core's
+// resources to a sibling hardware thread (quite possibly the writer).
+static inline void cpu_relax(void){
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Readers wait while a move is half-applied, then remember the (even) sequence they started at.
+// Moves are a handful of stores, so spin politely first; a tick steps whole rooms and can
+// take longer, and a writer that was preempted mid-section longer still, so then yield.
+static unsigned seq_read_begin(const Controller *ctrl){
+    unsigned seq;
+    int spins = 0;
+    while ((seq = atomic_load_explicit(&ctrl->seq, memory_order_acquire)) & 1u) {
+        if (++spins < SEQ_SPINS_BEFORE_YIELD) {
+            cpu_relax();
+        } else {
+            sched_yield();
+        }
+    }
+    return seq;
+}
+
+// True if a move started or finished since seq_read_begin; the snapshot must then be discarded.
+static bool seq_read_retry(const Controller *ctrl, unsigned start){
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&ctrl->seq, memory_order_relaxed) != start;
+}
+
+static void seq_write_begin(Controller *ctrl){
+    unsigned seq = atomic_load_explicit(&ctrl->seq, memory_order_relaxed);
+    atomic_store_explicit(&ctrl->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static void seq_write_end(Controller *ctrl){
+    unsigned seq = atomic_load_explicit(&ctrl->seq, memory_order_relaxed);
+    atomic_store_explicit(&ctrl->seq, seq + 1, memory_order_release);
+}
+
+static void read_player(const Controller *ctrl, Player *out){
+    unsigned start;
+    do {
+        start = seq_read_begin(ctrl);
+        *out = ctrl->player;
+    } while (seq_read_retry(ctrl, start));
+}
+
+// -------------------------
+// Room helpers
+// -------------------------
+
+static const Room *lookup_room(const Controller *ctrl, int id){
+    Room key = {0};
+    key.id = id;
+    return findData(ctrl->room_tree, &key);
+}
+
+static const Door *find_door(const Room *room, Direction dir){
+    for (int i = 0; i < room->num_doors; i++) {
+        if (room->doors[i].dir == dir) {
+            return &room->doors[i];
+        }
+    }
+    return NULL;
+}
+
+static Direction opposite_direction(Direction dir){
+    switch (dir) {
+        case DIR_NORTH: return DIR_SOUTH;
+        case DIR_SOUTH: return DIR_NORTH;
+        case DIR_EAST:  return DIR_WEST;
+        default:        return DIR_EAST;
+    }
+}
+
+// Picks the tile the player appears on: the centre if free, otherwise the first walkable tile.
+static bool find_spawn_tile(const Room *room, int *x, int *y){
+    bool walkable = false;
+    is_walkable_impl(room, room->width / 2, room->height / 2, &walkable);
+    if (walkable) {
+        *x = room->width / 2;
+        *y = room->height / 2;
+        return true;
+    }
+    for (int ty = 0; ty < room->height; ty++) {
+        for (int tx = 0; tx < room->width; tx++) {
+            is_walkable_impl(room, tx, ty, &walkable);
+            if (walkable) {
+                *x = tx;
+                *y = ty;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Marks a room's renders stale; called by the writer inside a write section.
+static void touch_room(Controller *ctrl, int room_id){
+    if (room_id >= 0 && room_id <= ctrl->max_room_id) {
+        atomic_fetch_add_explicit(&ctrl->room_versions[room_id], 1, memory_order_relaxed);
+    }
+}
+
+// Returns true if this is the first visit to the room.
+static bool mark_visited(Controller *ctrl, int room_id){
+    if (room_id >= 0 && room_id <= ctrl->max_room_id) {
+        return atomic_exchange_explicit(&ctrl->visited[room_id], 1, memory_order_acq_rel) == 0;
+    }
+    return false;
+}
+
+static bool room_visited(const Controller *ctrl, int room_id){
+    return room_id >= 0 && room_id <= ctrl->max_room_id &&
+           atomic_load_explicit(&ctrl->visited[room_id], memory_order_acquire) != 0;
+}
+
+// Forgets every visit. Writer thread only, before readers can see the controller.
+static void clear_visited(Controller *ctrl){
+    for (int i = 0; i <= ctrl->max_room_id; i++) {
+        atomic_store_explicit(&ctrl->visited[i], 0, memory_order_relaxed);
+    }
+}
+
+// -------------------------
+// Event helpers
+// -------------------------
+
+static void event_init(ControllerEvent *ev, ControllerEventType type){
+    ev->type = type;
+    ev->from_room_id = ev->from_x = ev->from_y = -1;
+    ev->dx = ev->dy = ev->dir = ev->status = -1;
+}
+
+// Stamps the event with the player's current state and pushes it. Writer thread only.
+static void emit(const Controller *ctrl, ControllerEvent *ev){
+    ev->tick = simulation_tick(ctrl->sim);
+    ev->room_id = ctrl->player.current_room ? ctrl->player.current_room->id : -1;
+    ev->x = ctrl->player.tile_x;
+    ev->y = ctrl->player.tile_y;
+    event_stream_push(ctrl->events, ev);
+}
+
+// Reports a failed move to the event stream and passes its status through.
+static ControllerStatusCode move_blocked(const Controller *ctrl, ControllerStatusCode status,
+                                         int dx, int dy, int dir){
+    if (ctrl->events != NULL) {
+        ControllerEvent ev;
+        event_init(&ev, EVENT_MOVE_BLOCKED);
+        ev.dx = dx;
+        ev.dy = dy;
+        ev.dir = dir;
+        ev.status = status;
+        emit(ctrl, &ev);
+    }
+    return status;
+}
+
+// -------------------------
+// Journal helpers
+// -------------------------
+
+// Writes the writer's current state as the journal's checkpoint.
+static ControllerStatusCode write_checkpoint(Controller *ctrl){
+    int *visited = malloc(((size_t)ctrl->max_room_id + 1) * sizeof(int));
+    size_t sim_size = simulation_state_size(ctrl->sim);
+    void *sim_state = malloc(sim_size > 0 ? sim_size : 1);
+    if (visited == NULL || sim_state == NULL) {
+        free(visited);
+        free(sim_state);
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    size_t count = 0;
+    for (int i = 0; i <= ctrl->max_room_id; i++) {
+        if (room_visited(ctrl, i)) {
+            visited[count++] = i;
+        }
+    }
+    simulation_save_state(ctrl->sim, sim_state);
+
+    JournalCheckpoint cp = {0};
+    cp.room_id = ctrl->player.current_room->id;
+    cp.tile_x = ctrl->player.tile_x;
+    cp.tile_y = ctrl->player.tile_y;
+    cp.health = ctrl->player.health;
+    cp.alive = ctrl->player.alive;
+    cp.visited_ids = visited;
+    cp.visited_count = count;
+    cp.sim_state = sim_state;
+    cp.sim_state_size = sim_size;
+    JournalStatusCode status = journal_write_checkpoint(ctrl->journal, &cp);
+    free(visited);
+    free(sim_state);
+    return status == JOURNAL_OK ? CONTROLLER_OK : CONTROLLER_ERROR;
+}
+
+// Logs one successful operation, checkpointing when the interval is up. Writer thread only.
+static void journal_record(Controller *ctrl, const JournalRecord *record){
+    if (journal_append(ctrl->journal, record) == JOURNAL_OK &&
+        journal_checkpoint_due(ctrl->journal)) {
+        write_checkpoint(ctrl);
+    }
+}
+
+static size_t render_size(const Room *room){
+    return (size_t)(room->width + 1) * (size_t)room->height + 1;
+}
+
+// Draws the floor, walls and doors of the top-left clip_w x clip_h tiles, rows `stride` bytes apart.
+static void draw_background(const Room *room, char *buf, size_t stride, int clip_w, int clip_h){
+    int w = room->width < clip_w ? room->width : clip_w;
+    int h = room->height < clip_h ? room->height : clip_h;
+
+    for (int y = 0; y < h; y++) {
+        char *row = buf + (size_t)y * stride;
+        bool edge_row = (y == 0 || y == room->height - 1);
+        for (int x = 0; x < w; x++) {
+            row[x] = (edge_row || x == 0 || x == room->width - 1) ? TILE_WALL : TILE_FLOOR;
+        }
+    }
+    for (int i = 0; i < room->num_doors; i++) {
+        const Door *d = &room->doors[i];
+        if (d->x >= 0 && d->x < w && d->y >= 0 && d->y < h) {
+            buf[(size_t)d->y * stride + d->x] = TILE_DOOR;
+        }
+    }
+}
+
+// Draws items, monsters, then (if present) the player over the background.
+static void draw_entities(const Room *room, const Player *player, char *buf, size_t stride,
+                          int clip_w, int clip_h){
+    int w = room->width < clip_w ? room->width : clip_w;
+    int h = room->height < clip_h ? room->height : clip_h;
+
+    for (int i = 0; i < room->num_items; i++) {
+        const Item *it = &room->items[i];
+        if (it->x >= 0 && it->x < w && it->y >= 0 && it->y < h) {
+            buf[(size_t)it->y * stride + it->x] = it->symbol;
+        }
+    }
+    for (int i = 0; i < room->num_monsters; i++) {
+        const Monster *m = &room->monsters[i];
+        if (m->x >= 0 && m->x < w && m->y >= 0 && m->y < h) {
+            buf[(size_t)m->y * stride + m->x] = m->symbol;
+        }
+    }
+    if (player != NULL && player->current_room == room &&
+        player->tile_x >= 0 && player->tile_x < w && player->tile_y >= 0 && player->tile_y < h) {
+        buf[(size_t)player->tile_y * stride + player->tile_x] = TILE_PLAYER;
+    }
+}
+
+// Draws the top-left clip_w x clip_h tiles of the room into buf, rows `stride` bytes apart.
+// Layers go floor/wall, doors, items, monsters, then (if present) the player.
+static void draw_room(const Room *room, const Player *player, char *buf, size_t stride,
+                      int clip_w, int clip_h){
+    draw_background(room, buf, stride, clip_w, clip_h);
+    draw_entities(room, player, buf, stride, clip_w, clip_h);
+}
+
+// Renders the whole room as newline-terminated rows followed by a NUL.
+// The background comes from the template cache when the room's layout allows it.
+static void render_into(const Controller *ctrl, const Room *room, const Player *player, char *buf){
+    const size_t stride = (size_t)room->width + 1;
+    if (!template_cache_render(ctrl->templates, room, buf)) {
+        draw_background(room, buf, stride, room->width, room->height);
+        for (int y = 0; y < room->height; y++) {
+            buf[(size_t)y * stride + room->width] = '\n';
+        }
+        buf[stride * (size_t)room->height] = '\0';
+    }
+    draw_entities(room, player, buf, stride, room->width, room->height);
+}
+
+// Renders `room` with a consistent snapshot of the player.
+static void render_one(const Controller *ctrl, const Room *room, char *buf){
+    unsigned start;
+    do {
+        start = seq_read_begin(ctrl);
+        Player p = ctrl->player;
+        render_into(ctrl, room, &p, buf);
+    } while (seq_read_retry(ctrl, start));
+}
+
+static void controller_free_impl(Controller *ctrl){
+    if (ctrl == NULL) {
+        return;
+    }
+    if (ctrl->journal != NULL) {
+        journal_sync(ctrl->journal);
+    }
+    MemoryAccount *memory = ctrl->memory;
+    MemoryAccount *previous = mem_account_enter(memory);
+    simulation_destroy(ctrl->sim);
+    template_cache_destroy(ctrl->templates);
+    mem_free(MEM_INDEXES, ctrl->room_versions, ((size_t)ctrl->max_room_id + 1) * sizeof(atomic_uint));
+    mem_free(MEM_INDEXES, ctrl->visited, ((size_t)ctrl->max_room_id + 1) * sizeof(atomic_int));
+    destroyTree(ctrl->room_tree);
+    mem_free(MEM_INDEXES, ctrl, sizeof(Controller));
+    STATS_FREE(STAT_ALLOC_CONTROLLER);
+    mem_account_enter(previous);
+    free(memory);
+}
+
+// Why building a controller failed: out of memory if `memory` refused a charge for the
+// budget or saw an allocation come back NULL, `otherwise` if not.
+static ControllerStatusCode setup_failure(const MemoryAccount *memory, ControllerStatusCode otherwise){
+    if (atomic_load_explicit(&memory->refused, memory_order_relaxed) > 0 ||
+        atomic_load_explicit(&memory->failed, memory_order_relaxed) > 0) {
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    return otherwise;
+}
+
+// Takes ownership of `tree` and `memory`; finishes setting up a freshly allocated controller.
+// `memory` must be the calling thread's current account. On failure sets `status`.
+static Controller *controller_setup(Tree *tree, Room *start, const DungeonConfig *config,
+                                    MemoryAccount *memory, ControllerStatusCode *status){
+    if (tree == NULL) {
+        *status = setup_failure(memory, CONTROLLER_ERROR);
+        free(memory);
+        return NULL;
+    }
+    Controller *ctrl = mem_calloc(MEM_INDEXES, 1, sizeof(Controller));
+    if (ctrl == NULL) {
+        *status = CONTROLLER_ALLOCATION_FAILED;
+        destroyTree(tree);
+        free(memory);
+        return NULL;
+    }
+    STATS_ALLOC(STAT_ALLOC_CONTROLLER, sizeof(Controller));
+    ctrl->memory = memory;
+    ctrl->room_tree = tree;
+    ctrl->config = *config;
+    if (start == NULL) {
+        *status = setup_failure(memory, CONTROLLER_ERROR);
+        controller_free_impl(ctrl);
+        return NULL;
+    }
+
+    // Rooms come out of the iterator in ID order, so the last one holds the highest ID.
+    ctrl->max_room_id = -1;
+    TreeIterator *iter = createIterator(ctrl->room_tree);
+    for (Room *r = nextData(iter); r != NULL; r = nextData(iter)) {
+        ctrl->max_room_id = r->id;
+    }
+    destroyIterator(iter);
+
+    // Rooms are never added after load, so switch lookups to the compact frozen layout.
+    // If that fails the tree is left as it was and still works, just slower.
+    TRACE_BEGIN(freeze);
+    freezeTree(ctrl->room_tree, room_key);
+    TRACE_END(freeze, "load", "freeze_tree");
+
+    TRACE_BEGIN(sim);
+    ctrl->sim = simulation_create(ctrl->room_tree, ctrl->max_room_id, CONTROLLER_DEFAULT_ACTIVE_RADIUS);
+    TRACE_END(sim, "load", "simulation_create");
+    ctrl->room_versions = mem_alloc(MEM_INDEXES, ((size_t)ctrl->max_room_id + 1) * sizeof(atomic_uint));
+    ctrl->visited = mem_alloc(MEM_INDEXES, ((size_t)ctrl->max_room_id + 1) * sizeof(atomic_int));
+    ctrl->templates = template_cache_create(TEMPLATE_CACHE_DEFAULT_BYTES);
+    if (ctrl->sim == NULL || ctrl->room_versions == NULL || ctrl->visited == NULL ||
+        ctrl->templates == NULL) {
+        *status = setup_failure(memory, CONTROLLER_ERROR);
+        controller_free_impl(ctrl);
+        return NULL;
+    }
+    for (int i = 0; i <= ctrl->max_room_id; i++) {
+        atomic_init(&ctrl->room_versions[i], 1);
+        atomic_init(&ctrl->visited[i], 0);
+    }
+
+    ctrl->player.current_room = start;
+    ctrl->player.health = PLAYER_START_HEALTH;
+    ctrl->player.alive = true;
+    TRACE_BEGIN(place);
+    bool placed = find_spawn_tile(start, &ctrl->player.tile_x, &ctrl->player.tile_y);
+    TRACE_END(place, "load", "place_player");
+    if (!placed) {
+        *status = CONTROLLER_ERROR;     // no free floor tile in the start room
+        controller_free_impl(ctrl);
+        return NULL;
+    }
+    atomic_init(&ctrl->seq, 0);
+    mark_visited(ctrl, start->id);
+    return ctrl;
+}
+
+static MemoryAccount *memory_account_create(size_t budget){
+    MemoryAccount *memory = malloc(sizeof(MemoryAccount));
+    if (memory != NULL) {
+        mem_account_init(memory, budget);
+    }
+    return memory;
+}
+
+// Loads `config_file` with libworldgen; `config` is the file as worldgen_config_scan read it.
+// `progress` is optional; when given, the load counts rooms in it and can be cancelled through it.
+// Everything the controller allocates is charged to a new account limited to `budget` (0: no limit).
+// Sets `status` to CONTROLLER_OK or the reason the controller could not be built.
+static Controller *controller_load_file(const char *config_file, const DungeonConfig *config,
+                                        LoadProgress *progress, size_t budget,
+                                        ControllerStatusCode *status){
+    if (progress != NULL) {
+        atomic_store_explicit(&progress->total, config->world.num_rooms, memory_order_relaxed);
+    }
+    MemoryAccount *memory = memory_account_create(budget);
+    if (memory == NULL) {
+        *status = CONTROLLER_ALLOCATION_FAILED;
+        return NULL;
+    }
+    MemoryAccount *previous = mem_account_enter(memory);
+    Room *start = NULL;
+    TRACE_BEGIN(load);
+    Tree *tree = load_dungeon_with_progress(config_file, progress, &start, NULL);
+    TRACE_END(load, "load", "load_dungeon");
+    *status = CONTROLLER_OK;
+    Controller *ctrl = controller_setup(tree, start, config, memory, status);
+    mem_account_enter(previous);
+    return ctrl;
+}
+
+// controller_load_file after scanning the file, which fails (as CONTROLLER_INVALID_ARGUMENT)
+// only if it cannot be read.
+static Controller *controller_init_impl(const char *config_file, LoadProgress *progress, size_t budget,
+                                        ControllerStatusCode *status){
+    // libworldgen reads the file itself; scanning it only tells us how big the dungeon will be.
+    DungeonConfig config;
+    TRACE_BEGIN(parse);
+    ConfigStatusCode parsed = worldgen_config_scan(config_file, &config);
+    TRACE_END(parse, "load", "parse_config");
+    if (parsed != CONFIG_OK) {
+        *status = CONTROLLER_INVALID_ARGUMENT;
+        return NULL;
+    }
+    return controller_load_file(config_file, &config, progress, budget, status);
+}
+
+static Controller *controller_init_with_config_impl(const DungeonConfig *config, LoadProgress *progress,
+                                                    size_t budget, ControllerStatusCode *status){
+    if (config == NULL) {
+        *status = CONTROLLER_INVALID_ARGUMENT;
+        return NULL;
+    }
+    MemoryAccount *memory = memory_account_create(budget);
+    if (memory == NULL) {
+        *status = CONTROLLER_ALLOCATION_FAILED;
+        return NULL;
+    }
+    MemoryAccount *previous = mem_account_enter(memory);
+    Room *start = NULL;
+    TRACE_BEGIN(load);
+    Tree *tree = load_dungeon_sharded(config, 1, progress, &start, NULL);
+    TRACE_END(load, "load", "load_dungeon");
+    *status = CONTROLLER_OK;
+    Controller *ctrl = controller_setup(tree, start, config, memory, status);
+    if (ctrl != NULL) {
+        ctrl->generated = true;
+    }
+    mem_account_enter(previous);
+    return ctrl;
+}
 
 /**
  * Creates and initializes the game controller.
- * 
+ *
  * This function loads the dungeon using the world generator config
  * and places the player in the starting room.
- * 
+ *
  * @param config_file Path to the worldgen .ini file
  * @return Pointer to the new controller, or NULL on failure
  */
 Controller *controller_init(const char *config_file){
-    return NULL;
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status;
+    Controller *ctrl = controller_init_impl(config_file, NULL, 0, &status);
+    STATS_CALL_END(STAT_CONTROLLER_INIT, status);
+    return ctrl;
+}
+
+/**
+ * Creates a controller from an already-parsed config.
+ *
+ * The dungeon is built by the native generator, so no file is read.
+ *
+ * @param config Config that passes worldgen_config_validate()
+ * @return Pointer to the new controller, or NULL on failure
+ */
+Controller *controller_init_with_config(const DungeonConfig *config){
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status;
+    Controller *ctrl = controller_init_with_config_impl(config, NULL, 0, &status);
+    STATS_CALL_END(STAT_CONTROLLER_INIT, status);
+    return ctrl;
+}
+
+// Least a dungeon of `num_rooms` rooms can take: the Room structs alone.
+static size_t min_dungeon_bytes(int num_rooms){
+    return (size_t)num_rooms * sizeof(Room);
+}
+
+static ControllerStatusCode controller_init_budgeted_impl(const char *config_file, const DungeonConfig *config,
+                                                          size_t budget, Controller **out){
+    if (out == NULL || (config_file == NULL && config == NULL)) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    *out = NULL;
+    DungeonConfig scanned;
+    if (config_file != NULL) {
+        TRACE_BEGIN(parse);
+        ConfigStatusCode parsed = worldgen_config_scan(config_file, &scanned);
+        TRACE_END(parse, "load", "parse_config");
+        if (parsed != CONFIG_OK) {
+            return CONTROLLER_INVALID_ARGUMENT;
+        }
+        config = &scanned;
+    } else if (worldgen_config_validate(config, NULL) != CONFIG_OK) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    // Refuse dungeons that cannot fit before generating a single room.
+    if (budget != 0 && min_dungeon_bytes(config->world.num_rooms) > budget) {
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    ControllerStatusCode status;
+    *out = config_file != NULL
+        ? controller_load_file(config_file, config, NULL, budget, &status)
+        : controller_init_with_config_impl(config, NULL, budget, &status);
+    return status;
+}
+
+/**
+ * Creates a controller from a config file, holding it to a memory budget.
+ *
+ * @param config_file Path to the worldgen .ini file
+ * @param budget_bytes Most bytes the controller may hold; 0 for no limit
+ * @param out Receives the controller
+ * @return CONTROLLER_OK, CONTROLLER_INVALID_ARGUMENT, CONTROLLER_ALLOCATION_FAILED or CONTROLLER_ERROR
+ */
+ControllerStatusCode controller_init_budgeted(const char *config_file, size_t budget_bytes, Controller **out){
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = config_file != NULL
+        ? controller_init_budgeted_impl(config_file, NULL, budget_bytes, out)
+        : CONTROLLER_INVALID_ARGUMENT;
+    STATS_CALL_END(STAT_CONTROLLER_INIT, status);
+    return status;
+}
+
+/**
+ * Creates a controller from a parsed config, holding it to a memory budget.
+ *
+ * @param config Config that passes worldgen_config_validate()
+ * @param budget_bytes Most bytes the controller may hold; 0 for no limit
+ * @param out Receives the controller
+ * @return CONTROLLER_OK, CONTROLLER_INVALID_ARGUMENT, CONTROLLER_ALLOCATION_FAILED or CONTROLLER_ERROR
+ */
+ControllerStatusCode controller_init_with_config_budgeted(const DungeonConfig *config, size_t budget_bytes,
+                                                          Controller **out){
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = config != NULL
+        ? controller_init_budgeted_impl(NULL, config, budget_bytes, out)
+        : CONTROLLER_INVALID_ARGUMENT;
+    STATS_CALL_END(STAT_CONTROLLER_INIT, status);
+    return status;
+}
+
+static ControllerStatusCode controller_memory_usage_impl(const Controller *ctrl, ControllerMemoryUsage *out){
+    if (ctrl == NULL || out == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    const MemoryAccount *m = ctrl->memory;
+    out->tree_nodes = atomic_load_explicit(&m->bytes[MEM_TREE_NODES], memory_order_relaxed);
+    out->rooms = atomic_load_explicit(&m->bytes[MEM_ROOMS], memory_order_relaxed);
+    out->entities = atomic_load_explicit(&m->bytes[MEM_ENTITIES], memory_order_relaxed);
+    out->render = atomic_load_explicit(&m->bytes[MEM_RENDER], memory_order_relaxed);
+    out->indexes = atomic_load_explicit(&m->bytes[MEM_INDEXES], memory_order_relaxed);
+    out->total = atomic_load_explicit(&m->total, memory_order_relaxed);
+    out->peak = atomic_load_explicit(&m->peak, memory_order_relaxed);
+    out->refused = atomic_load_explicit(&m->refused, memory_order_relaxed);
+    out->budget = m->budget;
+    return CONTROLLER_OK;
+}
+
+/**
+ * Reports the bytes a controller holds, by category.
+ */
+ControllerStatusCode controller_memory_usage(const Controller *ctrl, ControllerMemoryUsage *out){
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = controller_memory_usage_impl(ctrl, out);
+    STATS_CALL_END(STAT_MEMORY_USAGE, status);
+    return status;
 }
 
 /**
  * Frees all memory associated with the controller.
- * 
+ *
  * This includes the tree, all rooms, and internal tracking arrays.
  */
 void controller_free(Controller *ctrl){
-    return;
+    STATS_CALL_BEGIN();
+    controller_free_impl(ctrl);
+    STATS_CALL_END(STAT_CONTROLLER_FREE, CONTROLLER_OK);
+}
+
+// -------------------------
+// Asynchronous Initialization
+// -------------------------
+
+struct ControllerLoad {
+    pthread_t thread;
+    char *config_file;          // NULL when building from `config`
+    DungeonConfig config;
+    LoadProgress progress;
+    ControllerLoadCallback callback;
+    void *user_data;
+
+    pthread_mutex_t lock;       // guards ctrl and the RUNNING -> final transition
+    pthread_cond_t finished;
+    atomic_int state;           // ControllerLoadState
+    Controller *ctrl;           // built controller until taken
+};
+
+static void *controller_load_run(void *arg){
+    ControllerLoad *load = arg;
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status;
+    Controller *ctrl = load->config_file != NULL
+        ? controller_init_impl(load->config_file, &load->progress, 0, &status)
+        : controller_init_with_config_impl(&load->config, &load->progress, 0, &status);
+    bool cancelled = atomic_load_explicit(&load->progress.cancelled, memory_order_relaxed);
+    if (ctrl != NULL && cancelled) {
+        controller_free_impl(ctrl);
+        ctrl = NULL;
+        status = CONTROLLER_ERROR;
+    }
+    STATS_CALL_END(STAT_CONTROLLER_INIT, status);
+
+    ControllerLoadState state = ctrl != NULL ? CONTROLLER_LOAD_DONE
+                              : cancelled ? CONTROLLER_LOAD_CANCELLED : CONTROLLER_LOAD_FAILED;
+    pthread_mutex_lock(&load->lock);
+    load->ctrl = ctrl;
+    atomic_store_explicit(&load->state, state, memory_order_release);
+    pthread_cond_broadcast(&load->finished);
+    pthread_mutex_unlock(&load->lock);
+
+    if (load->callback != NULL) {
+        load->callback(load, state, load->user_data);
+    }
+    return NULL;
+}
+
+static ControllerLoad *controller_load_start(const char *config_file, const DungeonConfig *config,
+                                             ControllerLoadCallback callback, void *user_data){
+    ControllerLoad *load = calloc(1, sizeof(ControllerLoad));
+    if (load == NULL) {
+        return NULL;
+    }
+    atomic_init(&load->progress.loaded, 0);
+    atomic_init(&load->progress.total, 0);
+    atomic_init(&load->progress.cancelled, false);
+    atomic_init(&load->state, CONTROLLER_LOAD_RUNNING);
+    load->callback = callback;
+    load->user_data = user_data;
+    if (config_file != NULL) {
+        load->config_file = strdup(config_file);
+        if (load->config_file == NULL) {
+            free(load);
+            return NULL;
+        }
+    } else {
+        load->config = *config;
+        atomic_store_explicit(&load->progress.total, config->world.num_rooms, memory_order_relaxed);
+    }
+
+    if (pthread_mutex_init(&load->lock, NULL) != 0) {
+        free(load->config_file);
+        free(load);
+        return NULL;
+    }
+    if (pthread_cond_init(&load->finished, NULL) != 0 ||
+        pthread_create(&load->thread, NULL, controller_load_run, load) != 0) {
+        pthread_cond_destroy(&load->finished);
+        pthread_mutex_destroy(&load->lock);
+        free(load->config_file);
+        free(load);
+        return NULL;
+    }
+    return load;
+}
+
+/**
+ * Starts building a controller from a config file on a background thread.
+ *
+ * @param config_file Path to the worldgen .ini file
+ * @param callback Optional; called on the loading thread when the load ends
+ * @param user_data Passed to `callback`
+ * @return Handle to the load, or NULL if it could not be started
+ */
+ControllerLoad *controller_init_async(const char *config_file, ControllerLoadCallback callback,
+                                      void *user_data){
+    if (config_file == NULL) {
+        return NULL;
+    }
+    return controller_load_start(config_file, NULL, callback, user_data);
+}
+
+/**
+ * Starts building a controller from a parsed config on a background thread.
+ *
+ * @param config Config to build from; copied
+ * @param callback Optional; called on the loading thread when the load ends
+ * @param user_data Passed to `callback`
+ * @return Handle to the load, or NULL if it could not be started
+ */
+ControllerLoad *controller_init_with_config_async(const DungeonConfig *config,
+                                                  ControllerLoadCallback callback, void *user_data){
+    if (config == NULL) {
+        return NULL;
+    }
+    return controller_load_start(NULL, config, callback, user_data);
+}
+
+/**
+ * Reads a load's state and room counts without blocking.
+ */
+ControllerLoadState controller_load_poll(const ControllerLoad *load, int *loaded, int *total){
+    if (load == NULL) {
+        return CONTROLLER_LOAD_FAILED;
+    }
+    ControllerLoadState state = atomic_load_explicit(&load->state, memory_order_acquire);
+    if (loaded != NULL) {
+        *loaded = atomic_load_explicit(&load->progress.loaded, memory_order_relaxed);
+    }
+    if (total != NULL) {
+        *total = atomic_load_explicit(&load->progress.total, memory_order_relaxed);
+    }
+    return state;
+}
+
+/**
+ * Waits for the load to finish and returns its final state.
+ */
+ControllerLoadState controller_load_wait(ControllerLoad *load){
+    if (load == NULL) {
+        return CONTROLLER_LOAD_FAILED;
+    }
+    pthread_mutex_lock(&load->lock);
+    while (atomic_load_explicit(&load->state, memory_order_relaxed) == CONTROLLER_LOAD_RUNNING) {
+        pthread_cond_wait(&load->finished, &load->lock);
+    }
+    ControllerLoadState state = atomic_load_explicit(&load->state, memory_order_relaxed);
+    pthread_mutex_unlock(&load->lock);
+    return state;
+}
+
+/**
+ * Asks a running load to stop and discard what it built.
+ */
+void controller_load_cancel(ControllerLoad *load){
+    if (load != NULL) {
+        atomic_store_explicit(&load->progress.cancelled, true, memory_order_relaxed);
+    }
+}
+
+/**
+ * Transfers ownership of a finished load's controller to the caller.
+ */
+Controller *controller_load_take(ControllerLoad *load){
+    if (load == NULL) {
+        return NULL;
+    }
+    pthread_mutex_lock(&load->lock);
+    Controller *ctrl = load->ctrl;
+    load->ctrl = NULL;
+    pthread_mutex_unlock(&load->lock);
+    return ctrl;
+}
+
+/**
+ * Cancels and joins the load, then frees it and any controller not taken.
+ */
+void controller_load_free(ControllerLoad *load){
+    if (load == NULL) {
+        return;
+    }
+    controller_load_cancel(load);
+    pthread_join(load->thread, NULL);
+    controller_free_impl(load->ctrl);
+    pthread_cond_destroy(&load->finished);
+    pthread_mutex_destroy(&load->lock);
+    free(load->config_file);
+    free(load);
 }
 
 // -------------------------
 // Player and Room Access
 // -------------------------
 
+static ControllerStatusCode get_current_room_impl(const Controller *ctrl, const Room **room){
+    if (ctrl == NULL || room == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    Player p;
+    read_player(ctrl, &p);
+    if (p.current_room == NULL) {
+        return CONTROLLER_NOT_FOUND;
+    }
+    *room = p.current_room;
+    return CONTROLLER_OK;
+}
+
 /**
  * Retrieves a pointer to the room the player is currently in.
  *
@@ -33,14 +844,45 @@ void controller_free(Controller *ctrl){
  * Do not modify or free it.
  */
 ControllerStatusCode get_current_room(const Controller *ctrl, const Room **room){
-    return CONTROLLER_SUCCESS;
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = get_current_room_impl(ctrl, room);
+    STATS_CALL_END(STAT_GET_CURRENT_ROOM, status);
+    return status;
+}
+
+static ControllerStatusCode get_player_room_id_impl(const Controller *ctrl, int *room_id_out){
+    if (ctrl == NULL || room_id_out == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    Player p;
+    read_player(ctrl, &p);
+    if (p.current_room == NULL) {
+        return CONTROLLER_NOT_FOUND;
+    }
+    *room_id_out = p.current_room->id;
+    return CONTROLLER_OK;
 }
 
 /**
  * Retrieves the ID of the room the player is currently in.
  */
 ControllerStatusCode get_player_room_id(const Controller *ctrl, int *room_id_out){
-    return CONTROLLER_SUCCESS;
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = get_player_room_id_impl(ctrl, room_id_out);
+    STATS_CALL_END(STAT_GET_PLAYER_ROOM_ID, status);
+    return status;
+}
+
+static ControllerStatusCode get_room_by_id_impl(const Controller *ctrl, int id, const Room **room){
+    if (ctrl == NULL || room == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    const Room *found = lookup_room(ctrl, id);
+    if (found == NULL) {
+        return CONTROLLER_NOT_FOUND;
+    }
+    *room = found;
+    return CONTROLLER_OK;
 }
 
 /**
@@ -50,110 +892,1233 @@ ControllerStatusCode get_player_room_id(const Controller *ctrl, int *room_id_out
  * Do not modify or free it.
  */
 ControllerStatusCode get_room_by_id(const Controller *ctrl, int id, const Room **room){
-    return CONTROLLER_SUCCESS;
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = get_room_by_id_impl(ctrl, id, room);
+    STATS_CALL_END(STAT_GET_ROOM_BY_ID, status);
+    return status;
+}
+
+static ControllerStatusCode get_player_position_impl(const Controller *ctrl, int *x, int *y){
+    if (ctrl == NULL || x == NULL || y == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    Player p;
+    read_player(ctrl, &p);
+    *x = p.tile_x;
+    *y = p.tile_y;
+    return CONTROLLER_OK;
 }
 
 /**
  * Gets the player’s current position within their current room.
- * 
+ *
  * Output values `x` and `y` are tile coordinates in the room grid.
  */
 ControllerStatusCode get_player_position(const Controller *ctrl, int *x, int *y){
-    return CONTROLLER_SUCCESS;
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = get_player_position_impl(ctrl, x, y);
+    STATS_CALL_END(STAT_GET_PLAYER_POSITION, status);
+    return status;
 }
 
 
+static ControllerStatusCode get_player_health_impl(const Controller *ctrl, int *hp){
+    if (ctrl == NULL || hp == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    Player p;
+    read_player(ctrl, &p);
+    *hp = p.health;
+    return CONTROLLER_OK;
+}
+
 /**
  * Retrieves the player's current health value.
  */
 ControllerStatusCode get_player_health(const Controller *ctrl, int *hp){
-    return CONTROLLER_SUCCESS;
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = get_player_health_impl(ctrl, hp);
+    STATS_CALL_END(STAT_GET_PLAYER_HEALTH, status);
+    return status;
+}
+
+static ControllerStatusCode is_player_alive_impl(const Controller *ctrl, bool *alive){
+    if (ctrl == NULL || alive == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    Player p;
+    read_player(ctrl, &p);
+    *alive = p.alive;
+    return CONTROLLER_OK;
 }
 
 /**
  * Returns whether the player is still alive.
- * 
+ *
  * The output is 1 if alive, 0 if dead.
  */
 ControllerStatusCode is_player_alive(const Controller *ctrl, bool *alive){
-    return CONTROLLER_SUCCESS;
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = is_player_alive_impl(ctrl, alive);
+    STATS_CALL_END(STAT_IS_PLAYER_ALIVE, status);
+    return status;
 }
 
 // -------------------------
 // Movement
 // -------------------------
 
+static ControllerStatusCode move_player_within_room_impl(Controller *ctrl, int dx, int dy){
+    if (ctrl == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    if (ctrl->player.current_room == NULL) {
+        return move_blocked(ctrl, CONTROLLER_INVALID_ARGUMENT, dx, dy, -1);
+    }
+    if (!ctrl->player.alive) {
+        return move_blocked(ctrl, CONTROLLER_ERROR, dx, dy, -1);
+    }
+
+    const Room *room = ctrl->player.current_room;
+    int nx = ctrl->player.tile_x + dx;
+    int ny = ctrl->player.tile_y + dy;
+    if (!is_in_bounds(room, nx, ny)) {
+        return move_blocked(ctrl, CONTROLLER_OUT_OF_BOUNDS, dx, dy, -1);
+    }
+    bool walkable = false;
+    is_walkable_impl(room, nx, ny, &walkable);
+    if (!walkable) {
+        return move_blocked(ctrl, CONTROLLER_ERROR, dx, dy, -1);
+    }
+
+    int from_x = ctrl->player.tile_x;
+    int from_y = ctrl->player.tile_y;
+    seq_write_begin(ctrl);
+    ctrl->player.tile_x = nx;
+    ctrl->player.tile_y = ny;
+    touch_room(ctrl, room->id);
+    seq_write_end(ctrl);
+
+    if (ctrl->journal != NULL) {
+        JournalRecord rec = { .type = JOURNAL_RECORD_MOVE_WITHIN_ROOM, .dx = dx, .dy = dy };
+        journal_record(ctrl, &rec);
+    }
+    if (ctrl->events != NULL) {
+        ControllerEvent ev;
+        event_init(&ev, EVENT_TILE_MOVED);
+        ev.from_room_id = room->id;
+        ev.from_x = from_x;
+        ev.from_y = from_y;
+        emit(ctrl, &ev);
+    }
+    return CONTROLLER_OK;
+}
+
 /**
  * Attempts to move the player by (dx, dy) tiles within the current room.
- * 
+ *
  * Fails with CONTROLLER_OUT_OF_BOUNDS if the destination is outside
  * the room grid, or CONTROLLER_INVALID_ARGUMENT for null input.
  */
 ControllerStatusCode move_player_within_room(Controller *ctrl, int dx, int dy){
-    return CONTROLLER_SUCCESS;
+    STATS_CALL_BEGIN();
+    TRACE_BEGIN(span);
+    ControllerStatusCode status = move_player_within_room_impl(ctrl, dx, dy);
+    TRACE_END(span, "move", "move_player_within_room");
+    STATS_CALL_END(STAT_MOVE_WITHIN_ROOM, status);
+    return status;
+}
+
+static ControllerStatusCode move_player_direction_impl(Controller *ctrl, Direction dir){
+    if (ctrl == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    if (ctrl->player.current_room == NULL || dir < DIR_NORTH || dir >= NUM_DIRECTIONS) {
+        return move_blocked(ctrl, CONTROLLER_INVALID_ARGUMENT, 0, 0, (int)dir);
+    }
+    if (!ctrl->player.alive) {
+        return move_blocked(ctrl, CONTROLLER_ERROR, 0, 0, (int)dir);
+    }
+
+    const Room *room = ctrl->player.current_room;
+    if (find_door(room, dir) == NULL) {
+        return move_blocked(ctrl, CONTROLLER_NO_DOOR, 0, 0, (int)dir);
+    }
+    int next_id = room->neighbor_ids[dir];
+    if (next_id < 0) {
+        return move_blocked(ctrl, CONTROLLER_NOT_FOUND, 0, 0, (int)dir);
+    }
+    const Room *next = lookup_room(ctrl, next_id);
+    if (next == NULL) {
+        return move_blocked(ctrl, CONTROLLER_NOT_FOUND, 0, 0, (int)dir);
+    }
+
+    seq_write_begin(ctrl);
+    // Catch the room up first so the arrival tile is checked against where its monsters are now.
+    simulation_catch_up(ctrl->sim, next->id, NULL);
+
+    // Arrive on the matching door of the next room, or anywhere walkable if it has none.
+    int nx, ny;
+    const Door *entry = find_door(next, opposite_direction(dir));
+    if (entry != NULL && is_in_bounds(next, entry->x, entry->y)) {
+        nx = entry->x;
+        ny = entry->y;
+    } else if (!find_spawn_tile(next, &nx, &ny)) {
+        seq_write_end(ctrl);
+        return move_blocked(ctrl, CONTROLLER_ERROR, 0, 0, (int)dir);
+    }
+
+    int from_x = ctrl->player.tile_x;
+    int from_y = ctrl->player.tile_y;
+    ctrl->player.current_room = (Room *)next;
+    ctrl->player.tile_x = nx;
+    ctrl->player.tile_y = ny;
+    touch_room(ctrl, room->id);
+    touch_room(ctrl, next->id);
+    seq_write_end(ctrl);
+    bool first_visit = mark_visited(ctrl, next->id);
+
+    if (ctrl->journal != NULL) {
+        JournalRecord rec = { .type = JOURNAL_RECORD_MOVE_DIRECTION, .dir = dir };
+        journal_record(ctrl, &rec);
+    }
+    if (ctrl->events != NULL) {
+        ControllerEvent ev;
+        event_init(&ev, EVENT_ROOM_ENTERED);
+        ev.from_room_id = room->id;
+        ev.from_x = from_x;
+        ev.from_y = from_y;
+        emit(ctrl, &ev);
+        if (first_visit) {
+            event_init(&ev, EVENT_FIRST_VISIT);
+            emit(ctrl, &ev);
+        }
+    }
+    return CONTROLLER_OK;
 }
 
 /**
  * Attempts to move the player through a door in the given direction.
- * 
+ *
  * Fails with CONTROLLER_NO_DOOR if no door exists on that wall,
  * or CONTROLLER_NOT_FOUND if the neighboring room is invalid.
  */
 ControllerStatusCode move_player_direction(Controller *ctrl, Direction dir){
-    return CONTROLLER_SUCCESS;
+    STATS_CALL_BEGIN();
+    TRACE_BEGIN(span);
+    ControllerStatusCode status = move_player_direction_impl(ctrl, dir);
+    TRACE_END(span, "move", "move_player_direction");
+    STATS_CALL_END(STAT_MOVE_DIRECTION, status);
+    return status;
+}
+
+// -------------------------
+// Simulation
+// -------------------------
+
+static ControllerStatusCode controller_tick_impl(Controller *ctrl){
+    if (ctrl == NULL || ctrl->sim == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    seq_write_begin(ctrl);
+    simulation_step(ctrl->sim, &ctrl->player);
+    const int *stepped;
+    size_t count = simulation_active_rooms(ctrl->sim, &stepped);
+    for (size_t i = 0; i < count; i++) {
+        touch_room(ctrl, stepped[i]);
+    }
+    seq_write_end(ctrl);
+
+    if (ctrl->journal != NULL) {
+        JournalRecord rec = { .type = JOURNAL_RECORD_TICK, .count = 1 };
+        journal_record(ctrl, &rec);
+    }
+    return CONTROLLER_OK;
+}
+
+/**
+ * Advances the monster simulation by one tick.
+ *
+ * Only rooms within the active radius of the player's room are stepped;
+ * the rest are caught up when the player enters them.
+ */
+ControllerStatusCode controller_tick(Controller *ctrl){
+    STATS_CALL_BEGIN();
+    TRACE_BEGIN(span);
+    ControllerStatusCode status = controller_tick_impl(ctrl);
+    TRACE_END(span, "simulation", "controller_tick");
+    STATS_CALL_END(STAT_CONTROLLER_TICK, status);
+    return status;
+}
+
+static ControllerStatusCode controller_set_active_radius_impl(Controller *ctrl, int hops){
+    if (ctrl == NULL || ctrl->sim == NULL || hops < 0) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    simulation_set_radius(ctrl->sim, hops);
+    return CONTROLLER_OK;
+}
+
+/**
+ * Sets how many hops around the player's room are simulated every tick.
+ */
+ControllerStatusCode controller_set_active_radius(Controller *ctrl, int hops){
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = controller_set_active_radius_impl(ctrl, hops);
+    STATS_CALL_END(STAT_SET_ACTIVE_RADIUS, status);
+    return status;
+}
+
+// -------------------------
+// Events
+// -------------------------
+
+static ControllerStatusCode controller_attach_events_impl(Controller *ctrl, EventStream *stream){
+    if (ctrl == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    ctrl->events = stream;
+    return CONTROLLER_OK;
+}
+
+/**
+ * Starts (or, with NULL, stops) publishing state changes to `stream`.
+ *
+ * The controller does not take ownership of the stream. Writer thread only.
+ */
+ControllerStatusCode controller_attach_events(Controller *ctrl, EventStream *stream){
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = controller_attach_events_impl(ctrl, stream);
+    STATS_CALL_END(STAT_ATTACH_EVENTS, status);
+    return status;
+}
+
+// -------------------------
+// Persistence
+// -------------------------
+
+static ControllerStatusCode controller_attach_journal_impl(Controller *ctrl, Journal *journal){
+    // Recovery regenerates the dungeon natively, which would not rebuild a libworldgen one.
+    if (ctrl == NULL || (journal != NULL && !ctrl->generated)) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    ctrl->journal = journal;
+    if (journal == NULL) {
+        return CONTROLLER_OK;
+    }
+    ControllerStatusCode status = write_checkpoint(ctrl);
+    if (status != CONTROLLER_OK) {
+        ctrl->journal = NULL;
+    }
+    return status;
+}
+
+/**
+ * Starts (or, with NULL, stops) journaling state changes to `journal`.
+ *
+ * Attaching writes a checkpoint of the current state. The controller does
+ * not take ownership of the journal. Writer thread only.
+ */
+ControllerStatusCode controller_attach_journal(Controller *ctrl, Journal *journal){
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = controller_attach_journal_impl(ctrl, journal);
+    STATS_CALL_END(STAT_ATTACH_JOURNAL, status);
+    return status;
+}
+
+// Puts a freshly built controller into the state a checkpoint describes.
+static bool restore_checkpoint(Controller *ctrl, const JournalCheckpoint *cp){
+    Room *room = (Room *)lookup_room(ctrl, cp->room_id);
+    if (room == NULL || !is_in_bounds(room, cp->tile_x, cp->tile_y)) {
+        return false;
+    }
+    if (simulation_load_state(ctrl->sim, cp->sim_state, cp->sim_state_size) != 0) {
+        return false;
+    }
+    clear_visited(ctrl);
+    for (size_t i = 0; i < cp->visited_count; i++) {
+        mark_visited(ctrl, cp->visited_ids[i]);
+    }
+    ctrl->player.current_room = room;
+    ctrl->player.tile_x = cp->tile_x;
+    ctrl->player.tile_y = cp->tile_y;
+    ctrl->player.health = cp->health;
+    ctrl->player.alive = cp->alive;
+    for (int i = 0; i <= ctrl->max_room_id; i++) {
+        touch_room(ctrl, i);
+    }
+    return true;
+}
+
+// Re-applies one journaled operation; any failure means the log does not match this dungeon.
+static int replay_record(const JournalRecord *record, void *user_data){
+    Controller *ctrl = user_data;
+    switch (record->type) {
+        case JOURNAL_RECORD_MOVE_WITHIN_ROOM:
+            return move_player_within_room_impl(ctrl, record->dx, record->dy) != CONTROLLER_OK;
+        case JOURNAL_RECORD_MOVE_DIRECTION:
+            return move_player_direction_impl(ctrl, record->dir) != CONTROLLER_OK;
+        case JOURNAL_RECORD_TICK:
+            for (int i = 0; i < record->count; i++) {
+                controller_tick_impl(ctrl);
+            }
+            return 0;
+    }
+    return 1;
+}
+
+static Controller *controller_recover_impl(const DungeonConfig *config, Journal *journal){
+    if (config == NULL || journal == NULL) {
+        return NULL;
+    }
+    ControllerStatusCode status;
+    Controller *ctrl = controller_init_with_config_impl(config, NULL, 0, &status);
+    if (ctrl == NULL) {
+        return NULL;
+    }
+
+    JournalCheckpoint cp;
+    bool found = false;
+    bool ok = journal_read_checkpoint(journal, &cp, &found) == JOURNAL_OK;
+    if (ok && found) {
+        ok = restore_checkpoint(ctrl, &cp);
+    }
+    if (ok) {
+        ok = journal_replay(journal, found ? &cp : NULL, replay_record, ctrl) == JOURNAL_OK;
+    }
+    journal_checkpoint_free(&cp);
+    if (ok) {
+        ok = controller_attach_journal_impl(ctrl, journal) == CONTROLLER_OK;
+    }
+    if (!ok) {
+        controller_free_impl(ctrl);
+        return NULL;
+    }
+    return ctrl;
+}
+
+/**
+ * Rebuilds a controller from its journal after a crash.
+ *
+ * Loads the journal's checkpoint into a freshly generated dungeon, replays
+ * the records logged after it, and attaches the journal to the result.
+ *
+ * @param config The config the journaled session was created with
+ * @param journal Journal opened with journal_open for the same config
+ * @return Pointer to the recovered controller, or NULL on failure
+ */
+Controller *controller_recover(const DungeonConfig *config, Journal *journal){
+    STATS_CALL_BEGIN();
+    Controller *ctrl = controller_recover_impl(config, journal);
+    STATS_CALL_END(STAT_CONTROLLER_INIT, ctrl ? CONTROLLER_OK : CONTROLLER_ERROR);
+    return ctrl;
 }
 
 // -------------------------
 // Rendering
 // -------------------------
 
+static ControllerStatusCode render_current_room_impl(const Controller *ctrl, char **str){
+    if (ctrl == NULL || str == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+
+    char *buf = NULL;
+    size_t cap = 0;
+    unsigned start;
+    do {
+        start = seq_read_begin(ctrl);
+        Player p = ctrl->player;
+        const Room *room = p.current_room;
+        if (room == NULL) {
+            if (seq_read_retry(ctrl, start)) continue;
+            free(buf);
+            return CONTROLLER_NOT_FOUND;
+        }
+        size_t need = render_size(room);
+        if (need > cap) {
+            char *grown = realloc(buf, need);
+            if (grown == NULL) {
+                free(buf);
+                return CONTROLLER_ALLOCATION_FAILED;
+            }
+            buf = grown;
+            cap = need;
+            STATS_ALLOC(STAT_ALLOC_RENDER_BUFFER, need);
+        }
+        render_into(ctrl, room, &p, buf);
+    } while (seq_read_retry(ctrl, start));
+
+    *str = buf;
+    return CONTROLLER_OK;
+}
+
 /**
  * Renders the room the player is currently in.
- * 
+ *
  * The function allocates a printable string describing the room’s contents.
  * The caller must free the string using `free()` when done.
  */
 ControllerStatusCode render_current_room(const Controller *ctrl, char **str){
-    return CONTROLLER_SUCCESS;
+    STATS_CALL_BEGIN();
+    TRACE_BEGIN(span);
+    ControllerStatusCode status = render_current_room_impl(ctrl, str);
+    TRACE_END(span, "render", "render_current_room");
+    STATS_CALL_END(STAT_RENDER_CURRENT_ROOM, status);
+    return status;
+}
+
+static ControllerStatusCode render_room_by_id_impl(const Controller *ctrl, const int room_id, char **str){
+    if (ctrl == NULL || str == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    const Room *room = lookup_room(ctrl, room_id);
+    if (room == NULL) {
+        return CONTROLLER_NOT_FOUND;
+    }
+
+    char *buf = malloc(render_size(room));
+    if (buf == NULL) {
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    STATS_ALLOC(STAT_ALLOC_RENDER_BUFFER, render_size(room));
+    render_one(ctrl, room, buf);
+
+    *str = buf;
+    return CONTROLLER_OK;
 }
 
 /**
  * Renders a specific room by ID.
- * 
+ *
  * The function allocates a printable string describing the room’s contents.
  * The caller must free the string using `free()` when done.
  */
 ControllerStatusCode render_room_by_id(const Controller *ctrl, const int room_id, char **str){
-    return CONTROLLER_SUCCESS;
+    STATS_CALL_BEGIN();
+    TRACE_BEGIN(span);
+    ControllerStatusCode status = render_room_by_id_impl(ctrl, room_id, str);
+    TRACE_END(span, "render", "render_room_by_id");
+    STATS_CALL_END(STAT_RENDER_ROOM_BY_ID, status);
+    return status;
+}
+
+// -------------------------
+// Encoded rendering
+// -------------------------
+
+static ControllerStatusCode render_room_encoded_impl(const Controller *ctrl, int room_id,
+                                                     RenderEncoder *enc, const uint8_t **data,
+                                                     size_t *size){
+    if (ctrl == NULL || enc == NULL || data == NULL || size == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    const Room *room = lookup_room(ctrl, room_id);
+    if (room == NULL) {
+        return CONTROLLER_NOT_FOUND;
+    }
+
+    // A torn snapshot is simply encoded again; nothing is committed until it is consistent.
+    unsigned start;
+    RenderCodecStatusCode status;
+    do {
+        start = seq_read_begin(ctrl);
+        Player p = ctrl->player;
+        status = render_encode_room(enc, room, &p);
+    } while (status == RENDER_CODEC_OK && seq_read_retry(ctrl, start));
+
+    if (status == RENDER_CODEC_ALLOCATION_FAILED) {
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    if (status != RENDER_CODEC_OK) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    render_encoder_commit(enc, data, size);
+    return CONTROLLER_OK;
+}
+
+/**
+ * Renders a room as a compact encoded frame for `enc`'s client.
+ */
+ControllerStatusCode render_room_encoded(const Controller *ctrl, int room_id, RenderEncoder *enc,
+                                         const uint8_t **data, size_t *size){
+    STATS_CALL_BEGIN();
+    TRACE_BEGIN(span);
+    ControllerStatusCode status = render_room_encoded_impl(ctrl, room_id, enc, data, size);
+    TRACE_END(span, "render", "render_room_encoded");
+    STATS_CALL_END(STAT_RENDER_ROOM_ENCODED, status);
+    return status;
+}
+
+// -------------------------
+// Background templates
+// -------------------------
+
+static ControllerStatusCode controller_set_template_cache_limit_impl(Controller *ctrl, size_t max_bytes){
+    if (ctrl == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    template_cache_set_limit(ctrl->templates, max_bytes);
+    return CONTROLLER_OK;
+}
+
+/**
+ * Bounds the memory used by cached room backgrounds; 0 turns the cache off.
+ */
+ControllerStatusCode controller_set_template_cache_limit(Controller *ctrl, size_t max_bytes){
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = controller_set_template_cache_limit_impl(ctrl, max_bytes);
+    STATS_CALL_END(STAT_SET_TEMPLATE_CACHE_LIMIT, status);
+    return status;
+}
+
+static ControllerStatusCode controller_template_cache_stats_impl(const Controller *ctrl,
+                                                                 TemplateCacheStats *out){
+    if (ctrl == NULL || out == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    template_cache_stats(ctrl->templates, out);
+    return CONTROLLER_OK;
+}
+
+/**
+ * Reads the hit, miss and eviction counters of the background cache.
+ */
+ControllerStatusCode controller_template_cache_stats(const Controller *ctrl, TemplateCacheStats *out){
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = controller_template_cache_stats_impl(ctrl, out);
+    STATS_CALL_END(STAT_TEMPLATE_CACHE_STATS, status);
+    return status;
+}
+
+// -------------------------
+// Batch rendering
+// -------------------------
+
+// Process-wide pool shared by every batch render, started on first use.
+static ThreadPool *render_pool;
+static pthread_once_t render_pool_once = PTHREAD_ONCE_INIT;
+
+static void render_pool_shutdown(void){
+    thread_pool_destroy(render_pool);
+    render_pool = NULL;
+}
+
+static void render_pool_start(void){
+    render_pool = thread_pool_create(0);
+    if (render_pool != NULL) {
+        atexit(render_pool_shutdown);
+    }
+}
+
+// One batch, split into chunks of consecutive rooms. Workers and the caller
+// claim chunks from `next_chunk` until none are left; the last party to
+// drop its reference frees the job, so helpers that start late are harmless.
+typedef struct {
+    const Controller *ctrl;
+    const Room **rooms;
+    const size_t *offsets;
+    char *data;
+    const size_t *chunk_start;  // chunk c covers rooms [chunk_start[c], chunk_start[c + 1])
+    size_t num_chunks;
+    atomic_size_t next_chunk;
+    size_t done_chunks;         // guarded by `lock`
+    atomic_int refs;
+    pthread_mutex_t lock;
+    pthread_cond_t all_done;
+} BatchJob;
+
+static void batch_job_release(BatchJob *job){
+    if (atomic_fetch_sub_explicit(&job->refs, 1, memory_order_acq_rel) == 1) {
+        pthread_mutex_destroy(&job->lock);
+        pthread_cond_destroy(&job->all_done);
+        free(job);
+    }
+}
+
+static void batch_work(BatchJob *job){
+    for (;;) {
+        size_t c = atomic_fetch_add_explicit(&job->next_chunk, 1, memory_order_relaxed);
+        if (c >= job->num_chunks) {
+            break;
+        }
+        for (size_t i = job->chunk_start[c]; i < job->chunk_start[c + 1]; i++) {
+            render_one(job->ctrl, job->rooms[i], job->data + job->offsets[i]);
+        }
+        pthread_mutex_lock(&job->lock);
+        if (++job->done_chunks == job->num_chunks) {
+            pthread_cond_signal(&job->all_done);
+        }
+        pthread_mutex_unlock(&job->lock);
+    }
+}
+
+static void batch_task(void *arg){
+    BatchJob *job = arg;
+    batch_work(job);
+    batch_job_release(job);
+}
+
+// Renders rooms[0..n) in parallel; falls back to the caller alone if the pool is unavailable.
+static ControllerStatusCode render_parallel(const Controller *ctrl, const Room **rooms,
+                                            const size_t *offsets, size_t n, char *data){
+    pthread_once(&render_pool_once, render_pool_start);
+    size_t total = offsets[n];
+    size_t max_chunks = total / BATCH_CHUNK_BYTES + 1;
+    size_t *chunk_start = malloc((max_chunks + 1) * sizeof(size_t));
+    BatchJob *job = calloc(1, sizeof(BatchJob));
+    if (chunk_start == NULL || job == NULL) {
+        free(chunk_start);
+        free(job);
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    if (pthread_mutex_init(&job->lock, NULL) != 0) {
+        free(chunk_start);
+        free(job);
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    if (pthread_cond_init(&job->all_done, NULL) != 0) {
+        pthread_mutex_destroy(&job->lock);
+        free(chunk_start);
+        free(job);
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+
+    // Cut chunks at room boundaries once they reach the target size.
+    size_t chunks = 0;
+    chunk_start[0] = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (offsets[i + 1] - offsets[chunk_start[chunks]] >= BATCH_CHUNK_BYTES || i + 1 == n) {
+            chunk_start[++chunks] = i + 1;
+        }
+    }
+
+    job->ctrl = ctrl;
+    job->rooms = rooms;
+    job->offsets = offsets;
+    job->data = data;
+    job->chunk_start = chunk_start;
+    job->num_chunks = chunks;
+    atomic_init(&job->next_chunk, 0);
+    atomic_init(&job->refs, 1);
+
+    int helpers = render_pool != NULL ? thread_pool_size(render_pool) : 0;
+    if ((size_t)helpers > chunks - 1) {
+        helpers = (int)(chunks - 1);
+    }
+    for (int h = 0; h < helpers; h++) {
+        atomic_fetch_add_explicit(&job->refs, 1, memory_order_relaxed);
+        if (thread_pool_submit(render_pool, batch_task, job) != POOL_OK) {
+            atomic_fetch_sub_explicit(&job->refs, 1, memory_order_relaxed);
+            break;
+        }
+    }
+
+    batch_work(job);
+    pthread_mutex_lock(&job->lock);
+    while (job->done_chunks < job->num_chunks) {
+        pthread_cond_wait(&job->all_done, &job->lock);
+    }
+    pthread_mutex_unlock(&job->lock);
+    batch_job_release(job);
+    free(chunk_start);
+    return CONTROLLER_OK;
+}
+
+static ControllerStatusCode render_rooms_batch_impl(const Controller *ctrl, const int *ids, size_t n,
+                                                    RenderBatch *out){
+    if (ctrl == NULL || out == NULL || (ids == NULL && n > 0)) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    memset(out, 0, sizeof(*out));
+    const Room **rooms = malloc((n > 0 ? n : 1) * sizeof(Room *));
+    size_t *offsets = malloc((n + 1) * sizeof(size_t));
+    if (rooms == NULL || offsets == NULL) {
+        free(rooms);
+        free(offsets);
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+
+    // Exact sizes are known from the room dimensions, so a prefix sum places every render.
+    offsets[0] = 0;
+    for (size_t i = 0; i < n; i++) {
+        rooms[i] = lookup_room(ctrl, ids[i]);
+        if (rooms[i] == NULL) {
+            free(rooms);
+            free(offsets);
+            return CONTROLLER_NOT_FOUND;
+        }
+        offsets[i + 1] = offsets[i] + render_size(rooms[i]);
+    }
+    size_t total = offsets[n];
+    char *data = malloc(total > 0 ? total : 1);
+    if (data == NULL) {
+        free(rooms);
+        free(offsets);
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    STATS_ALLOC(STAT_ALLOC_RENDER_BUFFER, total);
+
+    ControllerStatusCode status = CONTROLLER_OK;
+    if (total < BATCH_SERIAL_BYTES) {
+        for (size_t i = 0; i < n; i++) {
+            render_one(ctrl, rooms[i], data + offsets[i]);
+        }
+    } else {
+        status = render_parallel(ctrl, rooms, offsets, n, data);
+    }
+    free(rooms);
+    if (status != CONTROLLER_OK) {
+        free(offsets);
+        free(data);
+        return status;
+    }
+    out->data = data;
+    out->offsets = offsets;
+    out->count = n;
+    out->size = total;
+    return CONTROLLER_OK;
+}
+
+/**
+ * Renders many rooms at once into a single contiguous buffer.
+ *
+ * `data + offsets[i]` matches render_room_by_id(ctrl, ids[i]) byte for byte.
+ * Free the result with render_batch_free.
+ */
+ControllerStatusCode render_rooms_batch(const Controller *ctrl, const int *ids, size_t n,
+                                        RenderBatch *out){
+    STATS_CALL_BEGIN();
+    TRACE_BEGIN(span);
+    ControllerStatusCode status = render_rooms_batch_impl(ctrl, ids, n, out);
+    TRACE_END(span, "render", "render_rooms_batch");
+    STATS_CALL_END(STAT_RENDER_ROOMS_BATCH, status);
+    return status;
+}
+
+void render_batch_free(RenderBatch *batch){
+    if (batch == NULL) {
+        return;
+    }
+    free(batch->data);
+    free(batch->offsets);
+    memset(batch, 0, sizeof(*batch));
+}
+
+// -------------------------
+// Composite map
+// -------------------------
+
+struct MapCanvas {
+    const Controller *ctrl;
+    bool fog_of_war;
+    int width, height;          // map size in tiles
+    int cell_w, cell_h;         // grid cell size in tiles
+    int columns, rows;          // grid size in cells
+    char *buf;                  // (width + 1) * height + 1 bytes
+    const Room **rooms;         // by room ID, NULL for gaps; the tree never changes after load
+    int *cells;                 // by room ID; grid cell the room is drawn in, -1 for none
+    size_t num_ids;
+    unsigned *drawn;            // by room ID; room version last drawn, 0 = never
+};
+
+// Cell offsets of the neighbor in each direction, indexed by Direction.
+static const int map_dx[NUM_DIRECTIONS] = { 0, 0, 1, -1 };
+static const int map_dy[NUM_DIRECTIONS] = { -1, 1, 0, 0 };
+
+// Puts each room in the config's grid cell `grid_placement`. Fails, leaving the canvas
+// to layout_from_neighbors, unless every room has its own cell inside the grid;
+// libworldgen leaves grid_placement at -1.
+static bool layout_from_grid(MapCanvas *c, const WorldGenConfig *cfg){
+    c->cell_w = cfg->base_room_width + cfg->room_size_variance + 1;
+    c->cell_h = cfg->base_room_height + cfg->room_size_variance + 1;
+    c->columns = worldgen_grid_columns(cfg);
+    c->rows = worldgen_grid_rows(cfg);
+    if (c->columns <= 0 || c->rows <= 0) {
+        return false;
+    }
+    size_t num_cells = (size_t)c->columns * (size_t)c->rows;
+    unsigned char *taken = calloc(num_cells, 1);
+    if (taken == NULL) {
+        return false;
+    }
+    bool ok = true;
+    for (size_t id = 0; id < c->num_ids && ok; id++) {
+        c->cells[id] = -1;
+        if (c->rooms[id] == NULL) {
+            continue;
+        }
+        int g = c->rooms[id]->grid_placement;
+        ok = g >= 0 && (size_t)g < num_cells && !taken[g];
+        if (ok) {
+            taken[g] = 1;
+            c->cells[id] = g;
+        }
+    }
+    free(taken);
+    c->width = cfg->map_width;
+    c->height = cfg->map_height;
+    return ok;
+}
+
+// Lays the rooms out by walking neighbor_ids breadth-first from the start room, each
+// room one cell away from the room it was reached through, in the direction of the
+// link. Rooms whose cell is already taken, or that the walk never reaches, fill rows
+// below the rest in ID order. The map is sized to fit.
+static bool layout_from_neighbors(MapCanvas *c){
+    size_t n = 0;
+    int start = -1, max_w = 0, max_h = 0;
+    for (size_t id = 0; id < c->num_ids; id++) {
+        const Room *r = c->rooms[id];
+        c->cells[id] = -1;
+        if (r == NULL) {
+            continue;
+        }
+        n++;
+        if (start < 0 || (r->is_start && !c->rooms[start]->is_start)) {
+            start = (int)id;
+        }
+        max_w = r->width > max_w ? r->width : max_w;
+        max_h = r->height > max_h ? r->height : max_h;
+    }
+    c->cell_w = max_w + 1;
+    c->cell_h = max_h + 1;
+    c->columns = c->rows = 0;
+    if (n == 0) {
+        c->width = c->height = 0;
+        return true;
+    }
+
+    // Walk on a square twice as wide as the densest packing, so the layout stays
+    // near n cells however stretched the neighbor graph is.
+    int side = 1;
+    while ((size_t)side * (size_t)side < n) {
+        side++;
+    }
+    side = side * 2 + 1;
+    int *at = malloc((size_t)side * (size_t)side * sizeof(int));   // cell -> room ID
+    int *queue = malloc(n * sizeof(int));
+    if (at == NULL || queue == NULL) {
+        free(at);
+        free(queue);
+        return false;
+    }
+    for (size_t i = 0; i < (size_t)side * (size_t)side; i++) {
+        at[i] = -1;
+    }
+    int center = (side / 2) * side + side / 2;
+    at[center] = start;
+    c->cells[start] = center;
+    queue[0] = start;
+    size_t head = 0, tail = 1;
+    int min_x = side / 2, max_x = side / 2, min_y = side / 2, max_y = side / 2;
+    while (head < tail) {
+        const Room *r = c->rooms[queue[head++]];
+        int x = c->cells[r->id] % side, y = c->cells[r->id] / side;
+        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+            int nb = r->neighbor_ids[d];
+            int nx = x + map_dx[d], ny = y + map_dy[d];
+            if (nb < 0 || (size_t)nb >= c->num_ids || c->rooms[nb] == NULL || c->cells[nb] >= 0 ||
+                nx < 0 || nx >= side || ny < 0 || ny >= side || at[ny * side + nx] >= 0) {
+                continue;
+            }
+            at[ny * side + nx] = nb;
+            c->cells[nb] = ny * side + nx;
+            queue[tail++] = nb;
+            min_x = nx < min_x ? nx : min_x;
+            max_x = nx > max_x ? nx : max_x;
+            min_y = ny < min_y ? ny : min_y;
+            max_y = ny > max_y ? ny : max_y;
+        }
+    }
+    free(at);
+    free(queue);
+
+    c->columns = max_x - min_x + 1;
+    c->rows = max_y - min_y + 1;
+    int overflow = c->columns * c->rows;
+    for (size_t id = 0; id < c->num_ids; id++) {
+        if (c->rooms[id] == NULL) {
+            continue;
+        }
+        if (c->cells[id] >= 0) {
+            c->cells[id] = (c->cells[id] / side - min_y) * c->columns + (c->cells[id] % side - min_x);
+        } else {
+            c->cells[id] = overflow++;
+        }
+    }
+    c->rows = (overflow + c->columns - 1) / c->columns;
+    c->width = c->columns * c->cell_w;
+    c->height = c->rows * c->cell_h;
+    return true;
+}
+
+ControllerStatusCode map_canvas_create(const Controller *ctrl, bool fog_of_war, MapCanvas **canvas){
+    if (ctrl == NULL || canvas == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    MemoryAccount *previous = mem_account_enter(ctrl->memory);
+    MapCanvas *c = mem_calloc(MEM_RENDER, 1, sizeof(MapCanvas));
+    if (c == NULL) {
+        mem_account_enter(previous);
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    c->ctrl = ctrl;
+    c->fog_of_war = fog_of_war;
+    c->num_ids = (size_t)ctrl->max_room_id + 1;
+    c->drawn = mem_calloc(MEM_RENDER, c->num_ids, sizeof(unsigned));
+    c->rooms = mem_calloc(MEM_RENDER, c->num_ids, sizeof(Room *));
+    c->cells = mem_alloc(MEM_RENDER, c->num_ids * sizeof(int));
+    mem_account_enter(previous);
+    TreeIterator *iter = createIterator(ctrl->room_tree);
+    if (c->drawn == NULL || c->rooms == NULL || c->cells == NULL || iter == NULL) {
+        destroyIterator(iter);
+        map_canvas_free(c);
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    for (const Room *r = nextData(iter); r != NULL; r = nextData(iter)) {
+        c->rooms[r->id] = r;
+    }
+    destroyIterator(iter);
+    if (!layout_from_grid(c, &ctrl->config.world) && !layout_from_neighbors(c)) {
+        map_canvas_free(c);
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+
+    size_t stride = (size_t)c->width + 1;
+    previous = mem_account_enter(ctrl->memory);
+    c->buf = mem_alloc(MEM_RENDER, stride * (size_t)c->height + 1);
+    mem_account_enter(previous);
+    if (c->buf == NULL) {
+        map_canvas_free(c);
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    STATS_ALLOC(STAT_ALLOC_RENDER_BUFFER, stride * (size_t)c->height + 1);
+    for (int y = 0; y < c->height; y++) {
+        memset(c->buf + (size_t)y * stride, ' ', (size_t)c->width);
+        c->buf[(size_t)y * stride + c->width] = '\n';
+    }
+    c->buf[stride * (size_t)c->height] = '\0';
+    *canvas = c;
+    return CONTROLLER_OK;
+}
+
+void map_canvas_free(MapCanvas *canvas){
+    if (canvas == NULL) {
+        return;
+    }
+    MemoryAccount *previous = mem_account_enter(canvas->ctrl->memory);
+    mem_free(MEM_RENDER, canvas->buf, ((size_t)canvas->width + 1) * (size_t)canvas->height + 1);
+    mem_free(MEM_RENDER, canvas->rooms, canvas->num_ids * sizeof(Room *));
+    mem_free(MEM_RENDER, canvas->cells, canvas->num_ids * sizeof(int));
+    mem_free(MEM_RENDER, canvas->drawn, canvas->num_ids * sizeof(unsigned));
+    mem_free(MEM_RENDER, canvas, sizeof(MapCanvas));
+    mem_account_enter(previous);
+}
+
+// Redraws room `id` into its cell if its version moved on; returns true if it was drawn.
+static bool composite_room(const Controller *ctrl, MapCanvas *c, int id){
+    // Check the version first: it is the only thing most unchanged rooms cost.
+    unsigned version = atomic_load_explicit(&ctrl->room_versions[id], memory_order_relaxed);
+    if (version == c->drawn[id]) {
+        return false;
+    }
+    // Visited flags only go from 0 to 1, and entering a room bumps its version, so a
+    // fogged room is simply skipped without recording a version.
+    if (c->fog_of_war && !room_visited(ctrl, id)) {
+        return false;
+    }
+    const Room *room = c->rooms[id];
+    int g = c->cells[id];
+    if (room == NULL || g < 0) {
+        c->drawn[id] = version;     // nothing to draw, now or later
+        return false;
+    }
+
+    size_t stride = (size_t)c->width + 1;
+    char *origin = c->buf + (size_t)(g / c->columns) * (size_t)c->cell_h * stride +
+                   (size_t)(g % c->columns) * (size_t)c->cell_w;
+    unsigned start;
+    do {
+        start = seq_read_begin(ctrl);
+        version = atomic_load_explicit(&ctrl->room_versions[id], memory_order_relaxed);
+        Player p = ctrl->player;
+        draw_room(room, &p, origin, stride, c->cell_w - 1, c->cell_h - 1);
+    } while (seq_read_retry(ctrl, start));
+    c->drawn[id] = version;
+    return true;
+}
+
+static ControllerStatusCode render_map_impl(const Controller *ctrl, MapCanvas *canvas,
+                                            const char **map, size_t *redrawn){
+    if (ctrl == NULL || canvas == NULL || map == NULL || canvas->ctrl != ctrl) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    size_t count = 0;
+    for (size_t id = 0; id < canvas->num_ids && canvas->columns > 0; id++) {
+        count += composite_room(ctrl, canvas, (int)id);
+    }
+    if (redrawn != NULL) {
+        *redrawn = count;
+    }
+    *map = canvas->buf;
+    return CONTROLLER_OK;
+}
+
+/**
+ * Brings the composite map up to date and returns it.
+ *
+ * Only rooms whose contents changed since the previous call are redrawn.
+ */
+ControllerStatusCode render_map(const Controller *ctrl, MapCanvas *canvas, const char **map,
+                                size_t *redrawn){
+    STATS_CALL_BEGIN();
+    TRACE_BEGIN(span);
+    ControllerStatusCode status = render_map_impl(ctrl, canvas, map, redrawn);
+    TRACE_END(span, "render", "render_map");
+    STATS_CALL_END(STAT_RENDER_MAP, status);
+    return status;
 }
 
 // -------------------------
 // Visited Rooms
 // -------------------------
 
+static ControllerStatusCode get_visited_room_ids_impl(const Controller *ctrl, int **ids, size_t *count){
+    if (ctrl == NULL || ids == NULL || count == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+
+    // Visited flags only ever go from 0 to 1, so a single pass is a valid snapshot.
+    int limit = ctrl->max_room_id + 1;
+    int *out = malloc((size_t)(limit > 0 ? limit : 1) * sizeof(int));
+    if (out == NULL) {
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    STATS_ALLOC(STAT_ALLOC_VISITED_ARRAY, (size_t)(limit > 0 ? limit : 1) * sizeof(int));
+    size_t n = 0;
+    for (int i = 0; i < limit; i++) {
+        if (atomic_load_explicit(&ctrl->visited[i], memory_order_acquire)) {
+            out[n++] = i;
+        }
+    }
+
+    *ids = out;
+    *count = n;
+    return CONTROLLER_OK;
+}
+
 /**
  * Returns a dynamically allocated array of visited room IDs.
- * 
+ *
  * The array contains all room IDs that have been marked as visited.
  * The caller must free the array after use.
  */
 ControllerStatusCode get_visited_room_ids(const Controller *ctrl, int **ids, size_t *count){
-    return CONTROLLER_SUCCESS;
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = get_visited_room_ids_impl(ctrl, ids, count);
+    STATS_CALL_END(STAT_GET_VISITED_ROOM_IDS, status);
+    return status;
 }
 
 // -------------------------
 // Tile Validity
 // -------------------------
 
+static ControllerStatusCode is_walkable_impl(const Room *room, int x, int y, bool *result){
+    if (room == NULL || result == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    *result = false;
+    if (!is_in_bounds(room, x, y)) {
+        return CONTROLLER_OK;
+    }
+
+    bool edge = (x == 0 || y == 0 || x == room->width - 1 || y == room->height - 1);
+    if (edge) {
+        bool door = false;
+        for (int i = 0; i < room->num_doors && !door; i++) {
+            door = (room->doors[i].x == x && room->doors[i].y == y);
+        }
+        if (!door) {
+            return CONTROLLER_OK;
+        }
+    }
+    for (int i = 0; i < room->num_monsters; i++) {
+        if (room->monsters[i].x == x && room->monsters[i].y == y) {
+            return CONTROLLER_OK;
+        }
+    }
+    for (int i = 0; i < room->num_items; i++) {
+        if (room->items[i].x == x && room->items[i].y == y) {
+            return CONTROLLER_OK;
+        }
+    }
+
+    *result = true;
+    return CONTROLLER_OK;
+}
+
 /**
  * Determines if a tile (x, y) is walkable in the given room.
- * 
+ *
  * A tile is walkable if it lies within bounds and does not contain
  * a monster, item, or wall.
  *
  * The result is returned via the `result` pointer (true = walkable).
  */
 ControllerStatusCode is_walkable(const Room *room, int x, int y, bool *result){
-    return CONTROLLER_SUCCESS;
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = is_walkable_impl(room, x, y, result);
+    STATS_CALL_END(STAT_IS_WALKABLE, status);
+    return status;
 }
 
+// -------------------------
+// Field of view
+// -------------------------
+
+static ControllerStatusCode controller_player_fov_impl(const Controller *ctrl, FovContext *fov,
+                                                       int radius, uint64_t *visible, size_t words,
+                                                       int *room_id){
+    if (ctrl == NULL || fov == NULL || visible == NULL) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    unsigned start;
+    FovStatusCode status = FOV_OK;
+    int id = -1;
+    do {
+        start = seq_read_begin(ctrl);
+        Player p = ctrl->player;
+        if (p.current_room == NULL) {
+            if (seq_read_retry(ctrl, start)) continue;
+            return CONTROLLER_NOT_FOUND;
+        }
+        id = p.current_room->id;
+        unsigned version = atomic_load_explicit(&ctrl->room_versions[id], memory_order_relaxed);
+        status = fov_compute(fov, p.current_room, version, p.tile_x, p.tile_y, radius, visible, words);
+    } while (seq_read_retry(ctrl, start));
+
+    if (status == FOV_ALLOCATION_FAILED) {
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    if (status != FOV_OK) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+    fov_commit(fov);
+    if (room_id != NULL) {
+        *room_id = id;
+    }
+    return CONTROLLER_OK;
+}
+
+/**
+ * Computes which tiles of the player's room the player can see.
+ */
+ControllerStatusCode controller_player_fov(const Controller *ctrl, FovContext *fov, int radius,
+                                           uint64_t *visible, size_t words, int *room_id){
+    STATS_CALL_BEGIN();
+    ControllerStatusCode status = controller_player_fov_impl(ctrl, fov, radius, visible, words, room_id);
+    STATS_CALL_END(STAT_PLAYER_FOV, status);
+    return status;
+}
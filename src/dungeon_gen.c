@@ -0,0 +1,327 @@
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "dungeon_gen.h"
+#include "memory_account.h"
+#include "room.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include "worldgen_config.h"
+
+#define VERTICAL_DOOR_CHANCE 40     // percent, for north-south edges outside column 0
+#define PLACEMENT_ATTEMPTS 8        // random tries to find a free tile for an entity
+#define PROGRESS_STEP 256           // rooms a shard generates between progress updates
+
+typedef struct {
+    char symbol;
+    const char *name;
+    int hp;
+    int attack;
+} MonsterKind;
+
+typedef struct {
+    char symbol;
+    const char *name;
+} ItemKind;
+
+static const MonsterKind monster_kinds[] = {
+    { 'G', "Goblin", 7, 2 },
+    { 'O', "Orc", 12, 3 },
+    { 'R', "Rat", 3, 1 },
+    { 'S', "Skeleton", 9, 2 },
+    { 'T', "Troll", 20, 5 },
+};
+
+static const ItemKind item_kinds[] = {
+    { '!', "Potion" },
+    { '$', "Gold" },
+    { '/', "Sword" },
+    { ']', "Shield" },
+    { '?', "Scroll" },
+};
+
+#define NUM_MONSTER_KINDS ((int)(sizeof(monster_kinds) / sizeof(monster_kinds[0])))
+#define NUM_ITEM_KINDS ((int)(sizeof(item_kinds) / sizeof(item_kinds[0])))
+
+static uint64_t splitmix64(uint64_t *state){
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint64_t stream_seed(unsigned seed, uint64_t salt){
+    uint64_t s = ((uint64_t)seed << 32) ^ (salt * 0xD1B54A32D192ED03ull);
+    return splitmix64(&s);
+}
+
+static int rand_below(uint64_t *rng, int n){
+    return n > 0 ? (int)(splitmix64(rng) % (uint64_t)n) : 0;
+}
+
+// The edge between vertically adjacent rooms `upper` and `upper + cols`.
+static int vertical_edge_open(unsigned seed, int upper, int cols){
+    if (upper % cols == 0) return 1;
+    uint64_t h = stream_seed(seed, ((uint64_t)upper << 1) | 1u);
+    return (int)(h % 100) < VERTICAL_DOOR_CHANCE;
+}
+
+static int tile_taken(const Room *room, int x, int y){
+    for (int i = 0; i < room->num_monsters; i++)
+        if (room->monsters[i].x == x && room->monsters[i].y == y) return 1;
+    for (int i = 0; i < room->num_items; i++)
+        if (room->items[i].x == x && room->items[i].y == y) return 1;
+    return 0;
+}
+
+// Picks a free interior tile, leaving the centre clear for the player to spawn on.
+static int pick_tile(const Room *room, uint64_t *rng, int *x, int *y){
+    for (int a = 0; a < PLACEMENT_ATTEMPTS; a++) {
+        int tx = 1 + rand_below(rng, room->width - 2);
+        int ty = 1 + rand_below(rng, room->height - 2);
+        if (tx == room->width / 2 && ty == room->height / 2) continue;
+        if (!tile_taken(room, tx, ty)) {
+            *x = tx;
+            *y = ty;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void add_door(Room *room, Direction dir){
+    Door *d = &room->doors[room->num_doors++];
+    d->dir = dir;
+    switch (dir) {
+        case DIR_NORTH: d->x = room->width / 2; d->y = 0; break;
+        case DIR_SOUTH: d->x = room->width / 2; d->y = room->height - 1; break;
+        case DIR_EAST:  d->x = room->width - 1; d->y = room->height / 2; break;
+        default:        d->x = 0;               d->y = room->height / 2; break;
+    }
+}
+
+// Shrinks an entity array to the `used` bytes it holds, freeing it if empty.
+static void *trim(void *array, size_t cap, size_t used){
+    if (used == 0) {
+        mem_free(MEM_ENTITIES, array, cap);
+        return NULL;
+    }
+    if (used < cap) {
+        void *trimmed = mem_realloc(MEM_ENTITIES, array, cap, used);
+        if (trimmed != NULL) {
+            return trimmed;
+        }
+        // Shrinking in place failed; keep the block but only account for what it holds.
+        mem_credit(MEM_ENTITIES, cap - used);
+    }
+    return array;
+}
+
+Room *generate_room(const DungeonConfig *config, int id){
+    if (config == NULL || id < 0 || id >= config->world.num_rooms) {
+        return NULL;
+    }
+    const WorldGenConfig *cfg = &config->world;
+    int cols = worldgen_grid_columns(cfg);
+    if (cols < 1) {
+        return NULL;
+    }
+
+    Room *room = mem_calloc(MEM_ROOMS, 1, sizeof(Room));
+    if (room == NULL) {
+        return NULL;
+    }
+    uint64_t rng = stream_seed(config->seed, (uint64_t)id << 1);
+    int var = cfg->room_size_variance;
+
+    room->id = id;
+    room->width = cfg->base_room_width + (var ? rand_below(&rng, 2 * var + 1) - var : 0);
+    room->height = cfg->base_room_height + (var ? rand_below(&rng, 2 * var + 1) - var : 0);
+    room->is_start = (id == 0);
+    room->is_exit = (id == cfg->num_rooms - 1);
+    room->grid_placement = id;
+
+    int col = id % cols;
+    room->neighbor_ids[DIR_NORTH] = id - cols >= 0 ? id - cols : -1;
+    room->neighbor_ids[DIR_SOUTH] = id + cols < cfg->num_rooms ? id + cols : -1;
+    room->neighbor_ids[DIR_EAST] = (col + 1 < cols && id + 1 < cfg->num_rooms) ? id + 1 : -1;
+    room->neighbor_ids[DIR_WEST] = col > 0 ? id - 1 : -1;
+
+    bool open[NUM_DIRECTIONS] = {
+        [DIR_NORTH] = room->neighbor_ids[DIR_NORTH] >= 0 && vertical_edge_open(config->seed, id - cols, cols),
+        [DIR_SOUTH] = room->neighbor_ids[DIR_SOUTH] >= 0 && vertical_edge_open(config->seed, id, cols),
+        [DIR_EAST] = room->neighbor_ids[DIR_EAST] >= 0,
+        [DIR_WEST] = room->neighbor_ids[DIR_WEST] >= 0,
+    };
+    int num_doors = open[DIR_NORTH] + open[DIR_SOUTH] + open[DIR_EAST] + open[DIR_WEST];
+    size_t monster_cap = (size_t)cfg->max_monsters_per_room * sizeof(Monster);
+    size_t item_cap = (size_t)cfg->max_items_per_room * sizeof(Item);
+
+    // Arrays are sized exactly (see destroy_room); entities are trimmed once placed.
+    if (num_doors > 0)
+        room->doors = mem_alloc(MEM_ENTITIES, (size_t)num_doors * sizeof(Door));
+    if (monster_cap > 0)
+        room->monsters = mem_alloc(MEM_ENTITIES, monster_cap);
+    if (item_cap > 0)
+        room->items = mem_alloc(MEM_ENTITIES, item_cap);
+    if ((num_doors > 0 && room->doors == NULL) ||
+        (monster_cap > 0 && room->monsters == NULL) ||
+        (item_cap > 0 && room->items == NULL)) {
+        mem_free(MEM_ENTITIES, room->doors, (size_t)num_doors * sizeof(Door));
+        mem_free(MEM_ENTITIES, room->monsters, monster_cap);
+        mem_free(MEM_ENTITIES, room->items, item_cap);
+        mem_free(MEM_ROOMS, room, sizeof(Room));
+        return NULL;
+    }
+
+    for (int dir = 0; dir < NUM_DIRECTIONS; dir++) {
+        if (open[dir]) add_door(room, (Direction)dir);
+    }
+
+    for (int k = 0; k < cfg->max_monsters_per_room; k++) {
+        if (rand_below(&rng, 100) >= cfg->monster_spawn_chance) continue;
+        const MonsterKind *kind = &monster_kinds[rand_below(&rng, NUM_MONSTER_KINDS)];
+        Monster *m = &room->monsters[room->num_monsters];
+        if (!pick_tile(room, &rng, &m->x, &m->y)) continue;
+        m->id = id * cfg->max_monsters_per_room + k;
+        m->symbol = kind->symbol;
+        m->name = kind->name;
+        m->hp = kind->hp;
+        m->attack = kind->attack;
+        room->num_monsters++;
+    }
+    for (int k = 0; k < cfg->max_items_per_room; k++) {
+        if (rand_below(&rng, 100) >= cfg->item_spawn_chance) continue;
+        const ItemKind *kind = &item_kinds[rand_below(&rng, NUM_ITEM_KINDS)];
+        Item *it = &room->items[room->num_items];
+        if (!pick_tile(room, &rng, &it->x, &it->y)) continue;
+        it->id = id * cfg->max_items_per_room + k;
+        it->symbol = kind->symbol;
+        it->name = kind->name;
+        room->num_items++;
+    }
+
+    // Keep the "NULL when empty" convention copy_room uses.
+    room->monsters = trim(room->monsters, monster_cap, (size_t)room->num_monsters * sizeof(Monster));
+    room->items = trim(room->items, item_cap, (size_t)room->num_items * sizeof(Item));
+    return room;
+}
+
+// -------------------------
+// Sharded generation
+// -------------------------
+
+// One band of grid rows: rooms [first, end).
+typedef struct {
+    const DungeonConfig *config;
+    Room **rooms;
+    int first;
+    int end;
+    atomic_bool *failed;
+    LoadProgress *progress;     // may be NULL
+    MemoryAccount *account;     // the caller's, charged from whichever thread runs the shard
+} Shard;
+
+static void generate_shard(void *arg){
+    Shard *shard = arg;
+    LoadProgress *progress = shard->progress;
+    MemoryAccount *previous = mem_account_enter(shard->account);
+    TRACE_BEGIN(span);
+    int pending = 0;
+    for (int id = shard->first; id < shard->end; id++) {
+        if (atomic_load_explicit(shard->failed, memory_order_relaxed)) {
+            break;
+        }
+        // Cancellation is one relaxed load per room; the shared counter is only
+        // touched every PROGRESS_STEP rooms.
+        if (progress != NULL) {
+            if (atomic_load_explicit(&progress->cancelled, memory_order_relaxed)) {
+                atomic_store_explicit(shard->failed, true, memory_order_relaxed);
+                break;
+            }
+            if (pending == PROGRESS_STEP) {
+                atomic_fetch_add_explicit(&progress->loaded, pending, memory_order_relaxed);
+                pending = 0;
+            }
+        }
+        shard->rooms[id] = generate_room(shard->config, id);
+        if (shard->rooms[id] == NULL) {
+            atomic_store_explicit(shard->failed, true, memory_order_relaxed);
+            break;
+        }
+        pending++;
+    }
+    if (progress != NULL) {
+        atomic_fetch_add_explicit(&progress->loaded, pending, memory_order_relaxed);
+    }
+    TRACE_END(span, "load", "generate_shard");
+    mem_account_enter(previous);
+}
+
+static int online_cpus(void){
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+bool generate_rooms(const DungeonConfig *config, int num_shards, LoadProgress *progress, Room **rooms){
+    if (config == NULL || rooms == NULL) {
+        return false;
+    }
+    const WorldGenConfig *cfg = &config->world;
+    int cols = worldgen_grid_columns(cfg);
+    if (cols < 1 || cfg->num_rooms < 1) {
+        return false;
+    }
+    memset(rooms, 0, (size_t)cfg->num_rooms * sizeof(Room *));
+
+    int rows = (int)(((long long)cfg->num_rooms + cols - 1) / cols);
+    if (num_shards <= 0) {
+        num_shards = online_cpus();
+    }
+    if (num_shards > rows) {
+        num_shards = rows;
+    }
+
+    atomic_bool failed;
+    atomic_init(&failed, false);
+    Shard *shards = num_shards > 1 ? malloc((size_t)num_shards * sizeof(Shard)) : NULL;
+    if (shards == NULL) {
+        // One shard, or no memory to split: generate everything right here.
+        Shard all = { config, rooms, 0, cfg->num_rooms, &failed, progress, mem_account_current() };
+        generate_shard(&all);
+    } else {
+        int cpus = online_cpus();
+        ThreadPool *pool = thread_pool_create(num_shards < cpus ? num_shards : cpus);
+        for (int s = 0; s < num_shards; s++) {
+            long long first_row = (long long)rows * s / num_shards;
+            long long end_row = (long long)rows * (s + 1) / num_shards;
+            long long end = end_row * cols;
+            shards[s] = (Shard){
+                .config = config, .rooms = rooms,
+                .first = (int)(first_row * cols),
+                .end = end < cfg->num_rooms ? (int)end : cfg->num_rooms,
+                .failed = &failed, .progress = progress, .account = mem_account_current()
+            };
+            if (pool == NULL || thread_pool_submit(pool, generate_shard, &shards[s]) != POOL_OK) {
+                generate_shard(&shards[s]);
+            }
+        }
+        if (pool != NULL) {
+            thread_pool_wait(pool);
+            thread_pool_destroy(pool);
+        }
+        free(shards);
+    }
+
+    if (atomic_load(&failed) ||
+        (progress != NULL && atomic_load_explicit(&progress->cancelled, memory_order_relaxed))) {
+        for (int id = 0; id < cfg->num_rooms; id++) {
+            destroy_room(rooms[id]);
+            rooms[id] = NULL;
+        }
+        return false;
+    }
+    return true;
+}
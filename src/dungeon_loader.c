@@ -1,4 +1,16 @@
+#include <pthread.h>
+#include <stdlib.h>
 #include "dungeon_controller.h"
+#include "dungeon_gen.h"
+#include "dungeon_loader.h"
+#include "room.h"
+#include "trace.h"
+#include "worldgen.h"
+#include "worldgen_config.h"
+
+// The world generator is a process-wide singleton; only one load may drive it at a time.
+static pthread_mutex_t worldgen_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * Loads a procedurally generated dungeon from a config file.
  * 
@@ -21,5 +33,139 @@
  *         (e.g., file not found, parsing error, memory allocation failure).
  */
 Tree *load_dungeon(const char *config_file, Room **first_room_out, int *num_rooms_out){
-    return NULL;
-}
\ No newline at end of file
+    return load_dungeon_with_progress(config_file, NULL, first_room_out, num_rooms_out);
+}
+
+static bool load_cancelled(const LoadProgress *progress){
+    return progress != NULL && atomic_load_explicit(&progress->cancelled, memory_order_relaxed);
+}
+
+/**
+ * Loads a dungeon from a config file, counting rooms in `progress` and
+ * giving up once it is cancelled.
+ *
+ * @param config_file    Path to the worldgen config file (.ini)
+ * @param progress       Optional progress and cancellation state
+ * @param first_room_out Optional; receives the start room
+ * @param num_rooms_out  Optional; receives the room count
+ * @return Pointer to the tree, or NULL on failure or cancellation
+ */
+Tree *load_dungeon_with_progress(const char *config_file, LoadProgress *progress,
+                                 Room **first_room_out, int *num_rooms_out){
+    if (config_file == NULL) {
+        return NULL;
+    }
+
+    Tree *tree = createTree(print_room, compare_rooms, destroy_room);
+    if (tree == NULL) {
+        return NULL;
+    }
+
+    Room *first_room = NULL;
+    int num_rooms = 0;
+
+    pthread_mutex_lock(&worldgen_lock);
+    if (load_cancelled(progress)) {
+        pthread_mutex_unlock(&worldgen_lock);
+        destroyTree(tree);
+        return NULL;
+    }
+    TRACE_BEGIN(start);
+    start_world_gen(config_file);
+    TRACE_END(start, "load", "start_world_gen");
+    while (has_more_rooms()) {
+        if (load_cancelled(progress)) {
+            stop_world_gen();
+            pthread_mutex_unlock(&worldgen_lock);
+            destroyTree(tree);
+            return NULL;
+        }
+        TRACE_BEGIN(next);
+        Room generated = get_next_room();
+        TRACE_END(next, "load", "get_next_room");
+        TRACE_BEGIN(copy_span);
+        Room *copy = copy_room(&generated);
+        TRACE_END(copy_span, "load", "copy_room");
+        TRACE_BEGIN(insert);
+        TreeStatusCode inserted = copy != NULL ? insertData(tree, copy) : TREE_ERROR;
+        TRACE_END(insert, "load", "insertData");
+        if (inserted != TREE_OK) {
+            destroy_room(copy);
+            stop_world_gen();
+            pthread_mutex_unlock(&worldgen_lock);
+            destroyTree(tree);
+            return NULL;
+        }
+        if (progress != NULL) {
+            atomic_fetch_add_explicit(&progress->loaded, 1, memory_order_relaxed);
+        }
+        if (copy->is_start && first_room == NULL) {
+            first_room = copy;
+        }
+        num_rooms++;
+    }
+    stop_world_gen();
+    pthread_mutex_unlock(&worldgen_lock);
+
+    if (first_room_out != NULL) {
+        *first_room_out = first_room;
+    }
+    if (num_rooms_out != NULL) {
+        *num_rooms_out = num_rooms;
+    }
+    return tree;
+}
+
+Tree *load_dungeon_from_config(const DungeonConfig *config, Room **first_room_out, int *num_rooms_out){
+    return load_dungeon_sharded(config, 1, NULL, first_room_out, num_rooms_out);
+}
+
+/**
+ * Builds a dungeon from a parsed config, generating its rooms in parallel shards.
+ *
+ * @param config         Config that passes worldgen_config_validate()
+ * @param num_shards     Number of shards; 0 or less uses one per online CPU
+ * @param progress       Optional progress and cancellation state
+ * @param first_room_out Optional; receives the start room
+ * @param num_rooms_out  Optional; receives the room count
+ * @return Pointer to the tree, or NULL on failure
+ */
+Tree *load_dungeon_sharded(const DungeonConfig *config, int num_shards, LoadProgress *progress,
+                           Room **first_room_out, int *num_rooms_out){
+    if (config == NULL || worldgen_config_validate(config, NULL) != CONFIG_OK) {
+        return NULL;
+    }
+
+    int num_rooms = config->world.num_rooms;
+    Room **rooms = malloc((size_t)num_rooms * sizeof(Room *));
+    if (rooms == NULL) {
+        return NULL;
+    }
+    TRACE_BEGIN(generate);
+    bool generated = generate_rooms(config, num_shards, progress, rooms);
+    TRACE_END(generate, "load", "generate_rooms");
+    if (!generated) {
+        free(rooms);
+        return NULL;
+    }
+    TRACE_BEGIN(build);
+    Tree *tree = createTreeFromSorted(print_room, compare_rooms, destroy_room,
+                                      (void **)rooms, (size_t)num_rooms);
+    TRACE_END(build, "load", "build_tree");
+    if (tree == NULL) {
+        for (int id = 0; id < num_rooms; id++) {
+            destroy_room(rooms[id]);
+        }
+        free(rooms);
+        return NULL;
+    }
+
+    if (first_room_out != NULL) {
+        *first_room_out = rooms[0];
+    }
+    if (num_rooms_out != NULL) {
+        *num_rooms_out = num_rooms;
+    }
+    free(rooms);
+    return tree;
+}
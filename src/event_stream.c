@@ -0,0 +1,104 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "event_stream.h"
+
+#define CACHE_LINE 64
+
+// Head and tail live on separate cache lines so producer and consumer do not false-share.
+struct EventStream {
+    _Alignas(CACHE_LINE) atomic_size_t head;    // next slot to write; producer-owned
+    size_t cached_tail;                         // producer's last view of `tail`
+    uint64_t next_sequence;
+    atomic_uint_fast64_t dropped;
+
+    _Alignas(CACHE_LINE) atomic_size_t tail;    // next slot to read; consumer-owned
+    size_t cached_head;                         // consumer's last view of `head`
+
+    _Alignas(CACHE_LINE) size_t mask;
+    ControllerEvent *slots;
+};
+
+EventStream *event_stream_create(size_t capacity){
+    if (capacity == 0 || capacity > ((size_t)1 << (sizeof(size_t) * 8 - 2))) {
+        return NULL;
+    }
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+
+    EventStream *stream = aligned_alloc(CACHE_LINE, sizeof(EventStream));
+    if (stream == NULL) {
+        return NULL;
+    }
+    stream->slots = malloc(size * sizeof(ControllerEvent));
+    if (stream->slots == NULL) {
+        free(stream);
+        return NULL;
+    }
+    atomic_init(&stream->head, 0);
+    atomic_init(&stream->tail, 0);
+    atomic_init(&stream->dropped, 0);
+    stream->cached_tail = 0;
+    stream->cached_head = 0;
+    stream->next_sequence = 0;
+    stream->mask = size - 1;
+    return stream;
+}
+
+void event_stream_destroy(EventStream *stream){
+    if (stream == NULL) {
+        return;
+    }
+    free(stream->slots);
+    free(stream);
+}
+
+bool event_stream_push(EventStream *stream, const ControllerEvent *event){
+    if (stream == NULL || event == NULL) {
+        return false;
+    }
+    size_t head = atomic_load_explicit(&stream->head, memory_order_relaxed);
+    uint64_t sequence = stream->next_sequence++;
+    // Only re-read the consumer's index when the cached one says we are full.
+    if (head - stream->cached_tail > stream->mask) {
+        stream->cached_tail = atomic_load_explicit(&stream->tail, memory_order_acquire);
+        if (head - stream->cached_tail > stream->mask) {
+            atomic_fetch_add_explicit(&stream->dropped, 1, memory_order_relaxed);
+            return false;
+        }
+    }
+    ControllerEvent *slot = &stream->slots[head & stream->mask];
+    *slot = *event;
+    slot->sequence = sequence;
+    atomic_store_explicit(&stream->head, head + 1, memory_order_release);
+    return true;
+}
+
+size_t event_stream_pop(EventStream *stream, ControllerEvent *out, size_t max){
+    if (stream == NULL || out == NULL) {
+        return 0;
+    }
+    size_t tail = atomic_load_explicit(&stream->tail, memory_order_relaxed);
+    if (stream->cached_head - tail < max) {
+        stream->cached_head = atomic_load_explicit(&stream->head, memory_order_acquire);
+    }
+    size_t available = stream->cached_head - tail;
+    size_t n = available < max ? available : max;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = stream->slots[(tail + i) & stream->mask];
+    }
+    if (n > 0) {
+        atomic_store_explicit(&stream->tail, tail + n, memory_order_release);
+    }
+    return n;
+}
+
+uint64_t event_stream_dropped(const EventStream *stream){
+    if (stream == NULL) {
+        return 0;
+    }
+    return atomic_load_explicit(&((EventStream *)stream)->dropped, memory_order_relaxed);
+}
+
+size_t event_stream_capacity(const EventStream *stream){
+    return stream != NULL ? stream->mask + 1 : 0;
+}
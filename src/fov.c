@@ -0,0 +1,298 @@
+#include <stdlib.h>
+#include <string.h>
+#include "fov.h"
+#include "room.h"
+
+#define FOV_SLOTS 8             // rooms remembered per context, direct-mapped by room ID
+
+// Cached opacity and result for one room.
+typedef struct {
+    int room_id;                // -1 while empty
+    int width, height;
+    size_t cap;                 // words allocated in each bitmap
+
+    uint64_t *opaque;
+    bool opacity_valid;
+    unsigned opacity_version;
+
+    uint64_t *result;
+    bool result_valid;
+    unsigned result_version;
+    int ox, oy, radius;
+} FovSlot;
+
+struct FovContext {
+    int max_radius;
+    float *left;                // by tri(row) + col: slope of the cell's left edge
+    float *right;               // ... and of its right edge
+    int *extent;                // by radius * (max_radius + 1) + row: last column within radius
+
+    FovSlot slots[FOV_SLOTS];
+
+    // Result of the last fov_compute, kept until fov_commit
+    FovSlot *pending;
+    unsigned pending_version;
+    int pending_x, pending_y, pending_radius;
+};
+
+// Parameters of one scan, shared by every level of the recursion.
+typedef struct {
+    const FovContext *fov;
+    const uint64_t *opaque;
+    uint64_t *visible;
+    int width, height;
+    int ox, oy;
+    int radius;
+    const int *extent;
+} Scan;
+
+static size_t tri(int row){
+    return (size_t)row * (size_t)(row + 1) / 2;
+}
+
+static void set_bit(uint64_t *bits, size_t i){
+    bits[i / 64] |= 1ull << (i % 64);
+}
+
+static bool test_bit(const uint64_t *bits, size_t i){
+    return (bits[i / 64] >> (i % 64)) & 1u;
+}
+
+size_t fov_bitset_words(int width, int height){
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
+    return ((size_t)width * (size_t)height + 63) / 64;
+}
+
+bool fov_is_visible(const uint64_t *visible, int width, int x, int y){
+    if (visible == NULL || x < 0 || y < 0 || x >= width) {
+        return false;
+    }
+    return test_bit(visible, (size_t)y * (size_t)width + (size_t)x);
+}
+
+FovContext *fov_create(int max_radius){
+    if (max_radius < 1 || max_radius > FOV_MAX_RADIUS) {
+        return NULL;
+    }
+    FovContext *fov = calloc(1, sizeof(FovContext));
+    if (fov == NULL) {
+        return NULL;
+    }
+    size_t cells = tri(max_radius + 1);
+    size_t stride = (size_t)max_radius + 1;
+    fov->max_radius = max_radius;
+    fov->left = malloc(cells * sizeof(float));
+    fov->right = malloc(cells * sizeof(float));
+    fov->extent = malloc(stride * stride * sizeof(int));
+    if (fov->left == NULL || fov->right == NULL || fov->extent == NULL) {
+        fov_destroy(fov);
+        return NULL;
+    }
+
+    // A cell `col` columns off the axis on `row` spans these slopes (column / row).
+    for (int row = 1; row <= max_radius; row++) {
+        for (int col = 0; col <= row; col++) {
+            fov->left[tri(row) + col] = (col + 0.5f) / (row - 0.5f);
+            fov->right[tri(row) + col] = (col - 0.5f) / (row + 0.5f);
+        }
+    }
+    for (int r = 0; r <= max_radius; r++) {
+        for (int row = 0; row <= max_radius; row++) {
+            int col = -1;
+            while (col < row && (col + 1) * (col + 1) + row * row <= r * r) {
+                col++;
+            }
+            fov->extent[(size_t)r * stride + row] = col;
+        }
+    }
+    for (int i = 0; i < FOV_SLOTS; i++) {
+        fov->slots[i].room_id = -1;
+    }
+    return fov;
+}
+
+void fov_destroy(FovContext *fov){
+    if (fov == NULL) {
+        return;
+    }
+    for (int i = 0; i < FOV_SLOTS; i++) {
+        free(fov->slots[i].opaque);
+        free(fov->slots[i].result);
+    }
+    free(fov->left);
+    free(fov->right);
+    free(fov->extent);
+    free(fov);
+}
+
+// Walls block sight except at doors; monsters block sight wherever they stand.
+static void build_opacity(const Room *room, uint64_t *opaque, size_t words){
+    const size_t w = (size_t)room->width;
+    const size_t h = (size_t)room->height;
+    memset(opaque, 0, words * sizeof(uint64_t));
+    for (size_t x = 0; x < w; x++) {
+        set_bit(opaque, x);
+        set_bit(opaque, (h - 1) * w + x);
+    }
+    for (size_t y = 0; y < h; y++) {
+        set_bit(opaque, y * w);
+        set_bit(opaque, y * w + w - 1);
+    }
+    for (int i = 0; i < room->num_doors; i++) {
+        const Door *d = &room->doors[i];
+        if (is_in_bounds(room, d->x, d->y)) {
+            size_t bit = (size_t)d->y * w + (size_t)d->x;
+            opaque[bit / 64] &= ~(1ull << (bit % 64));
+        }
+    }
+    for (int i = 0; i < room->num_monsters; i++) {
+        const Monster *m = &room->monsters[i];
+        if (is_in_bounds(room, m->x, m->y)) {
+            set_bit(opaque, (size_t)m->y * w + (size_t)m->x);
+        }
+    }
+}
+
+// Scans one octant from `row` outward between two slopes, recursing around
+// each run of opaque cells. (xx, xy, yx, yy) maps octant to room coordinates.
+static void cast(const Scan *s, int row, float start, float end, int xx, int xy, int yx, int yy){
+    if (start < end) {
+        return;
+    }
+    float new_start = 0.0f;
+    for (int j = row; j <= s->radius; j++) {
+        const float *left = s->fov->left + tri(j);
+        const float *right = s->fov->right + tri(j);
+        const int reach = s->extent[j];
+        bool blocked = false;
+        for (int col = j; col >= 0; col--) {
+            if (start < right[col]) {
+                continue;
+            }
+            if (end > left[col]) {
+                break;
+            }
+            int x = s->ox - col * xx - j * xy;
+            int y = s->oy - col * yx - j * yy;
+            bool inside = x >= 0 && x < s->width && y >= 0 && y < s->height;
+            size_t bit = inside ? (size_t)y * (size_t)s->width + (size_t)x : 0;
+            if (inside && col <= reach) {
+                set_bit(s->visible, bit);
+            }
+            bool opaque = !inside || test_bit(s->opaque, bit);
+            if (blocked) {
+                if (opaque) {
+                    new_start = right[col];
+                    continue;
+                }
+                blocked = false;
+                start = new_start;
+            } else if (opaque && j < s->radius) {
+                blocked = true;
+                cast(s, j + 1, start, left[col], xx, xy, yx, yy);
+                new_start = right[col];
+            }
+        }
+        if (blocked) {
+            break;
+        }
+    }
+}
+
+static bool reserve_slot(FovSlot *slot, size_t words){
+    if (words <= slot->cap) {
+        return true;
+    }
+    uint64_t *opaque = malloc(words * sizeof(uint64_t));
+    uint64_t *result = malloc(words * sizeof(uint64_t));
+    if (opaque == NULL || result == NULL) {
+        free(opaque);
+        free(result);
+        return false;
+    }
+    free(slot->opaque);
+    free(slot->result);
+    slot->opaque = opaque;
+    slot->result = result;
+    slot->cap = words;
+    return true;
+}
+
+FovStatusCode fov_compute(FovContext *fov, const Room *room, unsigned version, int x, int y,
+                          int radius, uint64_t *visible, size_t words){
+    if (fov == NULL || room == NULL || visible == NULL || radius < 0 || radius > fov->max_radius ||
+        !is_in_bounds(room, x, y)) {
+        return FOV_INVALID_ARGUMENT;
+    }
+    size_t need = fov_bitset_words(room->width, room->height);
+    if (words < need) {
+        return FOV_INVALID_ARGUMENT;
+    }
+    fov->pending = NULL;
+
+    FovSlot *slot = &fov->slots[(unsigned)room->id % FOV_SLOTS];
+    if (slot->room_id != room->id || slot->width != room->width || slot->height != room->height) {
+        if (!reserve_slot(slot, need)) {
+            slot->room_id = -1;
+            return FOV_ALLOCATION_FAILED;
+        }
+        slot->room_id = room->id;
+        slot->width = room->width;
+        slot->height = room->height;
+        slot->opacity_valid = false;
+        slot->result_valid = false;
+    }
+
+    if (version != 0 && slot->result_valid && slot->result_version == version &&
+        slot->ox == x && slot->oy == y && slot->radius == radius) {
+        memcpy(visible, slot->result, need * sizeof(uint64_t));
+        return FOV_OK;
+    }
+    if (version == 0 || !slot->opacity_valid || slot->opacity_version != version) {
+        slot->opacity_valid = false;
+        build_opacity(room, slot->opaque, need);
+    }
+
+    memset(visible, 0, need * sizeof(uint64_t));
+    set_bit(visible, (size_t)y * (size_t)room->width + (size_t)x);
+    Scan s = {
+        .fov = fov, .opaque = slot->opaque, .visible = visible,
+        .width = room->width, .height = room->height, .ox = x, .oy = y, .radius = radius,
+        .extent = fov->extent + (size_t)radius * ((size_t)fov->max_radius + 1)
+    };
+    static const int octants[8][4] = {
+        { 1, 0, 0, 1 }, { 0, 1, 1, 0 }, { 0, -1, 1, 0 }, { -1, 0, 0, 1 },
+        { -1, 0, 0, -1 }, { 0, -1, -1, 0 }, { 0, 1, -1, 0 }, { 1, 0, 0, -1 }
+    };
+    for (int o = 0; o < 8; o++) {
+        cast(&s, 1, 1.0f, 0.0f, octants[o][0], octants[o][1], octants[o][2], octants[o][3]);
+    }
+
+    slot->result_valid = false;
+    if (version != 0) {
+        memcpy(slot->result, visible, need * sizeof(uint64_t));
+        fov->pending = slot;
+        fov->pending_version = version;
+        fov->pending_x = x;
+        fov->pending_y = y;
+        fov->pending_radius = radius;
+    }
+    return FOV_OK;
+}
+
+void fov_commit(FovContext *fov){
+    if (fov == NULL || fov->pending == NULL) {
+        return;
+    }
+    FovSlot *slot = fov->pending;
+    slot->opacity_valid = true;
+    slot->opacity_version = fov->pending_version;
+    slot->result_valid = true;
+    slot->result_version = fov->pending_version;
+    slot->ox = fov->pending_x;
+    slot->oy = fov->pending_y;
+    slot->radius = fov->pending_radius;
+    fov->pending = NULL;
+}
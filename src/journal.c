@@ -0,0 +1,597 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "journal.h"
+
+#define JOURNAL_VERSION 1
+#define RECORD_SIZE 8
+#define HEADER_SIZE 32
+#define SCAN_CHUNK (RECORD_SIZE * 512)
+#define CHECKPOINT_FIXED_SIZE 72
+
+static const char log_magic[8] = { 'A', '1', 'J', 'R', 'N', 'L', 0, 0 };
+static const char ckpt_magic[8] = { 'A', '1', 'C', 'K', 'P', 'T', 0, 0 };
+
+struct Journal {
+    int fd;
+    char *path;
+    char *ckpt_path;
+    char *tmp_path;
+    JournalOptions options;
+    uint64_t fingerprint;
+    uint64_t generation;        // generation written in the log header
+    uint64_t size;              // bytes of the log on disk, header included
+
+    unsigned char *group;       // encoded records not yet written
+    size_t group_records;
+    uint64_t group_started_ns;  // when the oldest record in `group` was appended
+    int pending_ticks;          // ticks not yet folded into a record
+
+    long ops_since_checkpoint;
+    JournalStatusCode error;    // sticky I/O error
+};
+
+// -------------------------
+// Encoding helpers
+// -------------------------
+
+static uint64_t fnv1a(uint64_t h, const void *data, size_t len){
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+#define FNV_OFFSET 0xcbf29ce484222325ull
+
+static uint64_t config_fingerprint(const DungeonConfig *config){
+    const WorldGenConfig *c = &config->world;
+    const int fields[] = {
+        c->num_rooms, c->map_width, c->map_height, c->base_room_width, c->base_room_height,
+        c->room_size_variance, c->max_monsters_per_room, c->max_items_per_room,
+        c->monster_spawn_chance, c->item_spawn_chance, (int)config->seed
+    };
+    return fnv1a(FNV_OFFSET, fields, sizeof(fields));
+}
+
+static void put_u16(unsigned char *p, uint16_t v){ p[0] = (unsigned char)v; p[1] = (unsigned char)(v >> 8); }
+static void put_u32(unsigned char *p, uint32_t v){ put_u16(p, (uint16_t)v); put_u16(p + 2, (uint16_t)(v >> 16)); }
+static void put_u64(unsigned char *p, uint64_t v){ put_u32(p, (uint32_t)v); put_u32(p + 4, (uint32_t)(v >> 32)); }
+static uint16_t get_u16(const unsigned char *p){ return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t get_u32(const unsigned char *p){ return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16); }
+static uint64_t get_u64(const unsigned char *p){ return get_u32(p) | ((uint64_t)get_u32(p + 4) << 32); }
+
+static uint16_t record_check(const unsigned char *rec){
+    uint64_t h = fnv1a(FNV_OFFSET, rec, RECORD_SIZE - 2);
+    return (uint16_t)(h ^ (h >> 16) ^ (h >> 32) ^ (h >> 48));
+}
+
+// Layout: type, dir, dx (or tick count), dy, checksum; little-endian.
+static void encode_record(const JournalRecord *r, unsigned char *out){
+    out[0] = (unsigned char)r->type;
+    out[1] = (unsigned char)(r->type == JOURNAL_RECORD_MOVE_DIRECTION ? r->dir : 0);
+    put_u16(out + 2, (uint16_t)(r->type == JOURNAL_RECORD_TICK ? r->count : r->dx));
+    put_u16(out + 4, (uint16_t)(r->type == JOURNAL_RECORD_MOVE_WITHIN_ROOM ? r->dy : 0));
+    put_u16(out + 6, record_check(out));
+}
+
+static bool decode_record(const unsigned char *in, JournalRecord *r){
+    if (get_u16(in + 6) != record_check(in)) return false;
+    memset(r, 0, sizeof(*r));
+    r->type = (JournalRecordType)in[0];
+    switch (r->type) {
+        case JOURNAL_RECORD_MOVE_WITHIN_ROOM:
+            r->dx = (int16_t)get_u16(in + 2);
+            r->dy = (int16_t)get_u16(in + 4);
+            return true;
+        case JOURNAL_RECORD_MOVE_DIRECTION:
+            r->dir = (Direction)in[1];
+            return r->dir < NUM_DIRECTIONS;
+        case JOURNAL_RECORD_TICK:
+            r->count = get_u16(in + 2);
+            return r->count > 0;
+    }
+    return false;
+}
+
+// -------------------------
+// File helpers
+// -------------------------
+
+static uint64_t now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int write_all(int fd, const void *data, size_t len, off_t offset){
+    const unsigned char *p = data;
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+        offset += n;
+    }
+    return 0;
+}
+
+// Reads up to `len` bytes; returns the count read, or -1 on error.
+static ssize_t read_full(int fd, void *data, size_t len, off_t offset){
+    unsigned char *p = data;
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = pread(fd, p + done, len - done, offset + (off_t)done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) break;
+        done += (size_t)n;
+    }
+    return (ssize_t)done;
+}
+
+// Makes a rename in the journal's directory durable.
+static int sync_parent_dir(const char *path){
+    const char *slash = strrchr(path, '/');
+    char dir[4096];
+    if (slash == NULL) {
+        strcpy(dir, ".");
+    } else {
+        size_t len = slash == path ? 1 : (size_t)(slash - path);
+        if (len >= sizeof(dir)) return -1;
+        memcpy(dir, path, len);
+        dir[len] = '\0';
+    }
+    int fd = open(dir, O_RDONLY);
+    if (fd < 0) return -1;
+    int rc = fsync(fd);
+    close(fd);
+    return rc;
+}
+
+static char *concat(const char *a, const char *b){
+    size_t la = strlen(a), lb = strlen(b);
+    char *s = malloc(la + lb + 1);
+    if (s != NULL) {
+        memcpy(s, a, la);
+        memcpy(s + la, b, lb + 1);
+    }
+    return s;
+}
+
+static int write_header(Journal *j){
+    unsigned char h[HEADER_SIZE] = {0};
+    memcpy(h, log_magic, sizeof(log_magic));
+    put_u32(h + 8, JOURNAL_VERSION);
+    put_u32(h + 12, RECORD_SIZE);
+    put_u64(h + 16, j->fingerprint);
+    put_u64(h + 24, j->generation);
+    return write_all(j->fd, h, sizeof(h), 0);
+}
+
+// Finds the end of the last intact record at or after `from`.
+static JournalStatusCode scan_log(Journal *j, uint64_t from, uint64_t *end,
+                                  int (*apply)(const JournalRecord *, void *), void *user_data){
+    unsigned char chunk[SCAN_CHUNK];
+    uint64_t pos = from;
+    for (;;) {
+        ssize_t n = read_full(j->fd, chunk, sizeof(chunk), (off_t)pos);
+        if (n < 0) return JOURNAL_IO_ERROR;
+        size_t whole = (size_t)n / RECORD_SIZE * RECORD_SIZE;
+        for (size_t off = 0; off < whole; off += RECORD_SIZE) {
+            JournalRecord r;
+            if (!decode_record(chunk + off, &r)) {
+                *end = pos + off;
+                return JOURNAL_OK;
+            }
+            if (apply != NULL && apply(&r, user_data) != 0) {
+                *end = pos + off;
+                return JOURNAL_CORRUPT;
+            }
+        }
+        pos += whole;
+        if ((size_t)n < sizeof(chunk)) {
+            *end = pos;
+            return JOURNAL_OK;
+        }
+    }
+}
+
+static JournalStatusCode fail(Journal *j, JournalStatusCode status){
+    if (j->error == JOURNAL_OK) j->error = status;
+    return status;
+}
+
+// -------------------------
+// Public API
+// -------------------------
+
+Journal *journal_open(const char *path, const DungeonConfig *config,
+                      const JournalOptions *options, JournalStatusCode *status){
+    JournalStatusCode st = JOURNAL_OK;
+    JournalStatusCode *out = status != NULL ? status : &st;
+    if (path == NULL || config == NULL) {
+        *out = JOURNAL_INVALID_ARGUMENT;
+        return NULL;
+    }
+
+    Journal *j = calloc(1, sizeof(Journal));
+    if (j == NULL) {
+        *out = JOURNAL_ALLOCATION_FAILED;
+        return NULL;
+    }
+    j->fd = -1;
+    if (options != NULL) j->options = *options;
+    if (j->options.group_commit_records <= 0) j->options.group_commit_records = JOURNAL_DEFAULT_GROUP_RECORDS;
+    if (j->options.group_commit_ms <= 0) j->options.group_commit_ms = JOURNAL_DEFAULT_GROUP_MS;
+    if (j->options.checkpoint_interval <= 0) j->options.checkpoint_interval = JOURNAL_DEFAULT_CHECKPOINT_INTERVAL;
+    j->fingerprint = config_fingerprint(config);
+    j->path = concat(path, "");
+    j->ckpt_path = concat(path, ".ckpt");
+    j->tmp_path = concat(path, ".ckpt.tmp");
+    j->group = malloc((size_t)j->options.group_commit_records * RECORD_SIZE);
+    if (!j->path || !j->ckpt_path || !j->tmp_path || !j->group) {
+        *out = JOURNAL_ALLOCATION_FAILED;
+        journal_close(j);
+        return NULL;
+    }
+
+    j->fd = open(path, O_RDWR | O_CREAT, 0644);
+    struct stat sb;
+    if (j->fd < 0 || fstat(j->fd, &sb) != 0) {
+        *out = JOURNAL_IO_ERROR;
+        journal_close(j);
+        return NULL;
+    }
+
+    if (sb.st_size < HEADER_SIZE) {
+        // New (or never fully initialised) log.
+        if (ftruncate(j->fd, 0) != 0 || write_header(j) != 0 || fsync(j->fd) != 0) {
+            *out = JOURNAL_IO_ERROR;
+            journal_close(j);
+            return NULL;
+        }
+        j->size = HEADER_SIZE;
+    } else {
+        unsigned char h[HEADER_SIZE];
+        if (read_full(j->fd, h, sizeof(h), 0) != HEADER_SIZE) {
+            *out = JOURNAL_IO_ERROR;
+            journal_close(j);
+            return NULL;
+        }
+        if (memcmp(h, log_magic, sizeof(log_magic)) != 0 || get_u32(h + 8) != JOURNAL_VERSION ||
+            get_u32(h + 12) != RECORD_SIZE) {
+            *out = JOURNAL_CORRUPT;
+            journal_close(j);
+            return NULL;
+        }
+        if (get_u64(h + 16) != j->fingerprint) {
+            *out = JOURNAL_CONFIG_MISMATCH;
+            journal_close(j);
+            return NULL;
+        }
+        j->generation = get_u64(h + 24);
+        uint64_t end;
+        if (scan_log(j, HEADER_SIZE, &end, NULL, NULL) != JOURNAL_OK ||
+            ((uint64_t)sb.st_size != end && ftruncate(j->fd, (off_t)end) != 0)) {
+            *out = JOURNAL_IO_ERROR;
+            journal_close(j);
+            return NULL;
+        }
+        j->size = end;
+    }
+    *out = JOURNAL_OK;
+    return j;
+}
+
+// Encodes the pending tick run, if any, into the group.
+static void fold_ticks(Journal *j){
+    if (j->pending_ticks == 0) return;
+    JournalRecord r = { .type = JOURNAL_RECORD_TICK, .count = j->pending_ticks };
+    if (j->group_records == 0) j->group_started_ns = now_ns();
+    encode_record(&r, j->group + j->group_records * RECORD_SIZE);
+    j->group_records++;
+    j->pending_ticks = 0;
+}
+
+static JournalStatusCode flush_group(Journal *j){
+    if (j->error != JOURNAL_OK) return j->error;
+    fold_ticks(j);
+    if (j->group_records == 0) return JOURNAL_OK;
+    size_t len = j->group_records * RECORD_SIZE;
+    if (write_all(j->fd, j->group, len, (off_t)j->size) != 0 || fdatasync(j->fd) != 0) {
+        return fail(j, JOURNAL_IO_ERROR);
+    }
+    j->size += len;
+    j->group_records = 0;
+    return JOURNAL_OK;
+}
+
+JournalStatusCode journal_close(Journal *journal){
+    if (journal == NULL) {
+        return JOURNAL_INVALID_ARGUMENT;
+    }
+    JournalStatusCode status = JOURNAL_OK;
+    if (journal->fd >= 0) {
+        status = flush_group(journal);
+        close(journal->fd);
+    }
+    free(journal->path);
+    free(journal->ckpt_path);
+    free(journal->tmp_path);
+    free(journal->group);
+    free(journal);
+    return status;
+}
+
+static bool has_pending(const Journal *j){
+    return j->group_records > 0 || j->pending_ticks > 0;
+}
+
+// Age of the oldest unsynced record; only meaningful while has_pending.
+static uint64_t group_age_ns(const Journal *j){
+    return now_ns() - j->group_started_ns;
+}
+
+static uint64_t group_limit_ns(const Journal *j){
+    return (uint64_t)j->options.group_commit_ms * 1000000ull;
+}
+
+JournalStatusCode journal_append(Journal *journal, const JournalRecord *record){
+    if (journal == NULL || record == NULL) {
+        return JOURNAL_INVALID_ARGUMENT;
+    }
+    if (journal->error != JOURNAL_OK) {
+        return journal->error;
+    }
+    journal->ops_since_checkpoint++;
+
+    if (record->type == JOURNAL_RECORD_TICK) {
+        if (journal->pending_ticks == 0 && journal->group_records == 0) {
+            journal->group_started_ns = now_ns();
+        }
+        journal->pending_ticks++;
+        if (journal->pending_ticks == UINT16_MAX) fold_ticks(journal);
+    } else {
+        if (record->dx < INT16_MIN || record->dx > INT16_MAX ||
+            record->dy < INT16_MIN || record->dy > INT16_MAX) {
+            return JOURNAL_INVALID_ARGUMENT;
+        }
+        fold_ticks(journal);
+        if (journal->group_records == 0) journal->group_started_ns = now_ns();
+        encode_record(record, journal->group + journal->group_records * RECORD_SIZE);
+        journal->group_records++;
+    }
+
+    // One slot is kept free so a pending tick run can always be folded in.
+    bool full = journal->group_records + 1 >= (size_t)journal->options.group_commit_records;
+    if (full || group_age_ns(journal) >= group_limit_ns(journal)) {
+        return flush_group(journal);
+    }
+    return JOURNAL_OK;
+}
+
+JournalStatusCode journal_poll(Journal *journal, int *next_ms){
+    if (journal == NULL) {
+        return JOURNAL_INVALID_ARGUMENT;
+    }
+    JournalStatusCode status = journal->error;
+    if (status == JOURNAL_OK && has_pending(journal) &&
+        group_age_ns(journal) >= group_limit_ns(journal)) {
+        status = flush_group(journal);
+    }
+    if (next_ms != NULL) {
+        if (status != JOURNAL_OK || !has_pending(journal)) {
+            *next_ms = -1;
+        } else {
+            // Round up so a caller sleeping this long finds the group due.
+            uint64_t left = group_limit_ns(journal) - group_age_ns(journal);
+            *next_ms = (int)((left + 999999) / 1000000);
+        }
+    }
+    return status;
+}
+
+JournalStatusCode journal_sync(Journal *journal){
+    if (journal == NULL) {
+        return JOURNAL_INVALID_ARGUMENT;
+    }
+    return flush_group(journal);
+}
+
+bool journal_checkpoint_due(const Journal *journal){
+    return journal != NULL && journal->ops_since_checkpoint >= journal->options.checkpoint_interval;
+}
+
+JournalStatusCode journal_write_checkpoint(Journal *journal, const JournalCheckpoint *checkpoint){
+    if (journal == NULL || checkpoint == NULL ||
+        (checkpoint->visited_count > 0 && checkpoint->visited_ids == NULL) ||
+        (checkpoint->sim_state_size > 0 && checkpoint->sim_state == NULL)) {
+        return JOURNAL_INVALID_ARGUMENT;
+    }
+    JournalStatusCode status = flush_group(journal);
+    if (status != JOURNAL_OK) {
+        return status;
+    }
+
+    // The checkpoint covers everything logged so far, so it names the next (empty) log.
+    size_t fixed = CHECKPOINT_FIXED_SIZE;
+    size_t len = fixed + checkpoint->visited_count * 4 + checkpoint->sim_state_size + 8;
+    unsigned char *buf = calloc(1, len);
+    if (buf == NULL) {
+        return JOURNAL_ALLOCATION_FAILED;
+    }
+    memcpy(buf, ckpt_magic, sizeof(ckpt_magic));
+    put_u32(buf + 8, JOURNAL_VERSION);
+    put_u64(buf + 16, journal->fingerprint);
+    put_u64(buf + 24, journal->generation + 1);
+    put_u64(buf + 32, HEADER_SIZE);
+    put_u32(buf + 40, (uint32_t)checkpoint->room_id);
+    put_u32(buf + 44, (uint32_t)checkpoint->tile_x);
+    put_u32(buf + 48, (uint32_t)checkpoint->tile_y);
+    put_u32(buf + 52, (uint32_t)checkpoint->health);
+    put_u32(buf + 56, checkpoint->alive ? 1u : 0u);
+    put_u32(buf + 60, (uint32_t)checkpoint->visited_count);
+    put_u64(buf + 64, checkpoint->sim_state_size);
+    unsigned char *p = buf + fixed;
+    for (size_t i = 0; i < checkpoint->visited_count; i++, p += 4) {
+        put_u32(p, (uint32_t)checkpoint->visited_ids[i]);
+    }
+    if (checkpoint->sim_state_size > 0) {
+        memcpy(p, checkpoint->sim_state, checkpoint->sim_state_size);
+        p += checkpoint->sim_state_size;
+    }
+    put_u64(p, fnv1a(FNV_OFFSET, buf, (size_t)(p - buf)));
+
+    int fd = open(journal->tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int rc = fd < 0 ? -1 : write_all(fd, buf, len, 0);
+    if (rc == 0) rc = fsync(fd);
+    if (fd >= 0) close(fd);
+    free(buf);
+    if (rc != 0 || rename(journal->tmp_path, journal->ckpt_path) != 0 ||
+        sync_parent_dir(journal->ckpt_path) != 0) {
+        return fail(journal, JOURNAL_IO_ERROR);
+    }
+
+    // Cut the log before bumping its generation: a crash in between leaves an
+    // old-generation log, which recovery skips as already checkpointed.
+    journal->generation++;
+    if (ftruncate(journal->fd, HEADER_SIZE) != 0 || write_header(journal) != 0 ||
+        fdatasync(journal->fd) != 0) {
+        return fail(journal, JOURNAL_IO_ERROR);
+    }
+    journal->size = HEADER_SIZE;
+    journal->ops_since_checkpoint = 0;
+    return JOURNAL_OK;
+}
+
+JournalStatusCode journal_read_checkpoint(Journal *journal, JournalCheckpoint *out, bool *found){
+    if (journal == NULL || out == NULL || found == NULL) {
+        return JOURNAL_INVALID_ARGUMENT;
+    }
+    memset(out, 0, sizeof(*out));
+    *found = false;
+    int fd = open(journal->ckpt_path, O_RDONLY);
+    if (fd < 0) {
+        return errno == ENOENT ? JOURNAL_OK : JOURNAL_IO_ERROR;
+    }
+    struct stat sb;
+    if (fstat(fd, &sb) != 0) {
+        close(fd);
+        return JOURNAL_IO_ERROR;
+    }
+    size_t len = (size_t)sb.st_size;
+    if (len < CHECKPOINT_FIXED_SIZE + 8) {
+        close(fd);
+        return JOURNAL_CORRUPT;
+    }
+    unsigned char *buf = malloc(len);
+    if (buf == NULL) {
+        close(fd);
+        return JOURNAL_ALLOCATION_FAILED;
+    }
+    ssize_t n = read_full(fd, buf, len, 0);
+    close(fd);
+
+    JournalStatusCode status = JOURNAL_CORRUPT;
+    uint64_t visited = get_u32(buf + 60);
+    uint64_t sim = get_u64(buf + 64);
+    if (n != (ssize_t)len) {
+        status = JOURNAL_IO_ERROR;
+    } else if (memcmp(buf, ckpt_magic, sizeof(ckpt_magic)) != 0 ||
+               get_u32(buf + 8) != JOURNAL_VERSION ||
+               sim > len || (uint64_t)len != CHECKPOINT_FIXED_SIZE + visited * 4 + sim + 8 ||
+               get_u64(buf + len - 8) != fnv1a(FNV_OFFSET, buf, len - 8)) {
+        status = JOURNAL_CORRUPT;
+    } else if (get_u64(buf + 16) != journal->fingerprint) {
+        status = JOURNAL_CONFIG_MISMATCH;
+    } else {
+        out->generation = get_u64(buf + 24);
+        out->offset = get_u64(buf + 32);
+        out->room_id = (int32_t)get_u32(buf + 40);
+        out->tile_x = (int32_t)get_u32(buf + 44);
+        out->tile_y = (int32_t)get_u32(buf + 48);
+        out->health = (int32_t)get_u32(buf + 52);
+        out->alive = get_u32(buf + 56) != 0;
+        out->visited_count = (size_t)visited;
+        out->sim_state_size = (size_t)sim;
+        out->visited_ids = malloc((visited > 0 ? (size_t)visited : 1) * sizeof(int));
+        out->sim_state = malloc(sim > 0 ? (size_t)sim : 1);
+        if (out->visited_ids == NULL || out->sim_state == NULL) {
+            journal_checkpoint_free(out);
+            status = JOURNAL_ALLOCATION_FAILED;
+        } else {
+            const unsigned char *p = buf + CHECKPOINT_FIXED_SIZE;
+            for (size_t i = 0; i < visited; i++, p += 4) {
+                out->visited_ids[i] = (int32_t)get_u32(p);
+            }
+            memcpy(out->sim_state, p, (size_t)sim);
+            *found = true;
+            status = JOURNAL_OK;
+        }
+    }
+    free(buf);
+    return status;
+}
+
+void journal_checkpoint_free(JournalCheckpoint *checkpoint){
+    if (checkpoint == NULL) {
+        return;
+    }
+    free(checkpoint->visited_ids);
+    free(checkpoint->sim_state);
+    checkpoint->visited_ids = NULL;
+    checkpoint->sim_state = NULL;
+}
+
+JournalStatusCode journal_replay(Journal *journal, const JournalCheckpoint *from,
+                                 int (*apply)(const JournalRecord *record, void *user_data),
+                                 void *user_data){
+    if (journal == NULL || apply == NULL) {
+        return JOURNAL_INVALID_ARGUMENT;
+    }
+    uint64_t start = HEADER_SIZE;
+    if (from != NULL) {
+        if (from->generation == journal->generation + 1) {
+            // Crashed between checkpoint and log reset: the log is already folded in.
+            // Finish the reset so new records land in the checkpoint's generation.
+            journal->generation = from->generation;
+            if (ftruncate(journal->fd, HEADER_SIZE) != 0 || write_header(journal) != 0 ||
+                fdatasync(journal->fd) != 0) {
+                return fail(journal, JOURNAL_IO_ERROR);
+            }
+            journal->size = HEADER_SIZE;
+            return JOURNAL_OK;
+        }
+        if (from->generation != journal->generation || from->offset < HEADER_SIZE) {
+            return JOURNAL_CORRUPT;
+        }
+        start = from->offset;
+    }
+    uint64_t end;
+    return scan_log(journal, start, &end, apply, user_data);
+}
+
+const char *journal_status_string(JournalStatusCode status){
+    switch (status) {
+        case JOURNAL_OK:                return "ok";
+        case JOURNAL_INVALID_ARGUMENT:  return "invalid argument";
+        case JOURNAL_IO_ERROR:          return "I/O error";
+        case JOURNAL_CORRUPT:           return "journal is corrupt";
+        case JOURNAL_CONFIG_MISMATCH:   return "journal was written for a different config";
+        case JOURNAL_ALLOCATION_FAILED: return "allocation failed";
+    }
+    return "unknown status";
+}
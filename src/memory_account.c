@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include "memory_account.h"
+
+static _Thread_local MemoryAccount *current;
+
+void mem_account_init(MemoryAccount *account, size_t budget){
+    for (int c = 0; c < MEM_CATEGORY_COUNT; c++) {
+        atomic_init(&account->bytes[c], 0);
+    }
+    atomic_init(&account->total, 0);
+    atomic_init(&account->peak, 0);
+    atomic_init(&account->refused, 0);
+    atomic_init(&account->failed, 0);
+    account->budget = budget;
+}
+
+MemoryAccount *mem_account_enter(MemoryAccount *account){
+    MemoryAccount *previous = current;
+    current = account;
+    return previous;
+}
+
+MemoryAccount *mem_account_current(void){
+    return current;
+}
+
+bool mem_charge(MemCategory category, size_t bytes){
+    MemoryAccount *account = current;
+    if (account == NULL || bytes == 0) {
+        return true;
+    }
+    // Commit the charge only if it fits, so two racing charges cannot both be
+    // refused over bytes that neither ends up holding.
+    size_t old = atomic_load_explicit(&account->total, memory_order_relaxed);
+    size_t total;
+    do {
+        if (account->budget != 0 && (bytes > account->budget || old > account->budget - bytes)) {
+            atomic_fetch_add_explicit(&account->refused, 1, memory_order_relaxed);
+            return false;
+        }
+        total = old + bytes;
+    } while (!atomic_compare_exchange_weak_explicit(&account->total, &old, total,
+                                                    memory_order_relaxed, memory_order_relaxed));
+    atomic_fetch_add_explicit(&account->bytes[category], bytes, memory_order_relaxed);
+    size_t peak = atomic_load_explicit(&account->peak, memory_order_relaxed);
+    while (total > peak &&
+           !atomic_compare_exchange_weak_explicit(&account->peak, &peak, total,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+    return true;
+}
+
+void mem_credit(MemCategory category, size_t bytes){
+    MemoryAccount *account = current;
+    if (account == NULL || bytes == 0) {
+        return;
+    }
+    atomic_fetch_sub_explicit(&account->bytes[category], bytes, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&account->total, bytes, memory_order_relaxed);
+}
+
+// Records an allocation that failed for want of memory rather than budget.
+static void note_failure(void){
+    if (current != NULL) {
+        atomic_fetch_add_explicit(&current->failed, 1, memory_order_relaxed);
+    }
+}
+
+void *mem_alloc(MemCategory category, size_t size){
+    if (!mem_charge(category, size)) {
+        return NULL;
+    }
+    void *ptr = malloc(size);
+    if (ptr == NULL) {
+        mem_credit(category, size);
+        note_failure();
+    }
+    return ptr;
+}
+
+void *mem_calloc(MemCategory category, size_t count, size_t size){
+    if (size != 0 && count > SIZE_MAX / size) {
+        note_failure();
+        return NULL;
+    }
+    if (!mem_charge(category, count * size)) {
+        return NULL;
+    }
+    void *ptr = calloc(count, size);
+    if (ptr == NULL) {
+        mem_credit(category, count * size);
+        note_failure();
+    }
+    return ptr;
+}
+
+void *mem_realloc(MemCategory category, void *ptr, size_t old_size, size_t new_size){
+    if (new_size > old_size && !mem_charge(category, new_size - old_size)) {
+        return NULL;
+    }
+    void *moved = realloc(ptr, new_size);
+    if (moved == NULL) {
+        if (new_size > old_size) {
+            mem_credit(category, new_size - old_size);
+        }
+        note_failure();
+        return NULL;
+    }
+    if (new_size < old_size) {
+        mem_credit(category, old_size - new_size);
+    }
+    return moved;
+}
+
+void mem_free(MemCategory category, void *ptr, size_t size){
+    if (ptr == NULL) {
+        return;
+    }
+    free(ptr);
+    mem_credit(category, size);
+}
@@ -0,0 +1,607 @@
+#include <stdlib.h>
+#include <string.h>
+#include "render_codec.h"
+#include "room.h"
+
+#define VARINT_MAX 5            // bytes in the longest varint of a 32-bit value
+#define CELL_MAX (2 * VARINT_MAX + 1)
+
+// One overlay tile. `order` is the draw order, so the last entity on a tile wins.
+typedef struct {
+    int x, y;
+    int order;
+    char ch;
+} Cell;
+
+struct RenderEncoder {
+    bool delta;
+    bool need_key;
+
+    // Last committed frame
+    bool has_prev;
+    int prev_room_id;
+    int prev_width, prev_height;
+    uint32_t next_seq;
+    Cell *prev_cells;           // its overlay, sorted by (y, x), one entry per tile
+    size_t prev_count;
+    size_t prev_cap;
+
+    // Pending frame
+    Cell *cells;
+    size_t count;
+    size_t cells_cap;
+    int room_id;
+    int width, height;
+    unsigned char *buf;
+    size_t len;
+    size_t buf_cap;
+
+    // Per-row scratch, sized for the room's door count
+    int *door_xs;
+    char *run_ch;
+    int *run_len;
+    unsigned char *row;
+    unsigned char *last_row;
+    size_t last_row_len;
+    size_t scratch_doors;
+};
+
+struct RenderDecoder {
+    char *text;                 // render_room_by_id format
+    size_t cap;
+    bool valid;                 // false until a key frame has been applied
+    int room_id;
+    int width, height;
+    uint32_t seq;
+};
+
+// -------------------------
+// Byte helpers
+// -------------------------
+
+static void put_u16(unsigned char *p, uint16_t v){ p[0] = (unsigned char)v; p[1] = (unsigned char)(v >> 8); }
+static void put_u32(unsigned char *p, uint32_t v){ put_u16(p, (uint16_t)v); put_u16(p + 2, (uint16_t)(v >> 16)); }
+static uint16_t get_u16(const unsigned char *p){ return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t get_u32(const unsigned char *p){ return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16); }
+
+static unsigned char *put_varint(unsigned char *p, uint32_t v){
+    while (v >= 0x80) {
+        *p++ = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (unsigned char)v;
+    return p;
+}
+
+// Reads a varint from [*p, end); returns false if it is truncated or too long.
+static bool get_varint(const unsigned char **p, const unsigned char *end, uint32_t *out){
+    uint32_t v = 0;
+    for (int shift = 0; shift < 7 * VARINT_MAX; shift += 7) {
+        if (*p == end) {
+            return false;
+        }
+        unsigned char b = *(*p)++;
+        v |= (uint32_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            *out = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool reserve(void **ptr, size_t *cap, size_t need, size_t elem){
+    if (need <= *cap) {
+        return true;
+    }
+    size_t n = *cap ? *cap : 16;
+    while (n < need) {
+        n *= 2;
+    }
+    void *grown = realloc(*ptr, n * elem);
+    if (grown == NULL) {
+        return false;
+    }
+    *ptr = grown;
+    *cap = n;
+    return true;
+}
+
+// -------------------------
+// Encoder
+// -------------------------
+
+RenderEncoder *render_encoder_create(bool delta){
+    RenderEncoder *enc = calloc(1, sizeof(RenderEncoder));
+    if (enc == NULL) {
+        return NULL;
+    }
+    enc->delta = delta;
+    enc->need_key = true;
+    return enc;
+}
+
+void render_encoder_free(RenderEncoder *enc){
+    if (enc == NULL) {
+        return;
+    }
+    free(enc->prev_cells);
+    free(enc->cells);
+    free(enc->buf);
+    free(enc->door_xs);
+    free(enc->run_ch);
+    free(enc->run_len);
+    free(enc->row);
+    free(enc->last_row);
+    free(enc);
+}
+
+void render_encoder_reset(RenderEncoder *enc){
+    if (enc != NULL) {
+        enc->need_key = true;
+    }
+}
+
+static size_t row_bound(size_t doors){
+    return VARINT_MAX + (2 * doors + 3) * (1 + VARINT_MAX);
+}
+
+static bool reserve_scratch(RenderEncoder *enc, size_t doors){
+    if (enc->row != NULL && doors <= enc->scratch_doors) {
+        return true;
+    }
+    size_t runs = 2 * doors + 3;
+    int *door_xs = malloc((doors ? doors : 1) * sizeof(int));
+    char *run_ch = malloc(runs);
+    int *run_len = malloc(runs * sizeof(int));
+    unsigned char *row = malloc(row_bound(doors));
+    unsigned char *last_row = malloc(row_bound(doors));
+    if (!door_xs || !run_ch || !run_len || !row || !last_row) {
+        free(door_xs);
+        free(run_ch);
+        free(run_len);
+        free(row);
+        free(last_row);
+        return false;
+    }
+    free(enc->door_xs);
+    free(enc->run_ch);
+    free(enc->run_len);
+    free(enc->row);
+    free(enc->last_row);
+    enc->door_xs = door_xs;
+    enc->run_ch = run_ch;
+    enc->run_len = run_len;
+    enc->row = row;
+    enc->last_row = last_row;
+    enc->scratch_doors = doors;
+    return true;
+}
+
+// The static layer at one tile: walls around the edge, floor inside, doors on top.
+static char base_tile(const Room *room, int x, int y){
+    for (int i = 0; i < room->num_doors; i++) {
+        if (room->doors[i].x == x && room->doors[i].y == y) {
+            return TILE_DOOR;
+        }
+    }
+    bool edge = y == 0 || y == room->height - 1 || x == 0 || x == room->width - 1;
+    return edge ? TILE_WALL : TILE_FLOOR;
+}
+
+static int compare_cells(const void *a, const void *b){
+    const Cell *ca = a;
+    const Cell *cb = b;
+    if (ca->y != cb->y) {
+        return ca->y < cb->y ? -1 : 1;
+    }
+    if (ca->x != cb->x) {
+        return ca->x < cb->x ? -1 : 1;
+    }
+    return (ca->order > cb->order) - (ca->order < cb->order);
+}
+
+static void add_cell(RenderEncoder *enc, const Room *room, int x, int y, char ch){
+    if (x >= 0 && x < room->width && y >= 0 && y < room->height) {
+        enc->cells[enc->count] = (Cell){ x, y, (int)enc->count, ch };
+        enc->count++;
+    }
+}
+
+// Collects the pending overlay: the topmost entity on each occupied tile, sorted by tile.
+static bool build_overlay(RenderEncoder *enc, const Room *room, const Player *player){
+    size_t max = (size_t)room->num_items + (size_t)room->num_monsters + 1;
+    if (!reserve((void **)&enc->cells, &enc->cells_cap, max, sizeof(Cell))) {
+        return false;
+    }
+    enc->count = 0;
+    for (int i = 0; i < room->num_items; i++) {
+        add_cell(enc, room, room->items[i].x, room->items[i].y, room->items[i].symbol);
+    }
+    for (int i = 0; i < room->num_monsters; i++) {
+        add_cell(enc, room, room->monsters[i].x, room->monsters[i].y, room->monsters[i].symbol);
+    }
+    if (player != NULL && player->current_room == room) {
+        add_cell(enc, room, player->tile_x, player->tile_y, TILE_PLAYER);
+    }
+    // Rooms hold a handful of entities, so insertion sort beats qsort here.
+    for (size_t i = 1; i < enc->count; i++) {
+        Cell c = enc->cells[i];
+        size_t j = i;
+        while (j > 0 && compare_cells(&enc->cells[j - 1], &c) > 0) {
+            enc->cells[j] = enc->cells[j - 1];
+            j--;
+        }
+        enc->cells[j] = c;
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < enc->count; i++) {
+        if (kept > 0 && enc->cells[kept - 1].x == enc->cells[i].x &&
+            enc->cells[kept - 1].y == enc->cells[i].y) {
+            enc->cells[kept - 1] = enc->cells[i];
+        } else {
+            enc->cells[kept++] = enc->cells[i];
+        }
+    }
+    enc->count = kept;
+    return true;
+}
+
+static void push_run(RenderEncoder *enc, int *runs, char ch, int len){
+    if (len <= 0) {
+        return;
+    }
+    if (*runs > 0 && enc->run_ch[*runs - 1] == ch) {
+        enc->run_len[*runs - 1] += len;
+    } else {
+        enc->run_ch[*runs] = ch;
+        enc->run_len[*runs] = len;
+        (*runs)++;
+    }
+}
+
+// Encodes the static layer of row y into enc->row, working from segments rather than tiles.
+static size_t encode_row(RenderEncoder *enc, const Room *room, int y){
+    const int w = room->width;
+    int doors = 0;
+    for (int i = 0; i < room->num_doors; i++) {
+        const Door *d = &room->doors[i];
+        if (d->y == y && d->x >= 0 && d->x < w) {
+            int j = doors++;
+            while (j > 0 && enc->door_xs[j - 1] > d->x) {
+                enc->door_xs[j] = enc->door_xs[j - 1];
+                j--;
+            }
+            enc->door_xs[j] = d->x;
+        }
+    }
+
+    int seg_start[3], seg_end[3];
+    char seg_ch[3];
+    int segs;
+    if (y == 0 || y == room->height - 1 || w <= 2) {
+        seg_start[0] = 0; seg_end[0] = w; seg_ch[0] = TILE_WALL;
+        segs = 1;
+    } else {
+        seg_start[0] = 0;     seg_end[0] = 1;     seg_ch[0] = TILE_WALL;
+        seg_start[1] = 1;     seg_end[1] = w - 1; seg_ch[1] = TILE_FLOOR;
+        seg_start[2] = w - 1; seg_end[2] = w;     seg_ch[2] = TILE_WALL;
+        segs = 3;
+    }
+
+    int runs = 0;
+    int door = 0;
+    for (int s = 0; s < segs; s++) {
+        int cursor = seg_start[s];
+        for (; door < doors && enc->door_xs[door] < seg_end[s]; door++) {
+            int x = enc->door_xs[door];
+            if (x < cursor) {
+                continue;           // duplicate door
+            }
+            push_run(enc, &runs, seg_ch[s], x - cursor);
+            push_run(enc, &runs, TILE_DOOR, 1);
+            cursor = x + 1;
+        }
+        push_run(enc, &runs, seg_ch[s], seg_end[s] - cursor);
+    }
+
+    unsigned char *p = put_varint(enc->row, (uint32_t)runs);
+    for (int r = 0; r < runs; r++) {
+        *p++ = (unsigned char)enc->run_ch[r];
+        p = put_varint(p, (uint32_t)enc->run_len[r]);
+    }
+    return (size_t)(p - enc->row);
+}
+
+static unsigned char *put_cell(unsigned char *p, int x, int y, char ch){
+    p = put_varint(p, (uint32_t)x);
+    p = put_varint(p, (uint32_t)y);
+    *p++ = (unsigned char)ch;
+    return p;
+}
+
+static unsigned char *encode_key(RenderEncoder *enc, const Room *room, unsigned char *p){
+    size_t repeats = 0;
+    enc->last_row_len = 0;
+    for (int y = 0; y < room->height; y++) {
+        size_t len = encode_row(enc, room, y);
+        if (y > 0 && len == enc->last_row_len && memcmp(enc->row, enc->last_row, len) == 0) {
+            repeats++;
+            continue;
+        }
+        if (repeats > 0) {
+            *p++ = 0;
+            p = put_varint(p, (uint32_t)repeats);
+            repeats = 0;
+        }
+        memcpy(p, enc->row, len);
+        p += len;
+        unsigned char *swap = enc->last_row;
+        enc->last_row = enc->row;
+        enc->row = swap;
+        enc->last_row_len = len;
+    }
+    if (repeats > 0) {
+        *p++ = 0;
+        p = put_varint(p, (uint32_t)repeats);
+    }
+
+    p = put_varint(p, (uint32_t)enc->count);
+    for (size_t i = 0; i < enc->count; i++) {
+        p = put_cell(p, enc->cells[i].x, enc->cells[i].y, enc->cells[i].ch);
+    }
+    return p;
+}
+
+// Merges the previous and pending overlays (both sorted by tile) and writes
+// every tile whose visible character changed. The count is patched in last.
+static unsigned char *encode_delta(RenderEncoder *enc, const Room *room, unsigned char *p){
+    unsigned char *count_at = p;
+    p += VARINT_MAX;
+    uint32_t changes = 0;
+    size_t i = 0, j = 0;
+    while (i < enc->prev_count || j < enc->count) {
+        const Cell *old = i < enc->prev_count ? &enc->prev_cells[i] : NULL;
+        const Cell *cur = j < enc->count ? &enc->cells[j] : NULL;
+        int order = old == NULL ? 1 : cur == NULL ? -1 : compare_cells(old, cur);
+        if (old != NULL && cur != NULL && old->x == cur->x && old->y == cur->y) {
+            order = 0;
+        }
+        int x, y;
+        char was, now;
+        if (order < 0) {
+            x = old->x; y = old->y;
+            was = old->ch;
+            now = base_tile(room, x, y);
+            i++;
+        } else if (order > 0) {
+            x = cur->x; y = cur->y;
+            was = base_tile(room, x, y);
+            now = cur->ch;
+            j++;
+        } else {
+            x = cur->x; y = cur->y;
+            was = old->ch;
+            now = cur->ch;
+            i++;
+            j++;
+        }
+        if (was != now) {
+            p = put_cell(p, x, y, now);
+            changes++;
+        }
+    }
+
+    // Shift the cells down over the unused part of the reserved count.
+    unsigned char count[VARINT_MAX];
+    size_t count_len = (size_t)(put_varint(count, changes) - count);
+    size_t body = (size_t)(p - (count_at + VARINT_MAX));
+    memmove(count_at + count_len, count_at + VARINT_MAX, body);
+    memcpy(count_at, count, count_len);
+    return count_at + count_len + body;
+}
+
+RenderCodecStatusCode render_encode_room(RenderEncoder *enc, const Room *room, const Player *player){
+    if (enc == NULL || room == NULL || room->width < 1 || room->height < 1 ||
+        room->width > UINT16_MAX || room->height > UINT16_MAX || room->num_doors < 0) {
+        return RENDER_CODEC_INVALID_ARGUMENT;
+    }
+    if (!reserve_scratch(enc, (size_t)room->num_doors) || !build_overlay(enc, room, player)) {
+        return RENDER_CODEC_ALLOCATION_FAILED;
+    }
+
+    bool delta = enc->delta && !enc->need_key && enc->has_prev && enc->prev_room_id == room->id &&
+                 enc->prev_width == room->width && enc->prev_height == room->height;
+
+    // Size the buffer once for the worst case so the encoders below never check.
+    size_t bound = RENDER_FRAME_HEADER_SIZE + VARINT_MAX;
+    if (delta) {
+        bound += (enc->prev_count + enc->count) * CELL_MAX;
+    } else {
+        bound += (size_t)room->height * row_bound((size_t)room->num_doors) + enc->count * CELL_MAX;
+    }
+    if (!reserve((void **)&enc->buf, &enc->buf_cap, bound, 1)) {
+        return RENDER_CODEC_ALLOCATION_FAILED;
+    }
+
+    unsigned char *p = enc->buf;
+    p[0] = 'R';
+    p[1] = delta ? RENDER_FRAME_DELTA : RENDER_FRAME_KEY;
+    put_u16(p + 2, (uint16_t)room->width);
+    put_u16(p + 4, (uint16_t)room->height);
+    put_u32(p + 6, (uint32_t)room->id);
+    put_u32(p + 10, enc->next_seq);
+    p += RENDER_FRAME_HEADER_SIZE;
+    p = delta ? encode_delta(enc, room, p) : encode_key(enc, room, p);
+
+    enc->len = (size_t)(p - enc->buf);
+    enc->room_id = room->id;
+    enc->width = room->width;
+    enc->height = room->height;
+    return RENDER_CODEC_OK;
+}
+
+void render_encoder_commit(RenderEncoder *enc, const uint8_t **data, size_t *size){
+    Cell *swap = enc->prev_cells;
+    size_t swap_cap = enc->prev_cap;
+    enc->prev_cells = enc->cells;
+    enc->prev_cap = enc->cells_cap;
+    enc->prev_count = enc->count;
+    enc->cells = swap;
+    enc->cells_cap = swap_cap;
+    enc->count = 0;
+
+    enc->has_prev = true;
+    enc->need_key = false;
+    enc->prev_room_id = enc->room_id;
+    enc->prev_width = enc->width;
+    enc->prev_height = enc->height;
+    enc->next_seq++;
+    if (data != NULL) {
+        *data = enc->buf;
+    }
+    if (size != NULL) {
+        *size = enc->len;
+    }
+}
+
+// -------------------------
+// Decoder
+// -------------------------
+
+RenderDecoder *render_decoder_create(void){
+    return calloc(1, sizeof(RenderDecoder));
+}
+
+void render_decoder_free(RenderDecoder *dec){
+    if (dec == NULL) {
+        return;
+    }
+    free(dec->text);
+    free(dec);
+}
+
+// Reads `count` overlay cells and draws them; false if any is malformed or out of bounds.
+static bool decode_cells(RenderDecoder *dec, const unsigned char **p, const unsigned char *end){
+    const size_t stride = (size_t)dec->width + 1;
+    uint32_t count, x, y;
+    if (!get_varint(p, end, &count)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (!get_varint(p, end, &x) || !get_varint(p, end, &y) || *p == end ||
+            x >= (uint32_t)dec->width || y >= (uint32_t)dec->height) {
+            return false;
+        }
+        dec->text[y * stride + x] = (char)*(*p)++;
+    }
+    return true;
+}
+
+static bool decode_rows(RenderDecoder *dec, const unsigned char **p, const unsigned char *end){
+    const size_t stride = (size_t)dec->width + 1;
+    uint32_t y = 0;
+    while (y < (uint32_t)dec->height) {
+        char *row = dec->text + y * stride;
+        uint32_t runs, len;
+        if (!get_varint(p, end, &runs)) {
+            return false;
+        }
+        if (runs == 0) {
+            if (y == 0 || !get_varint(p, end, &len) || len == 0 || len > (uint32_t)dec->height - y) {
+                return false;
+            }
+            for (uint32_t k = 0; k < len; k++) {
+                memcpy(row + k * stride, row - stride, stride);
+            }
+            y += len;
+            continue;
+        }
+        uint32_t x = 0;
+        for (uint32_t r = 0; r < runs; r++) {
+            if (*p == end) {
+                return false;
+            }
+            char ch = (char)*(*p)++;
+            if (!get_varint(p, end, &len) || len > (uint32_t)dec->width - x) {
+                return false;
+            }
+            memset(row + x, ch, len);
+            x += len;
+        }
+        if (x != (uint32_t)dec->width) {
+            return false;
+        }
+        row[dec->width] = '\n';
+        y++;
+    }
+    return true;
+}
+
+RenderCodecStatusCode render_decode(RenderDecoder *dec, const uint8_t *data, size_t size){
+    if (dec == NULL || (data == NULL && size > 0)) {
+        return RENDER_CODEC_INVALID_ARGUMENT;
+    }
+    if (size < RENDER_FRAME_HEADER_SIZE || data[0] != 'R' ||
+        (data[1] != RENDER_FRAME_KEY && data[1] != RENDER_FRAME_DELTA)) {
+        return RENDER_CODEC_CORRUPT;
+    }
+    int width = get_u16(data + 2);
+    int height = get_u16(data + 4);
+    int room_id = (int)get_u32(data + 6);
+    uint32_t seq = get_u32(data + 10);
+    const unsigned char *p = data + RENDER_FRAME_HEADER_SIZE;
+    const unsigned char *end = data + size;
+
+    if (data[1] == RENDER_FRAME_DELTA) {
+        if (!dec->valid || dec->room_id != room_id || dec->width != width ||
+            dec->height != height || seq != dec->seq + 1) {
+            return RENDER_CODEC_NEED_KEYFRAME;
+        }
+    } else {
+        if (width == 0 || height == 0) {
+            return RENDER_CODEC_CORRUPT;
+        }
+        size_t need = ((size_t)width + 1) * (size_t)height + 1;
+        if (!reserve((void **)&dec->text, &dec->cap, need, 1)) {
+            dec->valid = false;
+            return RENDER_CODEC_ALLOCATION_FAILED;
+        }
+        dec->width = width;
+        dec->height = height;
+        dec->room_id = room_id;
+    }
+
+    bool ok = (data[1] == RENDER_FRAME_DELTA || decode_rows(dec, &p, end)) &&
+              decode_cells(dec, &p, end) && p == end;
+    if (!ok) {
+        dec->valid = false;
+        return RENDER_CODEC_CORRUPT;
+    }
+    dec->text[((size_t)width + 1) * (size_t)height] = '\0';
+    dec->seq = seq;
+    dec->valid = true;
+    return RENDER_CODEC_OK;
+}
+
+const char *render_decoder_text(const RenderDecoder *dec, int *room_id){
+    if (dec == NULL || !dec->valid) {
+        return NULL;
+    }
+    if (room_id != NULL) {
+        *room_id = dec->room_id;
+    }
+    return dec->text;
+}
+
+const char *render_codec_status_string(RenderCodecStatusCode status){
+    switch (status) {
+        case RENDER_CODEC_OK:                return "ok";
+        case RENDER_CODEC_INVALID_ARGUMENT:  return "invalid argument";
+        case RENDER_CODEC_ALLOCATION_FAILED: return "allocation failed";
+        case RENDER_CODEC_CORRUPT:           return "frame is corrupt";
+        case RENDER_CODEC_NEED_KEYFRAME:     return "delta frame needs a key frame first";
+    }
+    return "unknown status";
+}
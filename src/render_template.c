@@ -0,0 +1,251 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memory_account.h"
+#include "render_template.h"
+#include "room.h"
+
+#define BUCKETS 256             // hash buckets; a power of two
+
+typedef struct Template {
+    int width, height;
+    unsigned mask;
+    size_t size;                // bytes in `text`
+    atomic_bool referenced;     // CLOCK bit, set on every hit
+    struct Template *next;      // bucket chain
+    char text[];
+} Template;
+
+struct TemplateCache {
+    pthread_rwlock_t lock;      // shared for lookups, exclusive for insert and evict
+    Template *buckets[BUCKETS];
+    Template **ring;            // every entry, in CLOCK order
+    size_t count;
+    size_t ring_cap;
+    size_t hand;
+    size_t bytes;
+    size_t limit;
+    MemoryAccount *memory;      // charged for everything the cache allocates, whichever thread renders
+
+    atomic_uint_fast64_t hits;
+    atomic_uint_fast64_t misses;
+    atomic_uint_fast64_t bypassed;
+    atomic_uint_fast64_t evictions;
+};
+
+// Sets one bit per wall whose door sits where the generator puts doors.
+static bool door_mask(const Room *room, unsigned *mask){
+    const int w = room->width;
+    const int h = room->height;
+    *mask = 0;
+    for (int i = 0; i < room->num_doors; i++) {
+        const Door *d = &room->doors[i];
+        if (d->y == 0 && d->x == w / 2) {
+            *mask |= 1u << DIR_NORTH;
+        } else if (d->y == h - 1 && d->x == w / 2) {
+            *mask |= 1u << DIR_SOUTH;
+        } else if (d->x == w - 1 && d->y == h / 2) {
+            *mask |= 1u << DIR_EAST;
+        } else if (d->x == 0 && d->y == h / 2) {
+            *mask |= 1u << DIR_WEST;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t bucket_of(int width, int height, unsigned mask){
+    uint32_t h = (uint32_t)width * 0x9e3779b1u ^ (uint32_t)height * 0x85ebca77u ^ mask;
+    return (h ^ (h >> 16)) & (BUCKETS - 1);
+}
+
+// Draws walls, floor, doors, row newlines and the NUL a whole row at a time.
+static void build_background(int w, int h, unsigned mask, char *buf){
+    const size_t stride = (size_t)w + 1;
+    for (int y = 0; y < h; y++) {
+        char *row = buf + (size_t)y * stride;
+        if (y == 0 || y == h - 1 || w <= 2) {
+            memset(row, TILE_WALL, (size_t)w);
+        } else {
+            row[0] = TILE_WALL;
+            memset(row + 1, TILE_FLOOR, (size_t)w - 2);
+            row[w - 1] = TILE_WALL;
+        }
+        row[w] = '\n';
+    }
+    if (mask & (1u << DIR_NORTH)) buf[w / 2] = TILE_DOOR;
+    if (mask & (1u << DIR_SOUTH)) buf[(size_t)(h - 1) * stride + w / 2] = TILE_DOOR;
+    if (mask & (1u << DIR_EAST))  buf[(size_t)(h / 2) * stride + w - 1] = TILE_DOOR;
+    if (mask & (1u << DIR_WEST))  buf[(size_t)(h / 2) * stride] = TILE_DOOR;
+    buf[stride * (size_t)h] = '\0';
+}
+
+TemplateCache *template_cache_create(size_t max_bytes){
+    TemplateCache *cache = mem_calloc(MEM_RENDER, 1, sizeof(TemplateCache));
+    if (cache == NULL) {
+        return NULL;
+    }
+    if (pthread_rwlock_init(&cache->lock, NULL) != 0) {
+        mem_free(MEM_RENDER, cache, sizeof(TemplateCache));
+        return NULL;
+    }
+    cache->limit = max_bytes;
+    cache->memory = mem_account_current();
+    atomic_init(&cache->hits, 0);
+    atomic_init(&cache->misses, 0);
+    atomic_init(&cache->bypassed, 0);
+    atomic_init(&cache->evictions, 0);
+    return cache;
+}
+
+void template_cache_destroy(TemplateCache *cache){
+    if (cache == NULL) {
+        return;
+    }
+    MemoryAccount *previous = mem_account_enter(cache->memory);
+    for (size_t i = 0; i < cache->count; i++) {
+        mem_free(MEM_RENDER, cache->ring[i], sizeof(Template) + cache->ring[i]->size);
+    }
+    mem_free(MEM_RENDER, cache->ring, cache->ring_cap * sizeof(Template *));
+    pthread_rwlock_destroy(&cache->lock);
+    mem_free(MEM_RENDER, cache, sizeof(TemplateCache));
+    mem_account_enter(previous);
+}
+
+// Drops the entry under the CLOCK hand, giving recently hit entries a second chance.
+// Exclusive lock held and the cache's account entered.
+static void evict_one(TemplateCache *cache){
+    for (;;) {
+        if (cache->hand >= cache->count) {
+            cache->hand = 0;
+        }
+        Template *t = cache->ring[cache->hand];
+        if (atomic_exchange_explicit(&t->referenced, false, memory_order_relaxed)) {
+            cache->hand++;
+            continue;
+        }
+        Template **link = &cache->buckets[bucket_of(t->width, t->height, t->mask)];
+        while (*link != t) {
+            link = &(*link)->next;
+        }
+        *link = t->next;
+        cache->ring[cache->hand] = cache->ring[--cache->count];
+        cache->bytes -= t->size;
+        mem_free(MEM_RENDER, t, sizeof(Template) + t->size);
+        atomic_fetch_add_explicit(&cache->evictions, 1, memory_order_relaxed);
+        return;
+    }
+}
+
+void template_cache_set_limit(TemplateCache *cache, size_t max_bytes){
+    if (cache == NULL) {
+        return;
+    }
+    MemoryAccount *previous = mem_account_enter(cache->memory);
+    pthread_rwlock_wrlock(&cache->lock);
+    cache->limit = max_bytes;
+    while (cache->bytes > cache->limit) {
+        evict_one(cache);
+    }
+    pthread_rwlock_unlock(&cache->lock);
+    mem_account_enter(previous);
+}
+
+static Template *find(TemplateCache *cache, size_t bucket, int width, int height, unsigned mask){
+    for (Template *t = cache->buckets[bucket]; t != NULL; t = t->next) {
+        if (t->width == width && t->height == height && t->mask == mask) {
+            return t;
+        }
+    }
+    return NULL;
+}
+
+// Caches a copy of a freshly built background unless another thread got there first.
+// Also skips it if the memory account's budget has no room. Cache's account entered.
+static void insert(TemplateCache *cache, size_t bucket, int width, int height, unsigned mask,
+                   const char *text, size_t size){
+    pthread_rwlock_wrlock(&cache->lock);
+    if (size > cache->limit || find(cache, bucket, width, height, mask) != NULL) {
+        pthread_rwlock_unlock(&cache->lock);
+        return;
+    }
+    while (cache->bytes + size > cache->limit) {
+        evict_one(cache);
+    }
+    if (cache->count == cache->ring_cap) {
+        size_t cap = cache->ring_cap ? cache->ring_cap * 2 : 16;
+        Template **grown = mem_realloc(MEM_RENDER, cache->ring, cache->ring_cap * sizeof(Template *),
+                                       cap * sizeof(Template *));
+        if (grown == NULL) {
+            pthread_rwlock_unlock(&cache->lock);
+            return;
+        }
+        cache->ring = grown;
+        cache->ring_cap = cap;
+    }
+    Template *t = mem_alloc(MEM_RENDER, sizeof(Template) + size);
+    if (t == NULL) {
+        pthread_rwlock_unlock(&cache->lock);
+        return;
+    }
+    t->width = width;
+    t->height = height;
+    t->mask = mask;
+    t->size = size;
+    atomic_init(&t->referenced, false);
+    memcpy(t->text, text, size);
+    t->next = cache->buckets[bucket];
+    cache->buckets[bucket] = t;
+    cache->ring[cache->count++] = t;
+    cache->bytes += size;
+    pthread_rwlock_unlock(&cache->lock);
+}
+
+bool template_cache_render(TemplateCache *cache, const Room *room, char *buf){
+    unsigned mask;
+    if (cache == NULL || room->width < 1 || room->height < 1 || !door_mask(room, &mask)) {
+        if (cache != NULL) {
+            atomic_fetch_add_explicit(&cache->bypassed, 1, memory_order_relaxed);
+        }
+        return false;
+    }
+    size_t bucket = bucket_of(room->width, room->height, mask);
+
+    pthread_rwlock_rdlock(&cache->lock);
+    Template *t = find(cache, bucket, room->width, room->height, mask);
+    if (t != NULL) {
+        memcpy(buf, t->text, t->size);
+        if (!atomic_load_explicit(&t->referenced, memory_order_relaxed)) {
+            atomic_store_explicit(&t->referenced, true, memory_order_relaxed);
+        }
+        pthread_rwlock_unlock(&cache->lock);
+        atomic_fetch_add_explicit(&cache->hits, 1, memory_order_relaxed);
+        return true;
+    }
+    pthread_rwlock_unlock(&cache->lock);
+
+    atomic_fetch_add_explicit(&cache->misses, 1, memory_order_relaxed);
+    build_background(room->width, room->height, mask, buf);
+    MemoryAccount *previous = mem_account_enter(cache->memory);
+    insert(cache, bucket, room->width, room->height, mask, buf,
+           ((size_t)room->width + 1) * (size_t)room->height + 1);
+    mem_account_enter(previous);
+    return true;
+}
+
+void template_cache_stats(TemplateCache *cache, TemplateCacheStats *out){
+    if (cache == NULL || out == NULL) {
+        return;
+    }
+    out->hits = atomic_load_explicit(&cache->hits, memory_order_relaxed);
+    out->misses = atomic_load_explicit(&cache->misses, memory_order_relaxed);
+    out->bypassed = atomic_load_explicit(&cache->bypassed, memory_order_relaxed);
+    out->evictions = atomic_load_explicit(&cache->evictions, memory_order_relaxed);
+    pthread_rwlock_rdlock(&cache->lock);
+    out->entries = cache->count;
+    out->bytes = cache->bytes;
+    out->limit = cache->limit;
+    pthread_rwlock_unlock(&cache->lock);
+}
@@ -1,4 +1,8 @@
-include "room.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memory_account.h"
+#include "room.h"
 
 /**
  * This module defines operations on Room structures.
@@ -27,6 +31,13 @@ int compare_rooms(const void *a, const void *b){
     return room_a->id - room_b->id;
 }
 
+/**
+ * Returns the ID of a Room as a search key for frozen trees.
+ */
+long long room_key(const void *data){
+    return ((const Room *)data)->id;
+}
+
 /**
  * Creates a deep copy of a Room.
  *
@@ -42,7 +53,7 @@ void *copy_room(void *data){
         return NULL;
     }
 
-    Room *copy = malloc(sizeof(Room));
+    Room *copy = mem_alloc(MEM_ROOMS, sizeof(Room));
     if (copy == NULL) {
         return NULL;
     }
@@ -51,13 +62,17 @@ void *copy_room(void *data){
     copy->id = original->id;
     copy->width = original->width;
     copy->height = original->height;
+    memcpy(copy->neighbor_ids, original->neighbor_ids, sizeof(copy->neighbor_ids));
+    copy->is_start = original->is_start;
+    copy->is_exit = original->is_exit;
+    copy->grid_placement = original->grid_placement;
 
     // Copy monsters
     copy->num_monsters = original->num_monsters;
     if (copy->num_monsters > 0) {
-        copy->monsters = malloc(copy->num_monsters * sizeof(Monster));
+        copy->monsters = mem_alloc(MEM_ENTITIES, copy->num_monsters * sizeof(Monster));
         if (copy->monsters == NULL) {
-            free(copy);
+            mem_free(MEM_ROOMS, copy, sizeof(Room));
             return NULL;
         }
         memcpy(copy->monsters, original->monsters, copy->num_monsters * sizeof(Monster));
@@ -68,10 +83,10 @@ void *copy_room(void *data){
     // Copy items
     copy->num_items = original->num_items;
     if (copy->num_items > 0) {
-        copy->items = malloc(copy->num_items * sizeof(Item));
+        copy->items = mem_alloc(MEM_ENTITIES, copy->num_items * sizeof(Item));
         if (copy->items == NULL) {
-            free(copy->monsters);
-            free(copy);
+            mem_free(MEM_ENTITIES, copy->monsters, copy->num_monsters * sizeof(Monster));
+            mem_free(MEM_ROOMS, copy, sizeof(Room));
             return NULL;
         }
         memcpy(copy->items, original->items, copy->num_items * sizeof(Item));
@@ -82,11 +97,11 @@ void *copy_room(void *data){
     // Copy doors
     copy->num_doors = original->num_doors;
     if (copy->num_doors > 0) {
-        copy->doors = malloc(copy->num_doors * sizeof(Door));
+        copy->doors = mem_alloc(MEM_ENTITIES, copy->num_doors * sizeof(Door));
         if (copy->doors == NULL) {
-            free(copy->items);
-            free(copy->monsters);
-            free(copy);
+            mem_free(MEM_ENTITIES, copy->items, copy->num_items * sizeof(Item));
+            mem_free(MEM_ENTITIES, copy->monsters, copy->num_monsters * sizeof(Monster));
+            mem_free(MEM_ROOMS, copy, sizeof(Room));
             return NULL;
         }
         memcpy(copy->doors, original->doors, copy->num_doors * sizeof(Door));
@@ -101,17 +116,19 @@ void *copy_room(void *data){
  * Frees all memory associated with a Room.
  *
  * This includes the Room itself and any dynamically allocated arrays
- * of monsters, items, and doors.
+ * of monsters, items, and doors. Each array is expected to hold exactly
+ * its count of entries, as copy_room and the generator leave them, so the
+ * bytes can be credited back to the current memory account.
  *
  * @param data Pointer to the Room to destroy (as void*)
  */
 void destroy_room(void *data){
     Room *room = (Room *)data;
     if (room != NULL) {
-        free(room->monsters);
-        free(room->items);
-        free(room->doors);
-        free(room);
+        mem_free(MEM_ENTITIES, room->monsters, (size_t)room->num_monsters * sizeof(Monster));
+        mem_free(MEM_ENTITIES, room->items, (size_t)room->num_items * sizeof(Item));
+        mem_free(MEM_ENTITIES, room->doors, (size_t)room->num_doors * sizeof(Door));
+        mem_free(MEM_ROOMS, room, sizeof(Room));
     }
 }
 
@@ -123,7 +140,14 @@ void destroy_room(void *data){
  * @param data Pointer to the Room to print (as void*)
  */
 void print_room(const void *data){
-    return;
+    const Room *room = (const Room *)data;
+    if (room == NULL) {
+        return;
+    }
+    printf("Room %d (%dx%d) monsters=%d items=%d doors=%d%s%s\n",
+           room->id, room->width, room->height,
+           room->num_monsters, room->num_items, room->num_doors,
+           room->is_start ? " [start]" : "", room->is_exit ? " [exit]" : "");
 } // Optional debug
 
 /**
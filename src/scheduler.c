@@ -0,0 +1,304 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include "scheduler.h"
+#include "thread_pool.h"
+
+#define SESSION_BATCH 32        // commands a worker runs for one controller before yielding
+#define LATENCY_BUCKETS 64      // bucket b holds latencies in [2^b, 2^(b+1)) ns
+
+typedef struct CommandNode {
+    SchedulerCommand cmd;
+    uint64_t submit_ns;
+    struct CommandNode *next;
+} CommandNode;
+
+typedef struct {
+    Scheduler *sched;
+    size_t index;
+    Controller *ctrl;
+
+    pthread_mutex_t lock;       // guards the mailbox and `scheduled`
+    CommandNode *head;
+    CommandNode *tail;
+    bool scheduled;             // a pool task currently owns this session
+
+    atomic_uint_fast64_t submitted;
+    atomic_uint_fast64_t completed;
+    atomic_size_t depth;
+    atomic_size_t max_depth;
+    atomic_uint_fast64_t latency_sum;
+    atomic_uint_fast64_t latency_max;
+    atomic_uint_fast64_t latency_hist[LATENCY_BUCKETS];
+} Session;
+
+struct Scheduler {
+    ThreadPool *pool;
+    Session *sessions;
+    size_t count;
+};
+
+static uint64_t now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static int latency_bucket(uint64_t ns){
+    int b = 0;
+    while (ns > 1 && b < LATENCY_BUCKETS - 1) {
+        ns >>= 1;
+        b++;
+    }
+    return b;
+}
+
+static void atomic_max_u64(atomic_uint_fast64_t *slot, uint64_t value){
+    uint_fast64_t seen = atomic_load_explicit(slot, memory_order_relaxed);
+    while (seen < value &&
+           !atomic_compare_exchange_weak_explicit(slot, &seen, value,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static void atomic_max_size(atomic_size_t *slot, size_t value){
+    size_t seen = atomic_load_explicit(slot, memory_order_relaxed);
+    while (seen < value &&
+           !atomic_compare_exchange_weak_explicit(slot, &seen, value,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static void execute(Session *s, const CommandNode *node){
+    const SchedulerCommand *cmd = &node->cmd;
+    SchedulerResult result = {0};
+    result.controller_index = s->index;
+    result.type = cmd->type;
+
+    switch (cmd->type) {
+        case SCHED_MOVE_WITHIN_ROOM:
+            result.status = move_player_within_room(s->ctrl, cmd->dx, cmd->dy);
+            break;
+        case SCHED_MOVE_DIRECTION:
+            result.status = move_player_direction(s->ctrl, cmd->dir);
+            break;
+        case SCHED_RENDER_CURRENT:
+            result.status = render_current_room(s->ctrl, &result.render);
+            break;
+        case SCHED_RENDER_ROOM:
+            result.status = render_room_by_id(s->ctrl, cmd->room_id, &result.render);
+            break;
+        case SCHED_GET_VISITED:
+            result.status = get_visited_room_ids(s->ctrl, &result.visited_ids, &result.visited_count);
+            break;
+        case SCHED_TICK:
+            result.status = controller_tick(s->ctrl);
+            break;
+        default:
+            result.status = CONTROLLER_INVALID_ARGUMENT;
+            break;
+    }
+
+    uint64_t latency = now_ns() - node->submit_ns;
+    result.latency_ns = latency;
+    atomic_fetch_add_explicit(&s->latency_sum, latency, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->latency_hist[latency_bucket(latency)], 1, memory_order_relaxed);
+    atomic_max_u64(&s->latency_max, latency);
+
+    if (cmd->on_complete) {
+        cmd->on_complete(&result, cmd->user_data);
+    } else {
+        free(result.render);
+        free(result.visited_ids);
+    }
+    atomic_fetch_add_explicit(&s->completed, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&s->depth, 1, memory_order_relaxed);
+}
+
+// Pool task: drains up to SESSION_BATCH commands in order, then requeues itself so
+// one busy controller cannot starve the others.
+static void run_session(void *arg){
+    Session *s = arg;
+
+    for (;;) {
+        for (int n = 0; n < SESSION_BATCH; n++) {
+            pthread_mutex_lock(&s->lock);
+            CommandNode *node = s->head;
+            if (node == NULL) {
+                s->scheduled = false;
+                pthread_mutex_unlock(&s->lock);
+                return;
+            }
+            s->head = node->next;
+            if (s->head == NULL) s->tail = NULL;
+            pthread_mutex_unlock(&s->lock);
+
+            execute(s, node);
+            free(node);
+        }
+        if (thread_pool_submit(s->sched->pool, run_session, s) == POOL_OK) {
+            return;
+        }
+        // Could not requeue; keep ownership and carry on draining here.
+    }
+}
+
+Scheduler *scheduler_create(Controller **controllers, size_t count, int num_workers){
+    if (controllers == NULL || count == 0) {
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (controllers[i] == NULL) return NULL;
+    }
+
+    Scheduler *sched = calloc(1, sizeof(Scheduler));
+    if (sched == NULL) {
+        return NULL;
+    }
+    sched->sessions = calloc(count, sizeof(Session));
+    if (sched->sessions == NULL) {
+        free(sched);
+        return NULL;
+    }
+    sched->pool = thread_pool_create(num_workers);
+    if (sched->pool == NULL) {
+        free(sched->sessions);
+        free(sched);
+        return NULL;
+    }
+
+    sched->count = count;
+    for (size_t i = 0; i < count; i++) {
+        Session *s = &sched->sessions[i];
+        s->sched = sched;
+        s->index = i;
+        s->ctrl = controllers[i];
+        pthread_mutex_init(&s->lock, NULL);
+    }
+    return sched;
+}
+
+void scheduler_destroy(Scheduler *sched){
+    if (sched == NULL) {
+        return;
+    }
+    thread_pool_destroy(sched->pool);
+    for (size_t i = 0; i < sched->count; i++) {
+        Session *s = &sched->sessions[i];
+        pthread_mutex_destroy(&s->lock);
+        controller_free(s->ctrl);
+    }
+    free(sched->sessions);
+    free(sched);
+}
+
+ControllerStatusCode scheduler_submit(Scheduler *sched, size_t index, const SchedulerCommand *cmd){
+    if (sched == NULL || cmd == NULL || index >= sched->count ||
+        cmd->type < SCHED_MOVE_WITHIN_ROOM || cmd->type > SCHED_TICK) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+
+    CommandNode *node = malloc(sizeof(CommandNode));
+    if (node == NULL) {
+        return CONTROLLER_ALLOCATION_FAILED;
+    }
+    node->cmd = *cmd;
+    node->submit_ns = now_ns();
+    node->next = NULL;
+
+    Session *s = &sched->sessions[index];
+    pthread_mutex_lock(&s->lock);
+    // Claim a pool task before the command becomes visible, so a failed submit
+    // leaves the mailbox and the counters exactly as they were. A worker that
+    // picks the task up right away waits on the lock until the node is linked.
+    if (!s->scheduled) {
+        if (thread_pool_submit(sched->pool, run_session, s) != POOL_OK) {
+            pthread_mutex_unlock(&s->lock);
+            free(node);
+            return CONTROLLER_ALLOCATION_FAILED;
+        }
+        s->scheduled = true;
+    }
+    if (s->tail) {
+        s->tail->next = node;
+    } else {
+        s->head = node;
+    }
+    s->tail = node;
+    // Counted under the lock so no worker can complete the command first.
+    atomic_fetch_add_explicit(&s->submitted, 1, memory_order_relaxed);
+    size_t depth = atomic_fetch_add_explicit(&s->depth, 1, memory_order_relaxed) + 1;
+    atomic_max_size(&s->max_depth, depth);
+    pthread_mutex_unlock(&s->lock);
+    return CONTROLLER_OK;
+}
+
+void scheduler_drain(Scheduler *sched){
+    if (sched != NULL) {
+        thread_pool_wait(sched->pool);
+    }
+}
+
+size_t scheduler_count(const Scheduler *sched){
+    return sched ? sched->count : 0;
+}
+
+const Controller *scheduler_controller(const Scheduler *sched, size_t index){
+    if (sched == NULL || index >= sched->count) {
+        return NULL;
+    }
+    return sched->sessions[index].ctrl;
+}
+
+static uint64_t hist_percentile(const uint64_t *hist, uint64_t total, double pct){
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(pct * (double)total);
+    if (rank >= total) rank = total - 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += hist[b];
+        if (seen > rank) {
+            return b >= 63 ? UINT64_MAX : ((uint64_t)2 << b) - 1;
+        }
+    }
+    return UINT64_MAX;
+}
+
+ControllerStatusCode scheduler_get_stats(const Scheduler *sched, size_t index, SchedulerStats *out){
+    if (sched == NULL || out == NULL || (index != SCHEDULER_ALL && index >= sched->count)) {
+        return CONTROLLER_INVALID_ARGUMENT;
+    }
+
+    size_t first = index == SCHEDULER_ALL ? 0 : index;
+    size_t last = index == SCHEDULER_ALL ? sched->count : index + 1;
+    uint64_t hist[LATENCY_BUCKETS] = {0};
+    uint64_t latency_sum = 0;
+    SchedulerStats st = {0};
+
+    for (size_t i = first; i < last; i++) {
+        Session *s = &sched->sessions[i];
+        st.submitted += atomic_load_explicit(&s->submitted, memory_order_relaxed);
+        st.completed += atomic_load_explicit(&s->completed, memory_order_relaxed);
+        st.queue_depth += atomic_load_explicit(&s->depth, memory_order_relaxed);
+        size_t max_depth = atomic_load_explicit(&s->max_depth, memory_order_relaxed);
+        if (max_depth > st.max_queue_depth) st.max_queue_depth = max_depth;
+        latency_sum += atomic_load_explicit(&s->latency_sum, memory_order_relaxed);
+        uint64_t lmax = atomic_load_explicit(&s->latency_max, memory_order_relaxed);
+        if (lmax > st.latency_max_ns) st.latency_max_ns = lmax;
+        for (int b = 0; b < LATENCY_BUCKETS; b++) {
+            hist[b] += atomic_load_explicit(&s->latency_hist[b], memory_order_relaxed);
+        }
+    }
+
+    uint64_t samples = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) samples += hist[b];
+    st.latency_mean_ns = samples ? latency_sum / samples : 0;
+    st.latency_p50_ns = hist_percentile(hist, samples, 0.50);
+    st.latency_p99_ns = hist_percentile(hist, samples, 0.99);
+    if (st.latency_p50_ns > st.latency_max_ns) st.latency_p50_ns = st.latency_max_ns;
+    if (st.latency_p99_ns > st.latency_max_ns) st.latency_p99_ns = st.latency_max_ns;
+
+    *out = st;
+    return CONTROLLER_OK;
+}
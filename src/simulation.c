@@ -0,0 +1,322 @@
+#include <stdlib.h>
+#include <string.h>
+#include "memory_account.h"
+#include "simulation.h"
+
+// A monster's patrol: it walks lo..hi..lo along its row, one tile per tick.
+typedef struct {
+    int lo, hi;
+    int phase;                  // 0 <= phase < period; position is lane_position(lane)
+} Lane;
+
+struct Simulation {
+    int num_ids;                // max_room_id + 1
+    Room **rooms;               // by ID; NULL where the tree has no such room
+    int *lane_start;            // by ID; index of the room's first lane in `lanes`
+    Lane *lanes;                // one per monster, in room then monster order
+    size_t num_lanes;
+    uint64_t *last_tick;        // by ID; tick the room has been simulated up to
+
+    uint64_t tick;
+    int radius;
+    int center;                 // room the active set was built around, -1 if stale
+    int *active;                // rooms within `radius` hops of `center`
+    size_t active_count;
+    int *hops;                  // by ID; BFS distance while building the active set
+    uint64_t *mark;             // by ID; == generation when the room is in the active set
+    uint64_t generation;
+};
+
+static int lane_period(const Lane *lane){
+    return 2 * (lane->hi - lane->lo);
+}
+
+static int lane_position(const Lane *lane, int phase){
+    int span = lane->hi - lane->lo;
+    return phase <= span ? lane->lo + phase : lane->lo + 2 * span - phase;
+}
+
+// Builds the lane of monster `m` in `room`; see simulation.h for the rules.
+static Lane make_lane(const Room *room, int m){
+    const Monster *self = &room->monsters[m];
+    int x0 = self->x;
+    int y0 = self->y;
+    Lane lane = { x0, x0, 0 };
+    if (x0 < 1 || x0 > room->width - 2 || y0 < 1 || y0 > room->height - 2) {
+        return lane;            // on or outside the wall: never moves
+    }
+
+    int lo = 1;
+    int hi = room->width - 2;
+    for (int i = 0; i < room->num_items; i++) {
+        const Item *it = &room->items[i];
+        if (it->y != y0) continue;
+        if (it->x < x0 && it->x + 1 > lo) lo = it->x + 1;
+        if (it->x > x0 && it->x - 1 < hi) hi = it->x - 1;
+        if (it->x == x0) return lane;
+    }
+    // Split the gap to each neighbouring monster; the right-hand one gets the odd tile.
+    for (int i = 0; i < room->num_monsters; i++) {
+        const Monster *other = &room->monsters[i];
+        if (i == m || other->y != y0) continue;
+        if (other->x == x0) return lane;
+        int gap = other->x < x0 ? x0 - other->x - 1 : other->x - x0 - 1;
+        if (other->x < x0 && other->x + 1 + gap / 2 > lo) lo = other->x + 1 + gap / 2;
+        if (other->x > x0 && x0 + gap / 2 < hi) hi = x0 + gap / 2;
+    }
+    lane.lo = lo;
+    lane.hi = hi;
+    lane.phase = x0 - lo;       // start at the spawn tile, heading east
+    return lane;
+}
+
+static int player_in(const Player *player, const Room *room){
+    return player != NULL && player->current_room == room;
+}
+
+// Advances every lane of room `id` by `ticks` in closed form.
+static void fast_forward(Simulation *sim, int id, uint64_t ticks, const Player *player){
+    Room *room = sim->rooms[id];
+    Lane *lanes = sim->lanes + sim->lane_start[id];
+    for (int i = 0; i < room->num_monsters; i++) {
+        Lane *lane = &lanes[i];
+        int period = lane_period(lane);
+        if (period == 0) continue;
+        lane->phase = (int)(((uint64_t)lane->phase + ticks % (uint64_t)period) % (uint64_t)period);
+        // The player can only be in the way if they entered without a catch-up; step past them.
+        for (int k = 0; k < period && player_in(player, room) &&
+                        lane_position(lane, lane->phase) == player->tile_x &&
+                        room->monsters[i].y == player->tile_y; k++) {
+            lane->phase = (lane->phase + 1) % period;
+        }
+        room->monsters[i].x = lane_position(lane, lane->phase);
+    }
+}
+
+// Advances room `id` by exactly one tick; monsters wait rather than walk into the player.
+static void step_room(Simulation *sim, int id, const Player *player){
+    Room *room = sim->rooms[id];
+    Lane *lanes = sim->lanes + sim->lane_start[id];
+    int has_player = player_in(player, room);
+    for (int i = 0; i < room->num_monsters; i++) {
+        Lane *lane = &lanes[i];
+        int period = lane_period(lane);
+        if (period == 0) continue;
+        int next = (lane->phase + 1) % period;
+        int nx = lane_position(lane, next);
+        if (has_player && nx == player->tile_x && room->monsters[i].y == player->tile_y) {
+            continue;
+        }
+        lane->phase = next;
+        room->monsters[i].x = nx;
+    }
+    sim->last_tick[id] = sim->tick + 1;
+}
+
+// Breadth-first walk over neighbor_ids, at most `radius` hops from `center`.
+static void rebuild_active(Simulation *sim, int center){
+    sim->generation++;
+    sim->active_count = 0;
+    sim->center = center;
+    if (center < 0 || center >= sim->num_ids || sim->rooms[center] == NULL) {
+        return;
+    }
+    sim->active[sim->active_count++] = center;
+    sim->mark[center] = sim->generation;
+    sim->hops[center] = 0;
+    for (size_t head = 0; head < sim->active_count; head++) {
+        int id = sim->active[head];
+        if (sim->hops[id] >= sim->radius) continue;
+        const Room *room = sim->rooms[id];
+        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+            int n = room->neighbor_ids[d];
+            if (n < 0 || n >= sim->num_ids || sim->rooms[n] == NULL ||
+                sim->mark[n] == sim->generation) {
+                continue;
+            }
+            sim->mark[n] = sim->generation;
+            sim->hops[n] = sim->hops[id] + 1;
+            sim->active[sim->active_count++] = n;
+        }
+    }
+}
+
+static size_t lanes_bytes(const Simulation *sim){
+    return (sim->num_lanes > 0 ? sim->num_lanes : 1) * sizeof(Lane);
+}
+
+Simulation *simulation_create(Tree *room_tree, int max_room_id, int radius){
+    if (room_tree == NULL || max_room_id < 0 || radius < 0) {
+        return NULL;
+    }
+    Simulation *sim = mem_calloc(MEM_INDEXES, 1, sizeof(Simulation));
+    if (sim == NULL) {
+        return NULL;
+    }
+    size_t n = (size_t)max_room_id + 1;
+    sim->num_ids = max_room_id + 1;
+    sim->radius = radius;
+    sim->center = -1;
+    sim->rooms = mem_calloc(MEM_INDEXES, n, sizeof(Room *));
+    sim->lane_start = mem_calloc(MEM_INDEXES, n, sizeof(int));
+    sim->last_tick = mem_calloc(MEM_INDEXES, n, sizeof(uint64_t));
+    sim->active = mem_alloc(MEM_INDEXES, n * sizeof(int));
+    sim->hops = mem_alloc(MEM_INDEXES, n * sizeof(int));
+    sim->mark = mem_calloc(MEM_INDEXES, n, sizeof(uint64_t));
+    if (!sim->rooms || !sim->lane_start || !sim->last_tick || !sim->active ||
+        !sim->hops || !sim->mark) {
+        simulation_destroy(sim);
+        return NULL;
+    }
+
+    size_t total = 0;
+    TreeIterator *iter = createIterator(room_tree);
+    if (iter == NULL) {
+        simulation_destroy(sim);
+        return NULL;
+    }
+    for (Room *r = nextData(iter); r != NULL; r = nextData(iter)) {
+        if (r->id < 0 || r->id > max_room_id) continue;
+        sim->rooms[r->id] = r;
+        sim->lane_start[r->id] = (int)total;
+        total += (size_t)r->num_monsters;
+    }
+    destroyIterator(iter);
+
+    sim->num_lanes = total;
+    sim->lanes = mem_alloc(MEM_INDEXES, lanes_bytes(sim));
+    if (sim->lanes == NULL) {
+        simulation_destroy(sim);
+        return NULL;
+    }
+    for (int id = 0; id < sim->num_ids; id++) {
+        const Room *room = sim->rooms[id];
+        if (room == NULL) continue;
+        for (int i = 0; i < room->num_monsters; i++) {
+            sim->lanes[sim->lane_start[id] + i] = make_lane(room, i);
+        }
+    }
+    return sim;
+}
+
+void simulation_destroy(Simulation *sim){
+    if (sim == NULL) {
+        return;
+    }
+    size_t n = (size_t)sim->num_ids;
+    mem_free(MEM_INDEXES, sim->rooms, n * sizeof(Room *));
+    mem_free(MEM_INDEXES, sim->lane_start, n * sizeof(int));
+    mem_free(MEM_INDEXES, sim->lanes, lanes_bytes(sim));
+    mem_free(MEM_INDEXES, sim->last_tick, n * sizeof(uint64_t));
+    mem_free(MEM_INDEXES, sim->active, n * sizeof(int));
+    mem_free(MEM_INDEXES, sim->hops, n * sizeof(int));
+    mem_free(MEM_INDEXES, sim->mark, n * sizeof(uint64_t));
+    mem_free(MEM_INDEXES, sim, sizeof(Simulation));
+}
+
+int simulation_set_radius(Simulation *sim, int radius){
+    if (sim == NULL || radius < 0) {
+        return -1;
+    }
+    if (radius != sim->radius) {
+        sim->radius = radius;
+        sim->center = -1;
+    }
+    return 0;
+}
+
+void simulation_catch_up(Simulation *sim, int room_id, const Player *player){
+    if (sim == NULL || room_id < 0 || room_id >= sim->num_ids || sim->rooms[room_id] == NULL) {
+        return;
+    }
+    uint64_t behind = sim->tick - sim->last_tick[room_id];
+    if (behind > 0) {
+        fast_forward(sim, room_id, behind, player);
+        sim->last_tick[room_id] = sim->tick;
+    }
+}
+
+void simulation_step(Simulation *sim, const Player *player){
+    if (sim == NULL || player == NULL || player->current_room == NULL) {
+        return;
+    }
+    int center = player->current_room->id;
+    if (center != sim->center) {
+        rebuild_active(sim, center);
+    }
+    // Rooms that just came into range are fast-forwarded before their first live tick.
+    for (size_t i = 0; i < sim->active_count; i++) {
+        int id = sim->active[i];
+        simulation_catch_up(sim, id, player);
+        step_room(sim, id, player);
+    }
+    sim->tick++;
+}
+
+// Saved layout: tick, last_tick[num_ids], then one int phase per lane.
+size_t simulation_state_size(const Simulation *sim){
+    if (sim == NULL) {
+        return 0;
+    }
+    return sizeof(uint64_t) * (1 + (size_t)sim->num_ids) + sizeof(int) * sim->num_lanes;
+}
+
+void simulation_save_state(const Simulation *sim, void *out){
+    if (sim == NULL || out == NULL) {
+        return;
+    }
+    unsigned char *p = out;
+    memcpy(p, &sim->tick, sizeof(uint64_t));
+    p += sizeof(uint64_t);
+    memcpy(p, sim->last_tick, sizeof(uint64_t) * (size_t)sim->num_ids);
+    p += sizeof(uint64_t) * (size_t)sim->num_ids;
+    for (size_t i = 0; i < sim->num_lanes; i++, p += sizeof(int)) {
+        memcpy(p, &sim->lanes[i].phase, sizeof(int));
+    }
+}
+
+int simulation_load_state(Simulation *sim, const void *state, size_t size){
+    if (sim == NULL || state == NULL || size != simulation_state_size(sim)) {
+        return -1;
+    }
+    const unsigned char *p = state;
+    const unsigned char *phases = p + sizeof(uint64_t) * (1 + (size_t)sim->num_ids);
+    for (size_t i = 0; i < sim->num_lanes; i++) {
+        int phase;
+        memcpy(&phase, phases + i * sizeof(int), sizeof(int));
+        int period = lane_period(&sim->lanes[i]);
+        if (phase < 0 || (period > 0 ? phase >= period : phase != 0)) {
+            return -1;
+        }
+    }
+
+    memcpy(&sim->tick, p, sizeof(uint64_t));
+    memcpy(sim->last_tick, p + sizeof(uint64_t), sizeof(uint64_t) * (size_t)sim->num_ids);
+    for (int id = 0; id < sim->num_ids; id++) {
+        Room *room = sim->rooms[id];
+        if (room == NULL) continue;
+        for (int i = 0; i < room->num_monsters; i++) {
+            Lane *lane = &sim->lanes[sim->lane_start[id] + i];
+            memcpy(&lane->phase, phases + (size_t)(sim->lane_start[id] + i) * sizeof(int), sizeof(int));
+            room->monsters[i].x = lane_position(lane, lane->phase);
+        }
+    }
+    sim->center = -1;
+    return 0;
+}
+
+uint64_t simulation_tick(const Simulation *sim){
+    return sim != NULL ? sim->tick : 0;
+}
+
+size_t simulation_active_count(const Simulation *sim){
+    return sim != NULL ? sim->active_count : 0;
+}
+
+size_t simulation_active_rooms(const Simulation *sim, const int **ids){
+    if (sim == NULL || ids == NULL) {
+        return 0;
+    }
+    *ids = sim->active;
+    return sim->active_count;
+}
@@ -0,0 +1,294 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "thread_pool.h"
+
+#define DEQUE_INITIAL_CAPACITY 64
+
+typedef struct {
+    PoolTaskFunction fn;
+    void *arg;
+} PoolTask;
+
+// Growable ring buffer; `top` is where thieves take from, `bottom` where the owner works.
+typedef struct {
+    pthread_mutex_t lock;
+    PoolTask *tasks;
+    size_t capacity;
+    size_t top;
+    size_t bottom;
+} TaskDeque;
+
+typedef struct {
+    ThreadPool *pool;
+    int index;
+    pthread_t thread;
+    int started;
+    TaskDeque deque;
+    unsigned rng;                   // victim selection for stealing
+} Worker;
+
+struct ThreadPool {
+    Worker *workers;
+    int num_workers;
+    atomic_uint next_victim;        // round-robin target for external submits
+    atomic_size_t queued;           // tasks sitting in deques
+    atomic_size_t unfinished;       // tasks submitted but not yet completed
+
+    pthread_mutex_t lock;           // guards sleeping/waking only
+    pthread_cond_t work_available;
+    pthread_cond_t all_done;
+    int shutting_down;
+};
+
+// Lets a task's nested submits land on the worker that is running it.
+static _Thread_local Worker *current_worker = NULL;
+
+static int deque_init(TaskDeque *dq){
+    dq->tasks = malloc(DEQUE_INITIAL_CAPACITY * sizeof(PoolTask));
+    if (!dq->tasks) return -1;
+    if (pthread_mutex_init(&dq->lock, NULL) != 0) {
+        free(dq->tasks);
+        return -1;
+    }
+    dq->capacity = DEQUE_INITIAL_CAPACITY;
+    dq->top = dq->bottom = 0;
+    return 0;
+}
+
+static void deque_free(TaskDeque *dq){
+    pthread_mutex_destroy(&dq->lock);
+    free(dq->tasks);
+}
+
+static PoolStatusCode deque_push_bottom(TaskDeque *dq, PoolTask task){
+    pthread_mutex_lock(&dq->lock);
+    if (dq->bottom - dq->top == dq->capacity) {
+        size_t new_capacity = dq->capacity * 2;
+        PoolTask *grown = malloc(new_capacity * sizeof(PoolTask));
+        if (!grown) {
+            pthread_mutex_unlock(&dq->lock);
+            return POOL_ALLOCATION_FAILED;
+        }
+        for (size_t i = dq->top; i < dq->bottom; i++)
+            grown[i - dq->top] = dq->tasks[i % dq->capacity];
+        free(dq->tasks);
+        dq->tasks = grown;
+        dq->bottom -= dq->top;
+        dq->top = 0;
+        dq->capacity = new_capacity;
+    }
+    dq->tasks[dq->bottom % dq->capacity] = task;
+    dq->bottom++;
+    pthread_mutex_unlock(&dq->lock);
+    return POOL_OK;
+}
+
+static int deque_pop_bottom(TaskDeque *dq, PoolTask *out){
+    int found = 0;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->bottom != dq->top) {
+        dq->bottom--;
+        *out = dq->tasks[dq->bottom % dq->capacity];
+        found = 1;
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return found;
+}
+
+static int deque_steal_top(TaskDeque *dq, PoolTask *out){
+    int found = 0;
+    // Thieves back off instead of queueing behind the owner.
+    if (pthread_mutex_trylock(&dq->lock) != 0) return 0;
+    if (dq->bottom != dq->top) {
+        *out = dq->tasks[dq->top % dq->capacity];
+        dq->top++;
+        found = 1;
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return found;
+}
+
+static int find_task(Worker *self, PoolTask *out){
+    ThreadPool *pool = self->pool;
+    if (deque_pop_bottom(&self->deque, out)) return 1;
+
+    // xorshift keeps victims spread out so idle workers do not all hit the same deque.
+    self->rng ^= self->rng << 13;
+    self->rng ^= self->rng >> 17;
+    self->rng ^= self->rng << 5;
+    int start = (int)(self->rng % (unsigned)pool->num_workers);
+    for (int i = 0; i < pool->num_workers; i++) {
+        Worker *victim = &pool->workers[(start + i) % pool->num_workers];
+        if (victim != self && deque_steal_top(&victim->deque, out)) return 1;
+    }
+    return 0;
+}
+
+static void *worker_main(void *arg){
+    Worker *self = arg;
+    ThreadPool *pool = self->pool;
+    current_worker = self;
+
+    for (;;) {
+        PoolTask task;
+        if (find_task(self, &task)) {
+            atomic_fetch_sub(&pool->queued, 1);
+            task.fn(task.arg);
+            if (atomic_fetch_sub(&pool->unfinished, 1) == 1) {
+                pthread_mutex_lock(&pool->lock);
+                pthread_cond_broadcast(&pool->all_done);
+                pthread_mutex_unlock(&pool->lock);
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (atomic_load(&pool->queued) == 0 && !pool->shutting_down)
+            pthread_cond_wait(&pool->work_available, &pool->lock);
+        int stop = pool->shutting_down && atomic_load(&pool->queued) == 0;
+        pthread_mutex_unlock(&pool->lock);
+        if (stop) break;
+    }
+    current_worker = NULL;
+    return NULL;
+}
+
+ThreadPool *thread_pool_create(int num_workers){
+    if (num_workers <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_workers = cpus > 0 ? (int)cpus : 1;
+    }
+
+    ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+    pool->workers = calloc((size_t)num_workers, sizeof(Worker));
+    if (!pool->workers) {
+        free(pool);
+        return NULL;
+    }
+    pool->num_workers = num_workers;
+    if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    if (pthread_cond_init(&pool->work_available, NULL) != 0) {
+        pthread_mutex_destroy(&pool->lock);
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    if (pthread_cond_init(&pool->all_done, NULL) != 0) {
+        pthread_cond_destroy(&pool->work_available);
+        pthread_mutex_destroy(&pool->lock);
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    atomic_init(&pool->next_victim, 0);
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->unfinished, 0);
+
+    for (int i = 0; i < num_workers; i++) {
+        Worker *w = &pool->workers[i];
+        w->pool = pool;
+        w->index = i;
+        w->rng = 2654435761u * (unsigned)(i + 1);
+        if (deque_init(&w->deque) != 0) {
+            for (int j = 0; j < i; j++)
+                deque_free(&pool->workers[j].deque);
+            pthread_cond_destroy(&pool->all_done);
+            pthread_cond_destroy(&pool->work_available);
+            pthread_mutex_destroy(&pool->lock);
+            free(pool->workers);
+            free(pool);
+            return NULL;
+        }
+    }
+    for (int i = 0; i < num_workers; i++) {
+        if (pthread_create(&pool->workers[i].thread, NULL, worker_main, &pool->workers[i]) != 0) {
+            // Only the first i workers are running; stop them and release every deque.
+            pthread_mutex_lock(&pool->lock);
+            pool->shutting_down = 1;
+            pthread_cond_broadcast(&pool->work_available);
+            pthread_mutex_unlock(&pool->lock);
+            for (int j = 0; j < i; j++)
+                pthread_join(pool->workers[j].thread, NULL);
+            for (int j = 0; j < num_workers; j++)
+                deque_free(&pool->workers[j].deque);
+            pthread_cond_destroy(&pool->all_done);
+            pthread_cond_destroy(&pool->work_available);
+            pthread_mutex_destroy(&pool->lock);
+            free(pool->workers);
+            free(pool);
+            return NULL;
+        }
+        pool->workers[i].started = 1;
+    }
+    return pool;
+}
+
+void thread_pool_destroy(ThreadPool *pool){
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutting_down = 1;
+    pthread_cond_broadcast(&pool->work_available);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->num_workers; i++) {
+        if (pool->workers[i].started)
+            pthread_join(pool->workers[i].thread, NULL);
+        deque_free(&pool->workers[i].deque);
+    }
+    pthread_cond_destroy(&pool->all_done);
+    pthread_cond_destroy(&pool->work_available);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+}
+
+PoolStatusCode thread_pool_submit(ThreadPool *pool, PoolTaskFunction fn, void *arg){
+    if (!pool || !fn) return POOL_INVALID_ARGUMENT;
+
+    Worker *target = current_worker;
+    if (!target || target->pool != pool) {
+        // Tasks may keep spawning work while destroy drains the pool; outsiders may not.
+        pthread_mutex_lock(&pool->lock);
+        int closed = pool->shutting_down;
+        pthread_mutex_unlock(&pool->lock);
+        if (closed) return POOL_SHUTDOWN;
+
+        unsigned slot = atomic_fetch_add(&pool->next_victim, 1);
+        target = &pool->workers[slot % (unsigned)pool->num_workers];
+    }
+
+    // Count the task before it becomes visible so thread_pool_wait never sees a false zero.
+    atomic_fetch_add(&pool->unfinished, 1);
+    PoolTask task = { fn, arg };
+    PoolStatusCode status = deque_push_bottom(&target->deque, task);
+    if (status != POOL_OK) {
+        atomic_fetch_sub(&pool->unfinished, 1);
+        return status;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->queued, 1);
+    pthread_cond_signal(&pool->work_available);
+    pthread_mutex_unlock(&pool->lock);
+    return POOL_OK;
+}
+
+void thread_pool_wait(ThreadPool *pool){
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    while (atomic_load(&pool->unfinished) != 0)
+        pthread_cond_wait(&pool->all_done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int thread_pool_size(const ThreadPool *pool){
+    return pool ? pool->num_workers : 0;
+}
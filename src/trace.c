@@ -0,0 +1,237 @@
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "trace.h"
+
+typedef struct {
+    const char *category;
+    const char *name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+} Span;
+
+// One thread's spans for one session. Only the owning thread appends; count is published with release.
+typedef struct TraceBuffer {
+    struct TraceBuffer *next;
+    int tid;                    // track number in the export, in order of first span
+    size_t capacity;
+    atomic_size_t count;
+    atomic_uint_fast64_t dropped;
+    Span spans[];
+} TraceBuffer;
+
+atomic_bool trace_active = false;
+
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static TraceBuffer *buffers;            // guarded by trace_lock, in tid order
+static TraceBuffer **buffers_tail = &buffers;
+static size_t spans_per_thread = TRACE_DEFAULT_SPANS_PER_THREAD;
+static int next_tid;
+static uint64_t epoch_ns;               // start of the session; exported timestamps count from here
+static atomic_uint session;             // bumped by every trace_start
+static atomic_uint_fast64_t lost;       // spans of threads that could not get a buffer
+
+static _Thread_local TraceBuffer *local;
+static _Thread_local unsigned local_session;
+
+uint64_t trace_clock_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Gives the calling thread a buffer for session `s`, or NULL if it cannot be allocated.
+static TraceBuffer *attach(unsigned s){
+    pthread_mutex_lock(&trace_lock);
+    TraceBuffer *buf = NULL;
+    if (atomic_load_explicit(&session, memory_order_relaxed) == s) {
+        buf = malloc(sizeof(TraceBuffer) + spans_per_thread * sizeof(Span));
+        if (buf != NULL) {
+            buf->next = NULL;
+            buf->tid = ++next_tid;
+            buf->capacity = spans_per_thread;
+            atomic_init(&buf->count, 0);
+            atomic_init(&buf->dropped, 0);
+            *buffers_tail = buf;
+            buffers_tail = &buf->next;
+        }
+    }
+    pthread_mutex_unlock(&trace_lock);
+    return buf;
+}
+
+void trace_record(const char *category, const char *name, uint64_t start_ns){
+    uint64_t end_ns = trace_clock_ns();
+    unsigned s = atomic_load_explicit(&session, memory_order_acquire);
+    if (local == NULL || local_session != s) {
+        local = attach(s);
+        local_session = s;
+        if (local == NULL) {
+            atomic_fetch_add_explicit(&lost, 1, memory_order_relaxed);
+            return;
+        }
+    }
+    size_t n = atomic_load_explicit(&local->count, memory_order_relaxed);
+    if (n == local->capacity) {
+        atomic_fetch_add_explicit(&local->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    local->spans[n] = (Span){ category, name, start_ns, end_ns };
+    atomic_store_explicit(&local->count, n + 1, memory_order_release);
+}
+
+static void free_buffers(void){
+    TraceBuffer *buf = buffers;
+    while (buf != NULL) {
+        TraceBuffer *next = buf->next;
+        free(buf);
+        buf = next;
+    }
+    buffers = NULL;
+    buffers_tail = &buffers;
+}
+
+TraceStatusCode trace_start(size_t capacity){
+    pthread_mutex_lock(&trace_lock);
+    free_buffers();
+    spans_per_thread = capacity > 0 ? capacity : TRACE_DEFAULT_SPANS_PER_THREAD;
+    next_tid = 0;
+    epoch_ns = trace_clock_ns();
+    atomic_store_explicit(&lost, 0, memory_order_relaxed);
+    // Threads notice the new session on their next span and attach a fresh buffer.
+    atomic_fetch_add_explicit(&session, 1, memory_order_release);
+    pthread_mutex_unlock(&trace_lock);
+    atomic_store_explicit(&trace_active, true, memory_order_relaxed);
+    return TRACE_OK;
+}
+
+void trace_stop(void){
+    atomic_store_explicit(&trace_active, false, memory_order_relaxed);
+}
+
+void trace_reset(void){
+    trace_stop();
+    pthread_mutex_lock(&trace_lock);
+    free_buffers();
+    next_tid = 0;
+    atomic_store_explicit(&lost, 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&session, 1, memory_order_release);
+    pthread_mutex_unlock(&trace_lock);
+}
+
+uint64_t trace_dropped(void){
+    pthread_mutex_lock(&trace_lock);
+    uint64_t dropped = atomic_load_explicit(&lost, memory_order_relaxed);
+    for (TraceBuffer *buf = buffers; buf != NULL; buf = buf->next) {
+        dropped += atomic_load_explicit(&buf->dropped, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&trace_lock);
+    return dropped;
+}
+
+static void write_string(FILE *out, const char *s){
+    fputc('"', out);
+    for (; *s != '\0'; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fprintf(out, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+// Trace-event timestamps are in microseconds; keep nanosecond precision as three decimals.
+static void write_us(FILE *out, uint64_t ns){
+    fprintf(out, "%" PRIu64 ".%03" PRIu64, ns / 1000, ns % 1000);
+}
+
+static void write_json(FILE *out){
+    bool first = true;
+    fputs("{\"traceEvents\":[", out);
+    for (TraceBuffer *buf = buffers; buf != NULL; buf = buf->next) {
+        fprintf(out, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                "\"args\":{\"name\":\"thread %d\"}}", first ? "" : ",", buf->tid, buf->tid);
+        first = false;
+        size_t n = atomic_load_explicit(&buf->count, memory_order_acquire);
+        for (size_t i = 0; i < n; i++) {
+            const Span *sp = &buf->spans[i];
+            uint64_t start = sp->start_ns > epoch_ns ? sp->start_ns - epoch_ns : 0;
+            uint64_t end = sp->end_ns > epoch_ns ? sp->end_ns - epoch_ns : 0;
+            fputs(",\n{\"name\":", out);
+            write_string(out, sp->name);
+            fputs(",\"cat\":", out);
+            write_string(out, sp->category);
+            fputs(",\"ph\":\"X\",\"ts\":", out);
+            write_us(out, start);
+            fputs(",\"dur\":", out);
+            write_us(out, end - start);
+            fprintf(out, ",\"pid\":1,\"tid\":%d}", buf->tid);
+        }
+    }
+    uint64_t dropped = atomic_load_explicit(&lost, memory_order_relaxed);
+    for (TraceBuffer *buf = buffers; buf != NULL; buf = buf->next) {
+        dropped += atomic_load_explicit(&buf->dropped, memory_order_relaxed);
+    }
+    fprintf(out, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_spans\":%" PRIu64 "}}\n", dropped);
+}
+
+TraceStatusCode trace_dump_json(char **json, size_t *len){
+    if (json == NULL) {
+        return TRACE_INVALID_ARGUMENT;
+    }
+    char *buf = NULL;
+    size_t size = 0;
+    FILE *stream = open_memstream(&buf, &size);
+    if (stream == NULL) {
+        return TRACE_ALLOCATION_FAILED;
+    }
+    pthread_mutex_lock(&trace_lock);
+    write_json(stream);
+    pthread_mutex_unlock(&trace_lock);
+    if (fclose(stream) != 0) {
+        free(buf);
+        return TRACE_ALLOCATION_FAILED;
+    }
+    *json = buf;
+    if (len != NULL) {
+        *len = size;
+    }
+    return TRACE_OK;
+}
+
+TraceStatusCode trace_write(const char *path){
+    if (path == NULL) {
+        return TRACE_INVALID_ARGUMENT;
+    }
+    char *json = NULL;
+    size_t len = 0;
+    TraceStatusCode status = trace_dump_json(&json, &len);
+    if (status != TRACE_OK) {
+        return status;
+    }
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        free(json);
+        return TRACE_IO_ERROR;
+    }
+    bool ok = fwrite(json, 1, len, f) == len;
+    ok = fclose(f) == 0 && ok;
+    free(json);
+    return ok ? TRACE_OK : TRACE_IO_ERROR;
+}
+
+const char *trace_status_string(TraceStatusCode status){
+    switch (status) {
+        case TRACE_OK:                return "ok";
+        case TRACE_INVALID_ARGUMENT:  return "invalid argument";
+        case TRACE_ALLOCATION_FAILED: return "allocation failed";
+        case TRACE_IO_ERROR:          return "I/O error";
+    }
+    return "unknown status";
+}
@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "tree.h"
+#include "controller_stats.h"
+#include "memory_account.h"
 
 typedef struct TreeNode {
     void *data;
@@ -15,8 +17,18 @@ struct Tree {
     void (*printFunction)(const void *data);
     int (*compareFunction)(const void *a, const void *b);
     void (*destroyFunction)(void *data);
+
+    // Frozen layout (see freezeTree). While frozen, root is NULL.
+    void **frozen;                  // data in Eytzinger order, 1-based; NULL when not frozen
+    long long *frozenKeys;          // keyFunction of each entry, same indexing; may be NULL
+    size_t frozenCount;
+    long long (*keyFunction)(const void *data);
 };
 
+static TreeStatusCode thawTree(Tree *tree);
+static void freeFrozen(Tree *tree);
+static size_t countNodes(const TreeNode *node);
+
 static int max(int a, int b) {
     if (a > b)
         return a;
@@ -31,8 +43,9 @@ static int height(TreeNode *node) {
 
 static TreeNode *createNode(void *data) {
     if (data == NULL) return NULL;
-    TreeNode *node = malloc(sizeof(TreeNode));
+    TreeNode *node = mem_alloc(MEM_TREE_NODES, sizeof(TreeNode));
     if (!node) return NULL;
+    STATS_ALLOC(STAT_ALLOC_TREE_NODE, sizeof(TreeNode));
     node->data = data;
     node->left = node->right = NULL;
     node->height = 1;
@@ -45,16 +58,21 @@ static void destroySubtree(TreeNode *node, void (*destroyFunction)(void *)) {
     destroySubtree(node->right, destroyFunction);
     if (destroyFunction)
         destroyFunction(node->data);
-    free(node);
+    mem_free(MEM_TREE_NODES, node, sizeof(TreeNode));
+    STATS_FREE(STAT_ALLOC_TREE_NODE);
 }
 
 Tree *createTree(void (*printFunction)(const void *),
                 int (*compareFunction)(const void *, const void *),
                 void (*destroyFunction)(void *)) {
     if (!printFunction || !compareFunction) return NULL;
-    Tree *tree = malloc(sizeof(Tree));
+    Tree *tree = mem_alloc(MEM_INDEXES, sizeof(Tree));
     if (!tree) return NULL;
     tree->root = NULL;
+    tree->frozen = NULL;
+    tree->frozenKeys = NULL;
+    tree->frozenCount = 0;
+    tree->keyFunction = NULL;
     tree->printFunction = printFunction;
     tree->compareFunction = compareFunction;
     tree->destroyFunction = destroyFunction;
@@ -64,7 +82,12 @@ Tree *createTree(void (*printFunction)(const void *),
 void destroyTree(Tree *tree) {
     if (!tree) return;
     destroySubtree(tree->root, tree->destroyFunction);
-    free(tree);
+    if (tree->frozen && tree->destroyFunction) {
+        for (size_t i = 1; i <= tree->frozenCount; i++)
+            tree->destroyFunction(tree->frozen[i]);
+    }
+    freeFrozen(tree);
+    mem_free(MEM_INDEXES, tree, sizeof(Tree));
 }
 
 static int getBalance(TreeNode *node) {
@@ -126,22 +149,210 @@ static TreeNode *insertRecursive(Tree *tree, TreeNode *node, void *data, TreeSta
 
 TreeStatusCode insertData(Tree *tree, void *data) {
     if (!tree || !data) return TREE_ERROR;
+    if (tree->frozen && thawTree(tree) != TREE_OK) return TREE_ERROR;
     TreeStatusCode status = TREE_OK;
     tree->root = insertRecursive(tree, tree->root, data, &status);
     return status;
 }
 
-static void *findRecursive(Tree *tree, TreeNode *node, const void *key) {
+///////////////////
+// Removal
+///////////////////
+
+static TreeNode *update(TreeNode *node) {
+    node->height = 1 + max(height(node->left), height(node->right));
+    return node;
+}
+
+/* Restores the AVL invariant at a node whose subtrees differ in height by at most two. */
+static TreeNode *rebalance(TreeNode *node) {
+    update(node);
+    int balance = getBalance(node);
+    if (balance > 1) {
+        if (getBalance(node->left) < 0)
+            node->left = rotateLeft(node->left);
+        return rotateRight(node);
+    }
+    if (balance < -1) {
+        if (getBalance(node->right) > 0)
+            node->right = rotateRight(node->right);
+        return rotateLeft(node);
+    }
+    return node;
+}
+
+/*
+ * Joins two AVL trees around a pivot node, where everything in left orders
+ * before pivot and everything in right after it. Descends the taller side
+ * only, so the cost is proportional to the difference in heights.
+ */
+static TreeNode *join(TreeNode *left, TreeNode *pivot, TreeNode *right) {
+    if (height(left) > height(right) + 1) {
+        left->right = join(left->right, pivot, right);
+        return rebalance(left);
+    }
+    if (height(right) > height(left) + 1) {
+        right->left = join(left, pivot, right->left);
+        return rebalance(right);
+    }
+    pivot->left = left;
+    pivot->right = right;
+    return update(pivot);
+}
+
+/* Detaches the smallest node of a non-empty subtree into *min; returns the rest. */
+static TreeNode *splitMin(TreeNode *node, TreeNode **min) {
+    if (!node->left) {
+        *min = node;
+        return node->right;
+    }
+    node->left = splitMin(node->left, min);
+    return rebalance(node);
+}
+
+/* Joins two trees where everything in left orders before everything in right. */
+static TreeNode *join2(TreeNode *left, TreeNode *right) {
+    if (!right) return left;
+    TreeNode *min = NULL;
+    TreeNode *rest = splitMin(right, &min);
+    return join(left, min, rest);
+}
+
+/*
+ * Splits a subtree around key: items ordering before key go to *less, the
+ * rest to *rest. With equalGoesLeft, items equal to key go to *less too.
+ */
+static void split(Tree *tree, TreeNode *node, const void *key, int equalGoesLeft,
+                  TreeNode **less, TreeNode **rest) {
+    if (!node) {
+        *less = *rest = NULL;
+        return;
+    }
+    TreeNode *left = node->left;
+    TreeNode *right = node->right;
+    int cmp = tree->compareFunction(node->data, key);
+    if (cmp < 0 || (cmp == 0 && equalGoesLeft)) {
+        TreeNode *a, *b;
+        split(tree, right, key, equalGoesLeft, &a, &b);
+        *less = join(left, node, a);
+        *rest = b;
+    } else {
+        TreeNode *a, *b;
+        split(tree, left, key, equalGoesLeft, &a, &b);
+        *less = a;
+        *rest = join(b, node, right);
+    }
+}
+
+static TreeNode *removeRecursive(Tree *tree, TreeNode *node, const void *key, void **found) {
     if (!node) return NULL;
     int cmp = tree->compareFunction(key, node->data);
-    if (cmp == 0) return node->data;
-    if (cmp < 0) return findRecursive(tree, node->left, key);
-    return findRecursive(tree, node->right, key);
+    if (cmp < 0) {
+        node->left = removeRecursive(tree, node->left, key, found);
+    } else if (cmp > 0) {
+        node->right = removeRecursive(tree, node->right, key, found);
+    } else {
+        *found = node->data;
+        TreeNode *replacement;
+        if (!node->left || !node->right) {
+            replacement = node->left ? node->left : node->right;
+        } else {
+            // Two children: the in-order successor takes this node's place.
+            TreeNode *rest = splitMin(node->right, &replacement);
+            replacement->left = node->left;
+            replacement->right = rest;
+        }
+        mem_free(MEM_TREE_NODES, node, sizeof(TreeNode));
+        STATS_FREE(STAT_ALLOC_TREE_NODE);
+        return replacement ? rebalance(replacement) : NULL;
+    }
+    return rebalance(node);
+}
+
+TreeStatusCode removeData(Tree *tree, const void *key, void **removed) {
+    if (!tree || !key) return TREE_ERROR;
+    if (tree->frozen && thawTree(tree) != TREE_OK) return TREE_ERROR;
+    void *found = NULL;
+    tree->root = removeRecursive(tree, tree->root, key, &found);
+    if (!found) return TREE_NOT_FOUND;
+    if (removed)
+        *removed = found;
+    else if (tree->destroyFunction)
+        tree->destroyFunction(found);
+    return TREE_OK;
+}
+
+static size_t discardSubtree(TreeNode *node, void (*destroyFunction)(void *)) {
+    size_t n = countNodes(node);
+    destroySubtree(node, destroyFunction);
+    return n;
+}
+
+TreeStatusCode removeRange(Tree *tree, const void *lo, const void *hi, int destroy, size_t *count) {
+    if (count) *count = 0;
+    if (!tree || !lo || !hi) return TREE_ERROR;
+    if (tree->compareFunction(lo, hi) > 0) return TREE_OK;
+    if (tree->frozen && thawTree(tree) != TREE_OK) return TREE_ERROR;
+
+    TreeNode *below, *from, *middle, *above;
+    split(tree, tree->root, lo, 0, &below, &from);
+    split(tree, from, hi, 1, &middle, &above);
+    size_t n = discardSubtree(middle, destroy ? tree->destroyFunction : NULL);
+    tree->root = join2(below, above);
+    if (count) *count = n;
+    return TREE_OK;
 }
 
+/*
+ * Branchless lower-bound search of the Eytzinger array: each step moves to
+ * child 2k or 2k+1 depending on one comparison, so the loop has no
+ * data-dependent branch. Sixteen slots ahead of k are its descendants four
+ * levels down, which is what gets prefetched while they exist; the check
+ * keeps the address inside the array and only flips once, near the leaves.
+ */
+static void *findFrozen(const Tree *tree, const void *key) {
+    const size_t n = tree->frozenCount;
+    size_t k = 1;
+    STATS_DEPTH_INIT(depth);
+    if (tree->frozenKeys) {
+        const long long *keys = tree->frozenKeys;
+        const long long target = tree->keyFunction(key);
+        while (k <= n) {
+            STATS_DEPTH_STEP(depth);
+            if (16 * k <= n) __builtin_prefetch(keys + 16 * k);
+            k = 2 * k + (keys[k] < target);
+        }
+    } else {
+        while (k <= n) {
+            STATS_DEPTH_STEP(depth);
+            if (16 * k <= n) __builtin_prefetch(tree->frozen + 16 * k);
+            k = 2 * k + (tree->compareFunction(key, tree->frozen[k]) > 0);
+        }
+    }
+    STATS_DEPTH_RECORD(depth);
+    // Undo the final run of right turns (plus one left turn) to reach the lower bound.
+    k >>= __builtin_ffsll((long long)~k);
+    if (k == 0 || tree->compareFunction(key, tree->frozen[k]) != 0) return NULL;
+    return tree->frozen[k];
+}
+
+/* Read-only descent: touches no shared state, so any number of threads may search at once. */
 void *findData(Tree *tree, const void *key) {
     if (!tree || !key) return NULL;
-    return findRecursive(tree, tree->root, key);
+    if (tree->frozen) return findFrozen(tree, key);
+    const TreeNode *node = tree->root;
+    STATS_DEPTH_INIT(depth);
+    while (node) {
+        STATS_DEPTH_STEP(depth);
+        int cmp = tree->compareFunction(key, node->data);
+        if (cmp == 0) {
+            STATS_DEPTH_RECORD(depth);
+            return node->data;
+        }
+        node = cmp < 0 ? node->left : node->right;
+    }
+    STATS_DEPTH_RECORD(depth);
+    return NULL;
 }
 
 static void printInOrderRecursive(TreeNode *node, void (*printFunction)(const void *)) {
@@ -151,11 +362,192 @@ static void printInOrderRecursive(TreeNode *node, void (*printFunction)(const vo
     printInOrderRecursive(node->right, printFunction);
 }
 
+/* In-order successor of Eytzinger index k, or 0 after the last one. */
+static size_t frozenNext(size_t k, size_t n) {
+    if (2 * k + 1 <= n) {
+        k = 2 * k + 1;
+        while (2 * k <= n) k *= 2;
+        return k;
+    }
+    while (k & 1) k >>= 1;
+    return k >> 1;
+}
+
+/* Index of the smallest entry, or 0 if there are none. */
+static size_t frozenFirst(size_t n) {
+    if (n == 0) return 0;
+    size_t k = 1;
+    while (2 * k <= n) k *= 2;
+    return k;
+}
+
 void printInOrder(Tree *tree) {
     if (!tree || !tree->printFunction) return;
+    if (tree->frozen) {
+        for (size_t k = frozenFirst(tree->frozenCount); k != 0; k = frozenNext(k, tree->frozenCount))
+            tree->printFunction(tree->frozen[k]);
+        return;
+    }
     printInOrderRecursive(tree->root, tree->printFunction);
 }
 
+/*
+ * Checks a subtree in order: each item must order after the one before it
+ * (*prev), and each node's stored height must be right and its subtrees
+ * within one of each other. Returns the height, or -1 on the first fault.
+ */
+static int verifySubtree(const Tree *tree, const TreeNode *node, const void **prev) {
+    if (!node) return 0;
+    int left = verifySubtree(tree, node->left, prev);
+    if (left < 0) return -1;
+    if (*prev && tree->compareFunction(*prev, node->data) >= 0) return -1;
+    *prev = node->data;
+    int right = verifySubtree(tree, node->right, prev);
+    if (right < 0) return -1;
+    if (left - right > 1 || right - left > 1) return -1;
+    if (node->height != 1 + max(left, right)) return -1;
+    return node->height;
+}
+
+TreeStatusCode verifyTree(const Tree *tree) {
+    if (!tree) return TREE_ERROR;
+    const void *prev = NULL;
+    if (tree->frozen) {
+        for (size_t k = frozenFirst(tree->frozenCount); k != 0; k = frozenNext(k, tree->frozenCount)) {
+            if (prev && tree->compareFunction(prev, tree->frozen[k]) >= 0) return TREE_ERROR;
+            prev = tree->frozen[k];
+        }
+        return TREE_OK;
+    }
+    return verifySubtree(tree, tree->root, &prev) < 0 ? TREE_ERROR : TREE_OK;
+}
+
+///////////////////
+// Freezing
+///////////////////
+
+static size_t countNodes(const TreeNode *node) {
+    return node ? 1 + countNodes(node->left) + countNodes(node->right) : 0;
+}
+
+/* Writes the subtree into Eytzinger slot k and below, consuming sorted data in order. */
+static void fillEytzinger(void **out, size_t k, size_t n, void **sorted, size_t *next) {
+    if (k > n) return;
+    fillEytzinger(out, 2 * k, n, sorted, next);
+    out[k] = sorted[(*next)++];
+    fillEytzinger(out, 2 * k + 1, n, sorted, next);
+}
+
+static void collectInOrder(const TreeNode *node, void **out, size_t *next) {
+    if (!node) return;
+    collectInOrder(node->left, out, next);
+    out[(*next)++] = node->data;
+    collectInOrder(node->right, out, next);
+}
+
+/* Builds a perfectly balanced AVL subtree over sorted[lo, hi); NULL on allocation failure. */
+static TreeNode *buildBalanced(void **sorted, size_t lo, size_t hi, int *failed) {
+    if (lo >= hi || *failed) return NULL;
+    size_t mid = lo + (hi - lo) / 2;
+    TreeNode *node = createNode(sorted[mid]);
+    if (!node) {
+        *failed = 1;
+        return NULL;
+    }
+    node->left = buildBalanced(sorted, lo, mid, failed);
+    node->right = buildBalanced(sorted, mid + 1, hi, failed);
+    node->height = 1 + max(height(node->left), height(node->right));
+    return node;
+}
+
+Tree *createTreeFromSorted(void (*printFunction)(const void *),
+                           int (*compareFunction)(const void *, const void *),
+                           void (*destroyFunction)(void *),
+                           void **sorted, size_t count) {
+    if (count > 0 && !sorted) return NULL;
+    for (size_t i = 0; i < count; i++) {
+        if (!sorted[i]) return NULL;
+        if (i > 0 && compareFunction && compareFunction(sorted[i - 1], sorted[i]) >= 0) return NULL;
+    }
+    Tree *tree = createTree(printFunction, compareFunction, destroyFunction);
+    if (!tree) return NULL;
+
+    int failed = 0;
+    TreeNode *root = buildBalanced(sorted, 0, count, &failed);
+    if (failed) {
+        destroySubtree(root, NULL);
+        mem_free(MEM_INDEXES, tree, sizeof(Tree));
+        return NULL;
+    }
+    tree->root = root;
+    return tree;
+}
+
+/* Frees the frozen arrays, if any, leaving the fields for the caller to reset. */
+static void freeFrozen(Tree *tree) {
+    if (!tree->frozen) return;
+    mem_free(MEM_INDEXES, tree->frozen, (tree->frozenCount + 1) * sizeof(void *));
+    mem_free(MEM_INDEXES, tree->frozenKeys, (tree->frozenCount + 1) * sizeof(long long));
+}
+
+/* Turns a frozen tree back into nodes. */
+static TreeStatusCode thawTree(Tree *tree) {
+    size_t n = tree->frozenCount;
+    void **sorted = malloc((n ? n : 1) * sizeof(void *));
+    if (!sorted) return TREE_ERROR;
+    size_t i = 0;
+    for (size_t k = frozenFirst(n); k != 0; k = frozenNext(k, n)) sorted[i++] = tree->frozen[k];
+
+    int failed = 0;
+    TreeNode *root = buildBalanced(sorted, 0, n, &failed);
+    free(sorted);
+    if (failed) {
+        destroySubtree(root, NULL);
+        return TREE_ERROR;
+    }
+    freeFrozen(tree);
+    tree->frozen = NULL;
+    tree->frozenKeys = NULL;
+    tree->frozenCount = 0;
+    tree->keyFunction = NULL;
+    tree->root = root;
+    return TREE_OK;
+}
+
+TreeStatusCode freezeTree(Tree *tree, long long (*keyFunction)(const void *data)) {
+    if (!tree) return TREE_ERROR;
+    if (tree->frozen && thawTree(tree) != TREE_OK) return TREE_ERROR;
+
+    size_t n = countNodes(tree->root);
+    void **sorted = malloc((n ? n : 1) * sizeof(void *));
+    void **frozen = mem_alloc(MEM_INDEXES, (n + 1) * sizeof(void *));
+    long long *keys = keyFunction ? mem_alloc(MEM_INDEXES, (n + 1) * sizeof(long long)) : NULL;
+    if (!sorted || !frozen || (keyFunction && !keys)) {
+        free(sorted);
+        mem_free(MEM_INDEXES, frozen, (n + 1) * sizeof(void *));
+        mem_free(MEM_INDEXES, keys, (n + 1) * sizeof(long long));
+        return TREE_ERROR;
+    }
+    size_t next = 0;
+    collectInOrder(tree->root, sorted, &next);
+    next = 0;
+    fillEytzinger(frozen, 1, n, sorted, &next);
+    free(sorted);
+    frozen[0] = NULL;
+    if (keys) {
+        keys[0] = 0;
+        for (size_t k = 1; k <= n; k++) keys[k] = keyFunction(frozen[k]);
+    }
+
+    destroySubtree(tree->root, NULL);
+    tree->root = NULL;
+    tree->frozen = frozen;
+    tree->frozenKeys = keys;
+    tree->frozenCount = n;
+    tree->keyFunction = keyFunction;
+    return TREE_OK;
+}
+
 ///////////////////
 // Iterator
 ///////////////////
@@ -163,6 +555,8 @@ struct TreeIterator {
     TreeNode **stack;
     int top;
     int capacity;
+    const Tree *frozenTree;         // set when iterating a frozen tree
+    size_t frozenIndex;             // next Eytzinger index to return; 0 when done
 };
 
 static void pushLeft(TreeIterator *iter, TreeNode *node) {
@@ -180,10 +574,21 @@ static void pushLeft(TreeIterator *iter, TreeNode *node) {
 }
 
 TreeIterator *createIterator(Tree *tree) {
-    if (!tree || !tree->root) return NULL;
+    if (!tree) return NULL;
+    if (tree->frozen) {
+        if (tree->frozenCount == 0) return NULL;
+        TreeIterator *iter = calloc(1, sizeof(TreeIterator));
+        if (!iter) return NULL;
+        iter->frozenTree = tree;
+        iter->frozenIndex = frozenFirst(tree->frozenCount);
+        return iter;
+    }
+    if (!tree->root) return NULL;
 
     TreeIterator *iter = malloc(sizeof(TreeIterator));
     if (!iter) return NULL;
+    iter->frozenTree = NULL;
+    iter->frozenIndex = 0;
 
     iter->capacity = 16;
     iter->top = 0;
@@ -198,7 +603,14 @@ TreeIterator *createIterator(Tree *tree) {
 }
 
 void *nextData(TreeIterator *iter) {
-    if (!iter || iter->top == 0) return NULL;
+    if (!iter) return NULL;
+    if (iter->frozenTree) {
+        if (iter->frozenIndex == 0) return NULL;
+        void *data = iter->frozenTree->frozen[iter->frozenIndex];
+        iter->frozenIndex = frozenNext(iter->frozenIndex, iter->frozenTree->frozenCount);
+        return data;
+    }
+    if (iter->top == 0) return NULL;
 
     TreeNode *node = iter->stack[--iter->top];
     void *data = node->data;
@@ -0,0 +1,329 @@
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include "worldgen_config.h"
+
+#define READ_CHUNK 4096
+
+typedef struct {
+    const char *name;
+    size_t offset;              // int field inside WorldGenConfig
+    int min;
+    int max;
+} ConfigKey;
+
+#define KEY(field, lo, hi) { #field, offsetof(WorldGenConfig, field), lo, hi }
+
+// `seed` is unsigned and handled separately.
+static const ConfigKey config_keys[] = {
+    KEY(num_rooms, 1, INT_MAX),
+    KEY(map_width, 1, INT_MAX),
+    KEY(map_height, 1, INT_MAX),
+    KEY(base_room_width, 3, 4096),
+    KEY(base_room_height, 3, 4096),
+    KEY(room_size_variance, 0, 4096),
+    KEY(max_monsters_per_room, 0, 4096),
+    KEY(max_items_per_room, 0, 4096),
+    KEY(monster_spawn_chance, 0, 100),
+    KEY(item_spawn_chance, 0, 100),
+};
+
+#define NUM_CONFIG_KEYS (sizeof(config_keys) / sizeof(config_keys[0]))
+
+// Line-at-a-time parser state shared by the memory and file front ends.
+typedef struct {
+    DungeonConfig *config;
+    ConfigError *error;
+    int line_no;
+    char line[CONFIG_MAX_LINE];
+    size_t line_len;
+    int overflow;               // current line exceeded CONFIG_MAX_LINE
+    int lenient;                // read lines as libworldgen does and never fail (worldgen_config_scan)
+} ConfigParser;
+
+static void set_error(ConfigError *error, int line, const char *key, size_t key_len){
+    if (error == NULL) return;
+    error->line = line;
+    if (key_len >= sizeof(error->key)) key_len = sizeof(error->key) - 1;
+    memcpy(error->key, key, key_len);
+    error->key[key_len] = '\0';
+}
+
+static int is_space(char c){
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Parses an optionally signed decimal integer filling all of [s, s+len).
+static int parse_long(const char *s, size_t len, long long *out){
+    size_t i = 0;
+    int negative = 0;
+    if (i < len && (s[i] == '-' || s[i] == '+')) {
+        negative = s[i] == '-';
+        i++;
+    }
+    if (i == len) return -1;
+    long long v = 0;
+    for (; i < len; i++) {
+        if (s[i] < '0' || s[i] > '9') return -1;
+        v = v * 10 + (s[i] - '0');
+        if (v > (long long)UINT_MAX) return -1;
+    }
+    *out = negative ? -v : v;
+    return 0;
+}
+
+static ConfigStatusCode parse_line(ConfigParser *p, const char *line, size_t len){
+    size_t start = 0;
+    while (start < len && is_space(line[start])) start++;
+    if (start == len || line[start] == '#' || line[start] == ';' || line[start] == '[') {
+        return CONFIG_OK;
+    }
+
+    const char *eq = memchr(line + start, '=', len - start);
+    if (eq == NULL) {
+        set_error(p->error, p->line_no, line + start, len - start);
+        return CONFIG_SYNTAX_ERROR;
+    }
+    const char *key = line + start;
+    size_t key_len = (size_t)(eq - key);
+    while (key_len > 0 && is_space(key[key_len - 1])) key_len--;
+
+    const char *val = eq + 1;
+    size_t val_len = (size_t)(line + len - val);
+    while (val_len > 0 && is_space(*val)) { val++; val_len--; }
+    // Allow trailing comments after the value.
+    for (size_t i = 0; i < val_len; i++) {
+        if (val[i] == '#' || val[i] == ';') { val_len = i; break; }
+    }
+    while (val_len > 0 && is_space(val[val_len - 1])) val_len--;
+
+    long long v;
+    if (key_len == 4 && memcmp(key, "seed", 4) == 0) {
+        if (parse_long(val, val_len, &v) != 0) {
+            set_error(p->error, p->line_no, key, key_len);
+            return CONFIG_BAD_VALUE;
+        }
+        if (v < 0) {
+            set_error(p->error, p->line_no, key, key_len);
+            return CONFIG_OUT_OF_RANGE;
+        }
+        p->config->seed = (unsigned int)v;
+        return CONFIG_OK;
+    }
+    for (size_t k = 0; k < NUM_CONFIG_KEYS; k++) {
+        const ConfigKey *ck = &config_keys[k];
+        if (strlen(ck->name) != key_len || memcmp(ck->name, key, key_len) != 0) continue;
+        if (parse_long(val, val_len, &v) != 0) {
+            set_error(p->error, p->line_no, key, key_len);
+            return CONFIG_BAD_VALUE;
+        }
+        if (v < ck->min || v > ck->max) {
+            set_error(p->error, p->line_no, key, key_len);
+            return CONFIG_OUT_OF_RANGE;
+        }
+        *(int *)((char *)&p->config->world + ck->offset) = (int)v;
+        return CONFIG_OK;
+    }
+    set_error(p->error, p->line_no, key, key_len);
+    return CONFIG_UNKNOWN_KEY;
+}
+
+// Reads a line as libworldgen's `%63[^=]=%63s` scan does: the key is everything before
+// the first '=', untrimmed, and the value the first word after it. Lines that name a
+// known key with an integer value in range set it; anything else is skipped.
+static void scan_line(ConfigParser *p, const char *line, size_t len){
+    const char *eq = memchr(line, '=', len);
+    if (eq == NULL || eq == line || eq - line > 63) return;
+    const char *key = line;
+    size_t key_len = (size_t)(eq - line);
+    const char *val = eq + 1;
+    const char *end = line + len;
+    while (val < end && is_space(*val)) val++;
+    size_t val_len = 0;
+    while (val + val_len < end && !is_space(val[val_len]) && val_len < 63) val_len++;
+
+    long long v;
+    if (val_len == 0 || parse_long(val, val_len, &v) != 0) return;
+    if (key_len == 4 && memcmp(key, "seed", 4) == 0) {
+        if (v >= 0) p->config->seed = (unsigned int)v;
+        return;
+    }
+    for (size_t k = 0; k < NUM_CONFIG_KEYS; k++) {
+        const ConfigKey *ck = &config_keys[k];
+        if (strlen(ck->name) != key_len || memcmp(ck->name, key, key_len) != 0) continue;
+        if (v >= INT_MIN && v <= INT_MAX) {
+            *(int *)((char *)&p->config->world + ck->offset) = (int)v;
+        }
+        return;
+    }
+}
+
+// Consumes `len` bytes, dispatching each complete line. Partial lines carry over.
+static ConfigStatusCode feed(ConfigParser *p, const char *data, size_t len){
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c == '\n') {
+            p->line_no++;
+            if (p->lenient) {
+                if (!p->overflow) scan_line(p, p->line, p->line_len);
+                p->line_len = 0;
+                p->overflow = 0;
+                continue;
+            }
+            if (p->overflow) {
+                set_error(p->error, p->line_no, p->line, p->line_len);
+                return CONFIG_SYNTAX_ERROR;
+            }
+            ConfigStatusCode st = parse_line(p, p->line, p->line_len);
+            if (st != CONFIG_OK) return st;
+            p->line_len = 0;
+            continue;
+        }
+        if (p->line_len < CONFIG_MAX_LINE) {
+            p->line[p->line_len++] = c;
+        } else {
+            p->overflow = 1;
+        }
+    }
+    return CONFIG_OK;
+}
+
+static ConfigStatusCode finish(ConfigParser *p){
+    if (p->line_len > 0 || p->overflow) {
+        ConfigStatusCode st = feed(p, "\n", 1);
+        if (st != CONFIG_OK) return st;
+    }
+    return p->lenient ? CONFIG_OK : worldgen_config_validate(p->config, p->error);
+}
+
+void worldgen_config_defaults(DungeonConfig *config){
+    if (config == NULL) return;
+    memset(config, 0, sizeof(*config));
+    WorldGenConfig *world = &config->world;
+    world->num_rooms = 10;
+    world->map_width = 80;
+    world->map_height = 40;
+    world->base_room_width = 5;
+    world->base_room_height = 5;
+    world->room_size_variance = 0;
+    world->max_monsters_per_room = 2;
+    world->max_items_per_room = 2;
+    world->monster_spawn_chance = 50;
+    world->item_spawn_chance = 50;
+    config->seed = 0;
+}
+
+int worldgen_grid_columns(const WorldGenConfig *config){
+    int cell = config->base_room_width + config->room_size_variance + 1;
+    return cell > 0 ? config->map_width / cell : 0;
+}
+
+int worldgen_grid_rows(const WorldGenConfig *config){
+    int cell = config->base_room_height + config->room_size_variance + 1;
+    return cell > 0 ? config->map_height / cell : 0;
+}
+
+ConfigStatusCode worldgen_config_validate(const DungeonConfig *dungeon, ConfigError *error){
+    if (dungeon == NULL) return CONFIG_INVALID_ARGUMENT;
+    const WorldGenConfig *config = &dungeon->world;
+
+    for (size_t k = 0; k < NUM_CONFIG_KEYS; k++) {
+        const ConfigKey *ck = &config_keys[k];
+        int v = *(const int *)((const char *)config + ck->offset);
+        if (v < ck->min || v > ck->max) {
+            set_error(error, 0, ck->name, strlen(ck->name));
+            return CONFIG_OUT_OF_RANGE;
+        }
+    }
+    // Every room needs walls on both sides of at least one floor tile.
+    if (config->base_room_width - config->room_size_variance < 3) {
+        set_error(error, 0, "room_size_variance", strlen("room_size_variance"));
+        return CONFIG_INCONSISTENT;
+    }
+    if (config->base_room_height - config->room_size_variance < 3) {
+        set_error(error, 0, "room_size_variance", strlen("room_size_variance"));
+        return CONFIG_INCONSISTENT;
+    }
+    long long cells = (long long)worldgen_grid_columns(config) * worldgen_grid_rows(config);
+    if (cells < config->num_rooms) {
+        set_error(error, 0, "num_rooms", strlen("num_rooms"));
+        return CONFIG_INCONSISTENT;
+    }
+    return CONFIG_OK;
+}
+
+ConfigStatusCode worldgen_config_parse(const char *text, size_t len,
+                                       DungeonConfig *config, ConfigError *error){
+    if (text == NULL || config == NULL) return CONFIG_INVALID_ARGUMENT;
+    DungeonConfig parsed;
+    worldgen_config_defaults(&parsed);
+    ConfigParser p = { .config = &parsed, .error = error };
+
+    ConfigStatusCode st = feed(&p, text, len);
+    if (st == CONFIG_OK) st = finish(&p);
+    if (st == CONFIG_OK) *config = parsed;
+    return st;
+}
+
+// Streams the file at `path` through `p` in fixed-size chunks.
+static ConfigStatusCode read_file(const char *path, ConfigParser *p){
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        set_error(p->error, 0, "", 0);
+        return CONFIG_FILE_ERROR;
+    }
+    char chunk[READ_CHUNK];
+    ConfigStatusCode st = CONFIG_OK;
+    for (;;) {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n < 0) {
+            set_error(p->error, p->line_no, "", 0);
+            st = CONFIG_FILE_ERROR;
+            break;
+        }
+        if (n == 0) {
+            st = finish(p);
+            break;
+        }
+        st = feed(p, chunk, (size_t)n);
+        if (st != CONFIG_OK) break;
+    }
+    close(fd);
+    return st;
+}
+
+ConfigStatusCode worldgen_config_load(const char *path, DungeonConfig *config,
+                                      ConfigError *error){
+    if (path == NULL || config == NULL) return CONFIG_INVALID_ARGUMENT;
+    DungeonConfig parsed;
+    worldgen_config_defaults(&parsed);
+    ConfigParser p = { .config = &parsed, .error = error };
+    ConfigStatusCode st = read_file(path, &p);
+    if (st == CONFIG_OK) *config = parsed;
+    return st;
+}
+
+ConfigStatusCode worldgen_config_scan(const char *path, DungeonConfig *config){
+    if (path == NULL || config == NULL) return CONFIG_INVALID_ARGUMENT;
+    DungeonConfig scanned;
+    worldgen_config_defaults(&scanned);
+    ConfigParser p = { .config = &scanned, .lenient = 1 };
+    ConfigStatusCode st = read_file(path, &p);
+    if (st == CONFIG_OK) *config = scanned;
+    return st;
+}
+
+const char *config_status_string(ConfigStatusCode status){
+    switch (status) {
+        case CONFIG_OK:               return "ok";
+        case CONFIG_INVALID_ARGUMENT: return "invalid argument";
+        case CONFIG_FILE_ERROR:       return "cannot read file";
+        case CONFIG_SYNTAX_ERROR:     return "syntax error";
+        case CONFIG_UNKNOWN_KEY:      return "unknown key";
+        case CONFIG_BAD_VALUE:        return "value is not an integer";
+        case CONFIG_OUT_OF_RANGE:     return "value out of range";
+        case CONFIG_INCONSISTENT:     return "inconsistent values";
+    }
+    return "unknown status";
+}
@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include "dungeon_controller.h"
+#include "test_util.h"
+#include "worldgen_config.h"
+
+// More rooms than an 80x40 map has grid cells for: libworldgen builds it,
+// the native generator cannot place it.
+static const char crowded_ini[] =
+    "# More rooms than grid cells\n"
+    "seed=1234\n"
+    "num_rooms=100\n"
+    "map_width=80\n"
+    "map_height=40\n"
+    "base_room_width=5\n"
+    "base_room_height=5\n"
+    "room_size_variance=0\n";
+
+// A key libworldgen has never heard of, a line with no '=', and a value
+// with trailing words.
+static const char unknown_key_ini[] =
+    "theme=caves\n"
+    "num_rooms=12 rooms\n"
+    "map_width=80\n"
+    "map_height=40\n"
+    "not a setting at all\n";
+
+typedef struct {
+    char dir[256];
+    char path[320];
+} ConfigFile;
+
+static int write_config(ConfigFile *f, const char *text){
+    if (test_temp_dir(f->dir, sizeof(f->dir)) != 0) return -1;
+    snprintf(f->path, sizeof(f->path), "%s/world.ini", f->dir);
+    if (test_write_file(f->path, text) == 0) return 0;
+    test_remove_dir(f->dir);
+    return -1;
+}
+
+static void test_strict_load_rejects_what_scan_accepts(void){
+    ConfigFile f;
+    CHECK_EQ_INT(write_config(&f, crowded_ini), 0);
+    DungeonConfig config;
+    CHECK_EQ_INT(worldgen_config_load(f.path, &config, NULL), CONFIG_INCONSISTENT);
+    CHECK_EQ_INT(worldgen_config_scan(f.path, &config), CONFIG_OK);
+    CHECK_EQ_INT(config.world.num_rooms, 100);
+    CHECK_EQ_INT(config.seed, 1234);
+    test_remove_dir(f.dir);
+
+    CHECK_EQ_INT(write_config(&f, unknown_key_ini), 0);
+    CHECK_EQ_INT(worldgen_config_load(f.path, &config, NULL), CONFIG_UNKNOWN_KEY);
+    CHECK_EQ_INT(worldgen_config_scan(f.path, &config), CONFIG_OK);
+    CHECK_EQ_INT(config.world.num_rooms, 12);
+    CHECK_EQ_INT(config.world.map_width, 80);
+    test_remove_dir(f.dir);
+}
+
+static void test_scan_missing_file(void){
+    DungeonConfig config;
+    CHECK_EQ_INT(worldgen_config_scan("/nonexistent/world.ini", &config), CONFIG_FILE_ERROR);
+    CHECK_EQ_INT(worldgen_config_scan(NULL, &config), CONFIG_INVALID_ARGUMENT);
+}
+
+// controller_init hands the file to libworldgen, so it must not apply the
+// native generator's stricter rules.
+static void check_controller_init_accepts(const char *text, int num_rooms){
+    ConfigFile f;
+    CHECK_EQ_INT(write_config(&f, text), 0);
+    Controller *ctrl = controller_init(f.path);
+    CHECK(ctrl != NULL);
+    if (ctrl != NULL) {
+        CHECK_EQ_INT(ctrl->config.world.num_rooms, num_rooms);
+        int id = -1;
+        CHECK_EQ_INT(get_player_room_id(ctrl, &id), CONTROLLER_OK);
+        CHECK(id >= 0);
+        controller_free(ctrl);
+    }
+    test_remove_dir(f.dir);
+}
+
+static void test_controller_init_takes_library_configs(void){
+    check_controller_init_accepts(crowded_ini, 100);
+    check_controller_init_accepts(unknown_key_ini, 12);
+}
+
+void config_tests(void){
+    RUN_TEST(test_strict_load_rejects_what_scan_accepts);
+    RUN_TEST(test_scan_missing_file);
+    RUN_TEST(test_controller_init_takes_library_configs);
+}
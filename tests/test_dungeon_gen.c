@@ -0,0 +1,190 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dungeon_controller.h"
+#include "dungeon_gen.h"
+#include "dungeon_loader.h"
+#include "memory_account.h"
+#include "room.h"
+#include "test_util.h"
+#include "worldgen_config.h"
+
+static void make_config(DungeonConfig *config, int num_rooms, unsigned seed){
+    worldgen_config_defaults(config);
+    config->world.num_rooms = num_rooms;
+    config->world.map_width = 400;
+    config->world.map_height = 400;
+    config->seed = seed;
+    CHECK_EQ_INT(worldgen_config_validate(config, NULL), CONFIG_OK);
+}
+
+// Checks that two rooms are identical in every generated field.
+static void check_same_room(const Room *a, const Room *b){
+    CHECK(a != NULL && b != NULL);
+    if (a == NULL || b == NULL) return;
+    CHECK_EQ_INT(b->id, a->id);
+    CHECK_EQ_INT(b->width, a->width);
+    CHECK_EQ_INT(b->height, a->height);
+    CHECK_EQ_INT(b->is_start, a->is_start);
+    CHECK_EQ_INT(b->is_exit, a->is_exit);
+    CHECK_EQ_INT(b->grid_placement, a->grid_placement);
+    CHECK(memcmp(a->neighbor_ids, b->neighbor_ids, sizeof(a->neighbor_ids)) == 0);
+
+    CHECK_EQ_INT(b->num_doors, a->num_doors);
+    for (int i = 0; i < a->num_doors && i < b->num_doors; i++) {
+        CHECK_EQ_INT(b->doors[i].x, a->doors[i].x);
+        CHECK_EQ_INT(b->doors[i].y, a->doors[i].y);
+        CHECK_EQ_INT(b->doors[i].dir, a->doors[i].dir);
+    }
+    CHECK_EQ_INT(b->num_monsters, a->num_monsters);
+    for (int i = 0; i < a->num_monsters && i < b->num_monsters; i++) {
+        const Monster *ma = &a->monsters[i], *mb = &b->monsters[i];
+        CHECK(ma->id == mb->id && ma->x == mb->x && ma->y == mb->y && ma->symbol == mb->symbol &&
+              ma->hp == mb->hp && ma->attack == mb->attack && strcmp(ma->name, mb->name) == 0);
+    }
+    CHECK_EQ_INT(b->num_items, a->num_items);
+    for (int i = 0; i < a->num_items && i < b->num_items; i++) {
+        const Item *ia = &a->items[i], *ib = &b->items[i];
+        CHECK(ia->id == ib->id && ia->x == ib->x && ia->y == ib->y && ia->symbol == ib->symbol &&
+              strcmp(ia->name, ib->name) == 0);
+    }
+}
+
+static void free_rooms(Room **rooms, int n){
+    for (int i = 0; i < n; i++) destroy_room(rooms[i]);
+    free(rooms);
+}
+
+// Generates the dungeon once per shard count and compares it with one shard.
+static void check_every_shard_count(const DungeonConfig *config){
+    int n = config->world.num_rooms;
+    Room **base = calloc((size_t)n, sizeof(Room *));
+    CHECK(base != NULL && generate_rooms(config, 1, NULL, base));
+    if (base == NULL) return;
+
+    static const int shard_counts[] = { 2, 3, 4, 5, 7, 8, 13, 64, 0, -1 };
+    for (size_t s = 0; s < sizeof(shard_counts) / sizeof(shard_counts[0]); s++) {
+        Room **rooms = calloc((size_t)n, sizeof(Room *));
+        bool ok = rooms != NULL && generate_rooms(config, shard_counts[s], NULL, rooms);
+        CHECK(ok);
+        if (!ok) {
+            free(rooms);
+            continue;
+        }
+        for (int id = 0; id < n; id++) check_same_room(base[id], rooms[id]);
+        free_rooms(rooms, n);
+    }
+
+    // One shard must also match rooms generated one at a time.
+    for (int id = 0; id < n; id++) {
+        Room *room = generate_room(config, id);
+        check_same_room(base[id], room);
+        destroy_room(room);
+    }
+    free_rooms(base, n);
+}
+
+static void test_generate_rooms_ignores_shard_count(void){
+    DungeonConfig config;
+    make_config(&config, 200, 42);
+    check_every_shard_count(&config);
+}
+
+static void test_small_and_odd_dungeons(void){
+    static const int sizes[] = { 1, 2, 7, 31, 97 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        DungeonConfig config;
+        make_config(&config, sizes[i], 1000u + (unsigned)i);
+        check_every_shard_count(&config);
+    }
+}
+
+// The sharded loader builds the same tree as the single-threaded one.
+static void test_sharded_loader_matches_plain_loader(void){
+    DungeonConfig config;
+    make_config(&config, 150, 7);
+    int plain_count = 0;
+    Room *plain_first = NULL;
+    Tree *plain = load_dungeon_from_config(&config, &plain_first, &plain_count);
+    CHECK(plain != NULL);
+    if (plain == NULL) return;
+    CHECK_EQ_INT(plain_count, config.world.num_rooms);
+    for (int shards = 1; shards <= 8; shards++) {
+        int count = 0;
+        Room *first = NULL;
+        Tree *tree = load_dungeon_sharded(&config, shards, NULL, &first, &count);
+        CHECK(tree != NULL);
+        if (tree == NULL) continue;
+        CHECK_EQ_INT(count, plain_count);
+        CHECK(first != NULL && plain_first != NULL && first->id == plain_first->id);
+        CHECK_EQ_INT(verifyTree(tree), TREE_OK);
+        TreeIterator *a = createIterator(plain), *b = createIterator(tree);
+        const Room *ra, *rb;
+        int seen = 0;
+        while ((ra = nextData(a)) != NULL) {
+            rb = nextData(b);
+            check_same_room(ra, rb);
+            if (rb == NULL) break;
+            seen++;
+        }
+        CHECK(nextData(b) == NULL);
+        CHECK_EQ_INT(seen, plain_count);
+        destroyIterator(a);
+        destroyIterator(b);
+        destroyTree(tree);
+    }
+    destroyTree(plain);
+}
+
+// A load cancelled before it starts generates nothing and leaves nothing charged.
+static void test_cancelled_load_stops_at_first_room(void){
+    DungeonConfig config;
+    make_config(&config, 2000, 5);
+    MemoryAccount account;
+    mem_account_init(&account, 0);
+    for (int shards = 1; shards <= 4; shards++) {
+        LoadProgress progress;
+        atomic_init(&progress.loaded, 0);
+        atomic_init(&progress.total, config.world.num_rooms);
+        atomic_init(&progress.cancelled, true);
+        MemoryAccount *previous = mem_account_enter(&account);
+        Tree *tree = load_dungeon_sharded(&config, shards, &progress, NULL, NULL);
+        mem_account_enter(previous);
+        CHECK(tree == NULL);
+        destroyTree(tree);
+        CHECK_EQ_INT(atomic_load(&progress.loaded), 0);
+        CHECK_EQ_INT(atomic_load(&account.total), 0);
+    }
+}
+
+// Cancelling a running load ends it early, with no controller to take.
+static void test_cancel_running_load(void){
+    DungeonConfig config;
+    worldgen_config_defaults(&config);
+    config.world.num_rooms = 1000000;
+    config.world.map_width = 8000;
+    config.world.map_height = 8000;
+    ControllerLoad *load = controller_init_with_config_async(&config, NULL, NULL);
+    CHECK(load != NULL);
+    if (load == NULL) return;
+    int loaded = 0, total = 0;
+    struct timespec pause = { 0, 100000L };
+    while (controller_load_poll(load, &loaded, &total) == CONTROLLER_LOAD_RUNNING && loaded == 0) {
+        nanosleep(&pause, NULL);
+    }
+    controller_load_cancel(load);
+    CHECK_EQ_INT(controller_load_wait(load), CONTROLLER_LOAD_CANCELLED);
+    controller_load_poll(load, &loaded, &total);
+    CHECK_EQ_INT(total, config.world.num_rooms);
+    CHECK(loaded < total);
+    CHECK(controller_load_take(load) == NULL);
+    controller_load_free(load);
+}
+
+void dungeon_gen_tests(void){
+    RUN_TEST(test_generate_rooms_ignores_shard_count);
+    RUN_TEST(test_small_and_odd_dungeons);
+    RUN_TEST(test_sharded_loader_matches_plain_loader);
+    RUN_TEST(test_cancelled_load_stops_at_first_room);
+    RUN_TEST(test_cancel_running_load);
+}
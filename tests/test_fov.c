@@ -0,0 +1,125 @@
+#include <string.h>
+#include "fov.h"
+#include "test_util.h"
+
+#define MAX_WORDS 64
+
+// A walled room with no doors, items or monsters.
+static Room open_room(int width, int height){
+    Room room;
+    memset(&room, 0, sizeof(room));
+    room.width = width;
+    room.height = height;
+    for (int d = 0; d < NUM_DIRECTIONS; d++) room.neighbor_ids[d] = -1;
+    return room;
+}
+
+static Monster monster_at(int x, int y){
+    Monster m;
+    memset(&m, 0, sizeof(m));
+    m.x = x;
+    m.y = y;
+    m.symbol = 'M';
+    return m;
+}
+
+static FovStatusCode compute(FovContext *fov, const Room *room, unsigned version, int x, int y,
+                             int radius, uint64_t *visible){
+    FovStatusCode status = fov_compute(fov, room, version, x, y, radius, visible, MAX_WORDS);
+    if (status == FOV_OK) fov_commit(fov);
+    return status;
+}
+
+// With nothing in the way, exactly the tiles within the radius are visible.
+static void test_open_room_follows_radius(void){
+    FovContext *fov = fov_create(20);
+    CHECK(fov != NULL);
+    if (fov == NULL) return;
+    Room room = open_room(21, 21);
+    uint64_t visible[MAX_WORDS];
+    static const int radii[] = { 1, 3, 5, 8, 20 };
+    for (size_t r = 0; r < sizeof(radii) / sizeof(radii[0]); r++) {
+        int radius = radii[r];
+        CHECK_EQ_INT(compute(fov, &room, 0, 10, 10, radius, visible), FOV_OK);
+        int wrong = 0;
+        for (int y = 0; y < room.height; y++) {
+            for (int x = 0; x < room.width; x++) {
+                int dx = x - 10, dy = y - 10;
+                wrong += fov_is_visible(visible, room.width, x, y) != (dx * dx + dy * dy <= radius * radius);
+            }
+        }
+        CHECK_EQ_INT(wrong, 0);
+    }
+    fov_destroy(fov);
+}
+
+// A monster is seen but hides the tiles straight behind it.
+static void test_monster_casts_shadow(void){
+    FovContext *fov = fov_create(20);
+    CHECK(fov != NULL);
+    if (fov == NULL) return;
+    Room room = open_room(21, 11);
+    Monster monster = monster_at(6, 5);
+    room.monsters = &monster;
+    room.num_monsters = 1;
+    uint64_t visible[MAX_WORDS];
+    CHECK_EQ_INT(compute(fov, &room, 0, 3, 5, 20, visible), FOV_OK);
+    CHECK(fov_is_visible(visible, room.width, 5, 5));
+    CHECK(fov_is_visible(visible, room.width, 6, 5));
+    for (int x = 7; x < room.width; x++) CHECK(!fov_is_visible(visible, room.width, x, 5));
+    CHECK(fov_is_visible(visible, room.width, 10, 2));
+    CHECK(fov_is_visible(visible, room.width, 10, 8));
+
+    room.num_monsters = 0;
+    CHECK_EQ_INT(compute(fov, &room, 0, 3, 5, 20, visible), FOV_OK);
+    for (int x = 7; x < room.width; x++) CHECK(fov_is_visible(visible, room.width, x, 5));
+    fov_destroy(fov);
+}
+
+// The same version returns the remembered result; a new one recomputes.
+static void test_cache_follows_version(void){
+    FovContext *fov = fov_create(20);
+    CHECK(fov != NULL);
+    if (fov == NULL) return;
+    Room room = open_room(21, 11);
+    Monster monster = monster_at(6, 5);
+    room.monsters = &monster;
+    room.num_monsters = 1;
+    uint64_t visible[MAX_WORDS];
+    CHECK_EQ_INT(compute(fov, &room, 1, 3, 5, 20, visible), FOV_OK);
+    CHECK(!fov_is_visible(visible, room.width, 10, 5));
+
+    // The monster steps aside without a version bump: the cached result is a hit.
+    monster.y = 2;
+    CHECK_EQ_INT(compute(fov, &room, 1, 3, 5, 20, visible), FOV_OK);
+    CHECK(!fov_is_visible(visible, room.width, 10, 5));
+
+    // A new version, or version 0, misses and sees the room as it is now.
+    CHECK_EQ_INT(compute(fov, &room, 2, 3, 5, 20, visible), FOV_OK);
+    CHECK(fov_is_visible(visible, room.width, 10, 5));
+    monster.y = 5;
+    CHECK_EQ_INT(compute(fov, &room, 0, 3, 5, 20, visible), FOV_OK);
+    CHECK(!fov_is_visible(visible, room.width, 10, 5));
+    fov_destroy(fov);
+}
+
+static void test_bad_arguments(void){
+    FovContext *fov = fov_create(8);
+    CHECK(fov != NULL);
+    CHECK(fov_create(0) == NULL);
+    CHECK(fov_create(FOV_MAX_RADIUS + 1) == NULL);
+    if (fov == NULL) return;
+    Room room = open_room(10, 10);
+    uint64_t visible[MAX_WORDS];
+    CHECK_EQ_INT(compute(fov, &room, 0, 10, 3, 5, visible), FOV_INVALID_ARGUMENT);
+    CHECK_EQ_INT(compute(fov, &room, 0, 3, 3, 9, visible), FOV_INVALID_ARGUMENT);
+    CHECK_EQ_INT(fov_compute(fov, &room, 0, 3, 3, 5, visible, 1), FOV_INVALID_ARGUMENT);
+    fov_destroy(fov);
+}
+
+void fov_tests(void){
+    RUN_TEST(test_open_room_follows_radius);
+    RUN_TEST(test_monster_casts_shadow);
+    RUN_TEST(test_cache_follows_version);
+    RUN_TEST(test_bad_arguments);
+}
@@ -0,0 +1,331 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "dungeon_controller.h"
+#include "journal.h"
+#include "test_util.h"
+#include "worldgen_config.h"
+
+#define MAX_RECORDS 64
+
+typedef struct {
+    JournalRecord records[MAX_RECORDS];
+    int count;
+} Replayed;
+
+typedef struct {
+    char dir[256];
+    char log[300];
+    DungeonConfig config;
+} Fixture;
+
+static int collect(const JournalRecord *record, void *user_data){
+    Replayed *out = user_data;
+    if (out->count == MAX_RECORDS) return 1;
+    out->records[out->count++] = *record;
+    return 0;
+}
+
+static int setup(Fixture *f){
+    if (test_temp_dir(f->dir, sizeof(f->dir)) != 0) return -1;
+    snprintf(f->log, sizeof(f->log), "%s/session.journal", f->dir);
+    worldgen_config_defaults(&f->config);
+    return 0;
+}
+
+static long file_size(const char *path){
+    struct stat sb;
+    return stat(path, &sb) == 0 ? (long)sb.st_size : -1;
+}
+
+// Reads a whole file into a new buffer.
+static unsigned char *read_file(const char *path, long *size){
+    *size = file_size(path);
+    if (*size < 0) return NULL;
+    unsigned char *buf = malloc(*size > 0 ? (size_t)*size : 1);
+    int fd = open(path, O_RDONLY);
+    if (buf == NULL || fd < 0 || read(fd, buf, (size_t)*size) != (ssize_t)*size) {
+        free(buf);
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+    close(fd);
+    return buf;
+}
+
+static int write_file(const char *path, const void *data, size_t size, int flags){
+    int fd = open(path, O_WRONLY | flags, 0644);
+    if (fd < 0) return -1;
+    int ok = write(fd, data, size) == (ssize_t)size;
+    close(fd);
+    return ok ? 0 : -1;
+}
+
+static const JournalRecord move_within = { .type = JOURNAL_RECORD_MOVE_WITHIN_ROOM, .dx = 1, .dy = -1 };
+static const JournalRecord move_east = { .type = JOURNAL_RECORD_MOVE_DIRECTION, .dir = DIR_EAST };
+static const JournalRecord tick = { .type = JOURNAL_RECORD_TICK };
+
+// Appends a move, three ticks and a direction move: three records once the ticks fold.
+static void append_sample(Journal *j){
+    CHECK_EQ_INT(journal_append(j, &move_within), JOURNAL_OK);
+    for (int i = 0; i < 3; i++) {
+        CHECK_EQ_INT(journal_append(j, &tick), JOURNAL_OK);
+    }
+    CHECK_EQ_INT(journal_append(j, &move_east), JOURNAL_OK);
+}
+
+static void check_sample(const Replayed *r, int at){
+    CHECK(r->count >= at + 3);
+    if (r->count < at + 3) return;
+    CHECK_EQ_INT(r->records[at].type, JOURNAL_RECORD_MOVE_WITHIN_ROOM);
+    CHECK_EQ_INT(r->records[at].dx, 1);
+    CHECK_EQ_INT(r->records[at].dy, -1);
+    CHECK_EQ_INT(r->records[at + 1].type, JOURNAL_RECORD_TICK);
+    CHECK_EQ_INT(r->records[at + 1].count, 3);
+    CHECK_EQ_INT(r->records[at + 2].type, JOURNAL_RECORD_MOVE_DIRECTION);
+    CHECK_EQ_INT(r->records[at + 2].dir, DIR_EAST);
+}
+
+static void test_replay_returns_records_in_order(void){
+    Fixture f;
+    if (setup(&f) != 0) { CHECK(!"temp dir"); return; }
+    JournalStatusCode st;
+    Journal *j = journal_open(f.log, &f.config, NULL, &st);
+    CHECK(j != NULL);
+    if (j == NULL) { test_remove_dir(f.dir); return; }
+    append_sample(j);
+    CHECK_EQ_INT(journal_close(j), JOURNAL_OK);
+
+    j = journal_open(f.log, &f.config, NULL, &st);
+    CHECK_EQ_INT(st, JOURNAL_OK);
+    JournalCheckpoint cp;
+    bool found = true;
+    CHECK_EQ_INT(journal_read_checkpoint(j, &cp, &found), JOURNAL_OK);
+    CHECK(!found);
+    Replayed r = {0};
+    CHECK_EQ_INT(journal_replay(j, NULL, collect, &r), JOURNAL_OK);
+    CHECK_EQ_INT(r.count, 3);
+    check_sample(&r, 0);
+    journal_close(j);
+    test_remove_dir(f.dir);
+}
+
+static void test_torn_final_record_is_discarded(void){
+    Fixture f;
+    if (setup(&f) != 0) { CHECK(!"temp dir"); return; }
+    Journal *j = journal_open(f.log, &f.config, NULL, NULL);
+    CHECK(j != NULL);
+    if (j == NULL) { test_remove_dir(f.dir); return; }
+    append_sample(j);
+    CHECK_EQ_INT(journal_close(j), JOURNAL_OK);
+    long intact = file_size(f.log);
+
+    // A crash in the middle of a group write leaves part of a record behind.
+    const unsigned char torn[5] = { 0x01, 0x02, 0x03, 0x04, 0x05 };
+    CHECK_EQ_INT(write_file(f.log, torn, sizeof(torn), O_APPEND), 0);
+    CHECK_EQ_INT(file_size(f.log), intact + 5);
+
+    JournalStatusCode st;
+    j = journal_open(f.log, &f.config, NULL, &st);
+    CHECK_EQ_INT(st, JOURNAL_OK);
+    if (j == NULL) { test_remove_dir(f.dir); return; }
+    CHECK_EQ_INT(file_size(f.log), intact);
+    Replayed r = {0};
+    CHECK_EQ_INT(journal_replay(j, NULL, collect, &r), JOURNAL_OK);
+    CHECK_EQ_INT(r.count, 3);
+    check_sample(&r, 0);
+
+    // New records follow the last complete one.
+    CHECK_EQ_INT(journal_append(j, &move_within), JOURNAL_OK);
+    CHECK_EQ_INT(journal_close(j), JOURNAL_OK);
+    j = journal_open(f.log, &f.config, NULL, NULL);
+    r.count = 0;
+    CHECK_EQ_INT(journal_replay(j, NULL, collect, &r), JOURNAL_OK);
+    CHECK_EQ_INT(r.count, 4);
+    check_sample(&r, 0);
+    journal_close(j);
+    test_remove_dir(f.dir);
+}
+
+static void test_log_older_than_checkpoint_is_skipped(void){
+    Fixture f;
+    if (setup(&f) != 0) { CHECK(!"temp dir"); return; }
+    Journal *j = journal_open(f.log, &f.config, NULL, NULL);
+    CHECK(j != NULL);
+    if (j == NULL) { test_remove_dir(f.dir); return; }
+    append_sample(j);
+    CHECK_EQ_INT(journal_sync(j), JOURNAL_OK);
+    long old_size;
+    unsigned char *old_log = read_file(f.log, &old_size);
+    CHECK(old_log != NULL);
+
+    int visited[] = { 0, 1 };
+    JournalCheckpoint cp = { .room_id = 1, .tile_x = 2, .tile_y = 3, .health = 7, .alive = true,
+                             .visited_ids = visited, .visited_count = 2 };
+    CHECK_EQ_INT(journal_write_checkpoint(j, &cp), JOURNAL_OK);
+    CHECK_EQ_INT(journal_close(j), JOURNAL_OK);
+
+    // Simulate a crash after the checkpoint was renamed into place but before
+    // the log was reset: the log on disk still has the previous generation.
+    if (old_log != NULL) {
+        CHECK_EQ_INT(write_file(f.log, old_log, (size_t)old_size, O_TRUNC), 0);
+    }
+    free(old_log);
+
+    JournalStatusCode st;
+    j = journal_open(f.log, &f.config, NULL, &st);
+    CHECK_EQ_INT(st, JOURNAL_OK);
+    if (j == NULL) { test_remove_dir(f.dir); return; }
+    JournalCheckpoint read;
+    bool found = false;
+    CHECK_EQ_INT(journal_read_checkpoint(j, &read, &found), JOURNAL_OK);
+    CHECK(found);
+    CHECK_EQ_INT(read.room_id, 1);
+    CHECK_EQ_INT(read.health, 7);
+    CHECK_EQ_INT(read.visited_count, 2);
+    Replayed r = {0};
+    CHECK_EQ_INT(journal_replay(j, &read, collect, &r), JOURNAL_OK);
+    CHECK_EQ_INT(r.count, 0);
+
+    // Replay finished the interrupted reset, so new records count from the checkpoint.
+    CHECK_EQ_INT(journal_append(j, &move_east), JOURNAL_OK);
+    CHECK_EQ_INT(journal_close(j), JOURNAL_OK);
+    j = journal_open(f.log, &f.config, NULL, NULL);
+    r.count = 0;
+    CHECK_EQ_INT(journal_replay(j, &read, collect, &r), JOURNAL_OK);
+    CHECK_EQ_INT(r.count, 1);
+    CHECK_EQ_INT(r.records[0].type, JOURNAL_RECORD_MOVE_DIRECTION);
+    journal_checkpoint_free(&read);
+    journal_close(j);
+    test_remove_dir(f.dir);
+}
+
+static void test_config_mismatch_is_refused(void){
+    Fixture f;
+    if (setup(&f) != 0) { CHECK(!"temp dir"); return; }
+    Journal *j = journal_open(f.log, &f.config, NULL, NULL);
+    CHECK(j != NULL);
+    journal_close(j);
+    DungeonConfig other = f.config;
+    other.seed++;
+    JournalStatusCode st;
+    CHECK(journal_open(f.log, &other, NULL, &st) == NULL);
+    CHECK_EQ_INT(st, JOURNAL_CONFIG_MISMATCH);
+    test_remove_dir(f.dir);
+}
+
+static void test_poll_syncs_idle_group(void){
+    Fixture f;
+    if (setup(&f) != 0) { CHECK(!"temp dir"); return; }
+    JournalOptions options = { .group_commit_ms = 5 };
+    Journal *j = journal_open(f.log, &f.config, &options, NULL);
+    CHECK(j != NULL);
+    if (j == NULL) { test_remove_dir(f.dir); return; }
+    int next_ms = 0;
+    CHECK_EQ_INT(journal_poll(j, &next_ms), JOURNAL_OK);
+    CHECK_EQ_INT(next_ms, -1);
+
+    long empty = file_size(f.log);
+    CHECK_EQ_INT(journal_append(j, &move_within), JOURNAL_OK);
+    CHECK_EQ_INT(journal_poll(j, &next_ms), JOURNAL_OK);
+    CHECK(next_ms > 0 && next_ms <= 5);
+    CHECK_EQ_INT(file_size(f.log), empty);
+
+    struct timespec wait = { 0, 10 * 1000000L };
+    nanosleep(&wait, NULL);
+    CHECK_EQ_INT(journal_poll(j, &next_ms), JOURNAL_OK);
+    CHECK_EQ_INT(next_ms, -1);
+    CHECK(file_size(f.log) > empty);
+    journal_close(j);
+    test_remove_dir(f.dir);
+}
+
+static void test_controller_recovers_journaled_session(void){
+    Fixture f;
+    if (setup(&f) != 0) { CHECK(!"temp dir"); return; }
+    f.config.world.num_rooms = 40;
+    f.config.world.map_width = 200;
+    f.config.world.map_height = 200;
+    JournalOptions options = { .checkpoint_interval = 50 };
+    Controller *ctrl = controller_init_with_config(&f.config);
+    Journal *j = journal_open(f.log, &f.config, &options, NULL);
+    CHECK(ctrl != NULL && j != NULL);
+    if (ctrl == NULL || j == NULL) { controller_free(ctrl); test_remove_dir(f.dir); return; }
+    CHECK_EQ_INT(controller_attach_journal(ctrl, j), CONTROLLER_OK);
+    unsigned seed = 11;
+    for (int i = 0; i < 237; i++) {
+        seed = seed * 1103515245u + 12345u;
+        unsigned r = (seed >> 16) % 10;
+        if (r < 2) controller_tick(ctrl);
+        else if (r < 7) move_player_within_room(ctrl, (int)(seed % 3) - 1, (int)((seed >> 4) % 3) - 1);
+        else move_player_direction(ctrl, (Direction)((seed >> 8) % 4));
+    }
+    CHECK_EQ_INT(controller_attach_journal(ctrl, NULL), CONTROLLER_OK);
+    CHECK_EQ_INT(journal_close(j), JOURNAL_OK);
+
+    j = journal_open(f.log, &f.config, &options, NULL);
+    Controller *back = j != NULL ? controller_recover(&f.config, j) : NULL;
+    CHECK(back != NULL);
+    if (back != NULL) {
+        int ra, rb, xa, ya, xb, yb, ha, hb;
+        get_player_room_id(ctrl, &ra);
+        get_player_room_id(back, &rb);
+        get_player_position(ctrl, &xa, &ya);
+        get_player_position(back, &xb, &yb);
+        get_player_health(ctrl, &ha);
+        get_player_health(back, &hb);
+        CHECK_EQ_INT(rb, ra);
+        CHECK_EQ_INT(xb, xa);
+        CHECK_EQ_INT(yb, ya);
+        CHECK_EQ_INT(hb, ha);
+        int *va, *vb;
+        size_t na, nb;
+        get_visited_room_ids(ctrl, &va, &na);
+        get_visited_room_ids(back, &vb, &nb);
+        CHECK_EQ_INT(nb, na);
+        CHECK(na == nb && memcmp(va, vb, na * sizeof(int)) == 0);
+        free(va);
+        free(vb);
+        controller_free(back);
+    }
+    journal_close(j);
+    controller_free(ctrl);
+    test_remove_dir(f.dir);
+}
+
+// Recovery regenerates the dungeon natively, so a libworldgen dungeon cannot be journaled.
+static void test_file_loaded_controller_is_refused(void){
+    Fixture f;
+    if (setup(&f) != 0) { CHECK(!"temp dir"); return; }
+    char ini[320];
+    snprintf(ini, sizeof(ini), "%s/world.ini", f.dir);
+    CHECK_EQ_INT(test_write_file(ini, "num_rooms=10\nmap_width=80\nmap_height=40\n"), 0);
+    Controller *ctrl = controller_init(ini);
+    Journal *j = journal_open(f.log, &f.config, NULL, NULL);
+    CHECK(ctrl != NULL && j != NULL);
+    if (ctrl != NULL && j != NULL) {
+        long empty = file_size(f.log);
+        CHECK_EQ_INT(controller_attach_journal(ctrl, j), CONTROLLER_INVALID_ARGUMENT);
+        CHECK(ctrl->journal == NULL);
+        controller_tick(ctrl);
+        CHECK_EQ_INT(journal_sync(j), JOURNAL_OK);
+        CHECK_EQ_INT(file_size(f.log), empty);
+        CHECK_EQ_INT(controller_attach_journal(ctrl, NULL), CONTROLLER_OK);
+    }
+    journal_close(j);
+    controller_free(ctrl);
+    test_remove_dir(f.dir);
+}
+
+void journal_tests(void){
+    RUN_TEST(test_replay_returns_records_in_order);
+    RUN_TEST(test_torn_final_record_is_discarded);
+    RUN_TEST(test_log_older_than_checkpoint_is_skipped);
+    RUN_TEST(test_config_mismatch_is_refused);
+    RUN_TEST(test_poll_syncs_idle_group);
+    RUN_TEST(test_controller_recovers_journaled_session);
+    RUN_TEST(test_file_loaded_controller_is_refused);
+}
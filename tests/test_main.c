@@ -0,0 +1,69 @@
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "test_util.h"
+
+/*
+ * Unit test runner: `make test` builds and runs this binary.
+ */
+
+int test_failures = 0;
+
+void test_run(const char *name, void (*fn)(void)){
+    int before = test_failures;
+    fn();
+    printf("%-48s %s\n", name, test_failures == before ? "ok" : "FAILED");
+}
+
+int test_temp_dir(char *buf, size_t size){
+    const char *tmp = getenv("TMPDIR");
+    int n = snprintf(buf, size, "%s/a1_test_XXXXXX", tmp != NULL && tmp[0] != '\0' ? tmp : "/tmp");
+    if (n < 0 || (size_t)n >= size) return -1;
+    return mkdtemp(buf) != NULL ? 0 : -1;
+}
+
+void test_remove_dir(const char *path){
+    DIR *dir = opendir(path);
+    if (dir == NULL) return;
+    struct dirent *entry;
+    char file[4096];
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        snprintf(file, sizeof(file), "%s/%s", path, entry->d_name);
+        unlink(file);
+    }
+    closedir(dir);
+    rmdir(path);
+}
+
+int test_write_file(const char *path, const char *text){
+    FILE *f = fopen(path, "w");
+    if (f == NULL) return -1;
+    int ok = fputs(text, f) >= 0;
+    return fclose(f) == 0 && ok ? 0 : -1;
+}
+
+int main(void){
+    journal_tests();
+    render_codec_tests();
+    tree_tests();
+    dungeon_gen_tests();
+    config_tests();
+    map_tests();
+    render_tests();
+    fov_tests();
+    memory_tests();
+    seqlock_tests();
+    scheduler_tests();
+    simulation_tests();
+    trace_tests();
+
+    if (test_failures > 0) {
+        printf("%d check(s) failed\n", test_failures);
+        return 1;
+    }
+    printf("all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <string.h>
+#include "dungeon_controller.h"
+#include "room.h"
+#include "test_util.h"
+#include "worldgen_config.h"
+
+static const char world_ini[] =
+    "seed=1234\n"
+    "num_rooms=40\n"
+    "map_width=80\n"
+    "map_height=40\n"
+    "base_room_width=5\n"
+    "base_room_height=5\n"
+    "room_size_variance=2\n"
+    "max_monsters_per_room=2\n"
+    "max_items_per_room=2\n"
+    "monster_spawn_chance=100\n"
+    "item_spawn_chance=100\n";
+
+static size_t count_rooms(const Controller *ctrl){
+    size_t n = 0;
+    for (int id = 0; id <= ctrl->max_room_id; id++) {
+        const Room *room;
+        n += get_room_by_id(ctrl, id, &room) == CONTROLLER_OK;
+    }
+    return n;
+}
+
+// Checks the map is a rectangle of equal rows with exactly one player on it.
+static void check_map_shape(const char *map){
+    CHECK(map != NULL && map[0] != '\0');
+    if (map == NULL) return;
+    const char *nl = strchr(map, '\n');
+    CHECK(nl != NULL);
+    if (nl == NULL) return;
+    size_t width = (size_t)(nl - map) + 1;
+    size_t len = strlen(map);
+    CHECK_EQ_INT(len % width, 0);
+    for (size_t at = width - 1; at < len; at += width) CHECK(map[at] == '\n');
+    const char *player = strchr(map, TILE_PLAYER);
+    CHECK(player != NULL && strchr(player + 1, TILE_PLAYER) == NULL);
+}
+
+// Draws the whole map and checks that every room landed on it.
+static void check_full_map(const Controller *ctrl){
+    MapCanvas *canvas = NULL;
+    CHECK_EQ_INT(map_canvas_create(ctrl, false, &canvas), CONTROLLER_OK);
+    if (canvas == NULL) return;
+    const char *map = NULL;
+    size_t redrawn = 0;
+    CHECK_EQ_INT(render_map(ctrl, canvas, &map, &redrawn), CONTROLLER_OK);
+    CHECK_EQ_INT(redrawn, count_rooms(ctrl));
+    check_map_shape(map);
+
+    // Nothing changed, so nothing is redrawn.
+    CHECK_EQ_INT(render_map(ctrl, canvas, &map, &redrawn), CONTROLLER_OK);
+    CHECK_EQ_INT(redrawn, 0);
+    map_canvas_free(canvas);
+}
+
+static void test_map_of_generated_dungeon(void){
+    DungeonConfig config;
+    worldgen_config_defaults(&config);
+    config.world.num_rooms = 40;
+    config.world.map_width = 200;
+    config.world.map_height = 200;
+    Controller *ctrl = controller_init_with_config(&config);
+    CHECK(ctrl != NULL);
+    if (ctrl == NULL) return;
+    check_full_map(ctrl);
+    controller_free(ctrl);
+}
+
+// libworldgen gives no room a grid cell, so the map follows neighbor_ids.
+static void test_map_of_file_loaded_dungeon(void){
+    char dir[256], path[320];
+    CHECK_EQ_INT(test_temp_dir(dir, sizeof(dir)), 0);
+    snprintf(path, sizeof(path), "%s/world.ini", dir);
+    CHECK_EQ_INT(test_write_file(path, world_ini), 0);
+    Controller *ctrl = controller_init(path);
+    CHECK(ctrl != NULL);
+    if (ctrl != NULL) {
+        CHECK(count_rooms(ctrl) > 1);
+        check_full_map(ctrl);
+
+        // With fog of war only the start room has been seen.
+        MapCanvas *canvas = NULL;
+        CHECK_EQ_INT(map_canvas_create(ctrl, true, &canvas), CONTROLLER_OK);
+        const char *map = NULL;
+        size_t redrawn = 0;
+        if (canvas != NULL) {
+            CHECK_EQ_INT(render_map(ctrl, canvas, &map, &redrawn), CONTROLLER_OK);
+            CHECK_EQ_INT(redrawn, 1);
+            check_map_shape(map);
+            map_canvas_free(canvas);
+        }
+        controller_free(ctrl);
+    }
+    test_remove_dir(dir);
+}
+
+void map_tests(void){
+    RUN_TEST(test_map_of_generated_dungeon);
+    RUN_TEST(test_map_of_file_loaded_dungeon);
+}
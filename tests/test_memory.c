@@ -0,0 +1,150 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "dungeon_controller.h"
+#include "memory_account.h"
+#include "test_util.h"
+#include "worldgen_config.h"
+
+#define THREADS 8
+#define CHARGES 20000
+#define CHUNK 64
+
+static void test_charge_refused_at_budget(void){
+    MemoryAccount account;
+    mem_account_init(&account, 1000);
+    MemoryAccount *previous = mem_account_enter(&account);
+    CHECK(mem_charge(MEM_ROOMS, 600));
+    CHECK(mem_charge(MEM_ENTITIES, 400));       // exactly at the budget
+    CHECK(!mem_charge(MEM_ROOMS, 1));
+    CHECK(!mem_charge(MEM_ROOMS, SIZE_MAX));
+    CHECK(mem_alloc(MEM_RENDER, 16) == NULL);
+    CHECK_EQ_INT(atomic_load(&account.refused), 3);
+    CHECK_EQ_INT(atomic_load(&account.total), 1000);
+    CHECK_EQ_INT(atomic_load(&account.bytes[MEM_RENDER]), 0);
+
+    mem_credit(MEM_ENTITIES, 400);
+    CHECK(mem_charge(MEM_ROOMS, 400));
+    CHECK_EQ_INT(atomic_load(&account.bytes[MEM_ROOMS]), 1000);
+    mem_credit(MEM_ROOMS, 1000);
+    CHECK_EQ_INT(atomic_load(&account.total), 0);
+    CHECK_EQ_INT(atomic_load(&account.peak), 1000);
+    mem_account_enter(previous);
+}
+
+static void test_charges_and_frees_by_category(void){
+    MemoryAccount account;
+    mem_account_init(&account, 0);
+    MemoryAccount *previous = mem_account_enter(&account);
+    void *rooms = mem_alloc(MEM_ROOMS, 100);
+    void *nodes = mem_calloc(MEM_TREE_NODES, 10, 8);
+    void *render = mem_alloc(MEM_RENDER, 30);
+    CHECK(rooms != NULL && nodes != NULL && render != NULL);
+    render = mem_realloc(MEM_RENDER, render, 30, 300);
+    CHECK(render != NULL);
+    CHECK_EQ_INT(atomic_load(&account.bytes[MEM_ROOMS]), 100);
+    CHECK_EQ_INT(atomic_load(&account.bytes[MEM_TREE_NODES]), 80);
+    CHECK_EQ_INT(atomic_load(&account.bytes[MEM_RENDER]), 300);
+    CHECK_EQ_INT(atomic_load(&account.bytes[MEM_ENTITIES]), 0);
+    CHECK_EQ_INT(atomic_load(&account.total), 480);
+    CHECK_EQ_INT(atomic_load(&account.peak), 480);
+
+    mem_free(MEM_ROOMS, rooms, 100);
+    mem_free(MEM_TREE_NODES, nodes, 80);
+    CHECK_EQ_INT(atomic_load(&account.total), 300);
+    mem_free(MEM_RENDER, render, 300);
+    for (int c = 0; c < MEM_CATEGORY_COUNT; c++) CHECK_EQ_INT(atomic_load(&account.bytes[c]), 0);
+    CHECK_EQ_INT(atomic_load(&account.total), 0);
+    CHECK_EQ_INT(atomic_load(&account.peak), 480);
+    CHECK_EQ_INT(atomic_load(&account.refused), 0);
+    mem_account_enter(previous);
+
+    // With no account entered, nothing is counted.
+    void *plain = mem_alloc(MEM_ROOMS, 50);
+    CHECK(plain != NULL);
+    mem_free(MEM_ROOMS, plain, 50);
+    CHECK_EQ_INT(atomic_load(&account.total), 0);
+}
+
+static void *charge_many(void *arg){
+    MemoryAccount *previous = mem_account_enter(arg);
+    for (int i = 0; i < CHARGES; i++) {
+        if (!mem_charge(MEM_ENTITIES, CHUNK)) break;
+        if (i % 2 == 1) mem_credit(MEM_ENTITIES, CHUNK);
+    }
+    mem_account_enter(previous);
+    return NULL;
+}
+
+// Each thread holds at most CHARGES / 2 + 1 chunks at once, so charges that together
+// never exceed the budget must all succeed, however they interleave.
+static void test_concurrent_charges_fill_budget(void){
+    MemoryAccount account;
+    mem_account_init(&account, (size_t)THREADS * (CHARGES / 2 + 1) * CHUNK);
+    pthread_t threads[THREADS];
+    int started = 0;
+    for (; started < THREADS; started++) {
+        if (pthread_create(&threads[started], NULL, charge_many, &account) != 0) break;
+    }
+    CHECK_EQ_INT(started, THREADS);
+    for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+    CHECK_EQ_INT(atomic_load(&account.refused), 0);
+    CHECK_EQ_INT(atomic_load(&account.total), (size_t)started * (CHARGES / 2) * CHUNK);
+    CHECK(atomic_load(&account.peak) <= account.budget);
+}
+
+static void test_controller_stays_within_budget(void){
+    DungeonConfig config;
+    worldgen_config_defaults(&config);
+    config.world.num_rooms = 200;
+    config.world.map_width = 400;
+    config.world.map_height = 400;
+    Controller *ctrl = NULL;
+    CHECK_EQ_INT(controller_init_with_config_budgeted(&config, 0, &ctrl), CONTROLLER_OK);
+    if (ctrl == NULL) return;
+    ControllerMemoryUsage usage;
+    CHECK_EQ_INT(controller_memory_usage(ctrl, &usage), CONTROLLER_OK);
+    CHECK_EQ_INT(usage.tree_nodes + usage.rooms + usage.entities + usage.render + usage.indexes, usage.total);
+    CHECK(usage.rooms >= 200 * sizeof(Room));
+    size_t needed = usage.peak;
+    controller_free(ctrl);
+
+    // Just under what the load needed fails cleanly; what it needed is enough.
+    ctrl = NULL;
+    CHECK_EQ_INT(controller_init_with_config_budgeted(&config, needed / 2, &ctrl), CONTROLLER_ALLOCATION_FAILED);
+    CHECK(ctrl == NULL);
+    CHECK_EQ_INT(controller_init_with_config_budgeted(&config, 10, &ctrl), CONTROLLER_ALLOCATION_FAILED);
+    CHECK_EQ_INT(controller_init_with_config_budgeted(&config, needed, &ctrl), CONTROLLER_OK);
+    if (ctrl != NULL) {
+        CHECK_EQ_INT(controller_memory_usage(ctrl, &usage), CONTROLLER_OK);
+        CHECK(usage.peak <= needed);
+        CHECK_EQ_INT(usage.budget, needed);
+        controller_free(ctrl);
+    }
+}
+
+static void test_budgeted_file_load(void){
+    char dir[256], path[320];
+    CHECK_EQ_INT(test_temp_dir(dir, sizeof(dir)), 0);
+    snprintf(path, sizeof(path), "%s/world.ini", dir);
+    CHECK_EQ_INT(test_write_file(path, "num_rooms=20\nmap_width=80\nmap_height=40\n"), 0);
+    Controller *ctrl = NULL;
+    CHECK_EQ_INT(controller_init_budgeted(path, 10, &ctrl), CONTROLLER_ALLOCATION_FAILED);
+    CHECK(ctrl == NULL);
+    CHECK_EQ_INT(controller_init_budgeted(path, 0, &ctrl), CONTROLLER_OK);
+    if (ctrl != NULL) {
+        ControllerMemoryUsage usage;
+        CHECK_EQ_INT(controller_memory_usage(ctrl, &usage), CONTROLLER_OK);
+        CHECK(usage.rooms > 0 && usage.total > 0);
+        controller_free(ctrl);
+    }
+    test_remove_dir(dir);
+}
+
+void memory_tests(void){
+    RUN_TEST(test_charge_refused_at_budget);
+    RUN_TEST(test_charges_and_frees_by_category);
+    RUN_TEST(test_concurrent_charges_fill_budget);
+    RUN_TEST(test_controller_stays_within_budget);
+    RUN_TEST(test_budgeted_file_load);
+}
@@ -0,0 +1,177 @@
+#include <stdlib.h>
+#include <string.h>
+#include "dungeon_controller.h"
+#include "room.h"
+#include "test_util.h"
+#include "worldgen_config.h"
+
+#define SERIAL_BYTES (64 * 1024)    // BATCH_SERIAL_BYTES in dungeon_controller.c
+
+static Controller *make_controller(int num_rooms, int room_size){
+    DungeonConfig config;
+    worldgen_config_defaults(&config);
+    config.world.num_rooms = num_rooms;
+    config.world.base_room_width = room_size;
+    config.world.base_room_height = room_size;
+    config.world.room_size_variance = 2;
+    config.world.map_width = 20 * (room_size + 3);
+    config.world.map_height = 20 * (room_size + 3);
+    return controller_init_with_config(&config);
+}
+
+// Checks every slice of the batch against a render_room_by_id of the same room.
+static void check_batch_matches_serial(const Controller *ctrl, const int *ids, size_t n,
+                                       const RenderBatch *batch){
+    CHECK_EQ_INT(batch->count, n);
+    CHECK_EQ_INT(batch->offsets[0], 0);
+    CHECK_EQ_INT(batch->offsets[n], batch->size);
+    for (size_t i = 0; i < n && i < batch->count; i++) {
+        char *expected = NULL;
+        CHECK_EQ_INT(render_room_by_id(ctrl, ids[i], &expected), CONTROLLER_OK);
+        if (expected == NULL) continue;
+        const char *got = batch->data + batch->offsets[i];
+        CHECK_EQ_INT(batch->offsets[i + 1] - batch->offsets[i], strlen(expected) + 1);
+        CHECK(strcmp(got, expected) == 0);
+        free(expected);
+    }
+}
+
+// Renders `n` IDs (cycling, so some repeat) in reverse order, after a few ticks.
+static void check_batch(Controller *ctrl, int num_rooms, size_t n, int parallel){
+    int *ids = malloc(n * sizeof(int));
+    CHECK(ids != NULL);
+    if (ids == NULL) return;
+    for (size_t i = 0; i < n; i++) ids[i] = (int)((n - 1 - i) % (size_t)num_rooms);
+    for (int t = 0; t < 3; t++) controller_tick(ctrl);
+    RenderBatch batch;
+    CHECK_EQ_INT(render_rooms_batch(ctrl, ids, n, &batch), CONTROLLER_OK);
+    if (parallel) CHECK(batch.size >= SERIAL_BYTES);
+    else CHECK(batch.size < SERIAL_BYTES);
+    check_batch_matches_serial(ctrl, ids, n, &batch);
+    render_batch_free(&batch);
+    free(ids);
+}
+
+static void test_small_batch_matches_serial(void){
+    Controller *ctrl = make_controller(30, 5);
+    CHECK(ctrl != NULL);
+    if (ctrl == NULL) return;
+    check_batch(ctrl, 30, 30, 0);
+    check_batch(ctrl, 30, 1, 0);
+    controller_free(ctrl);
+}
+
+static void test_large_batch_matches_serial(void){
+    Controller *ctrl = make_controller(200, 30);
+    CHECK(ctrl != NULL);
+    if (ctrl == NULL) return;
+    check_batch(ctrl, 200, 200, 1);
+    check_batch(ctrl, 200, 1000, 1);
+    controller_free(ctrl);
+}
+
+static void test_batch_with_missing_room_renders_nothing(void){
+    Controller *ctrl = make_controller(10, 5);
+    CHECK(ctrl != NULL);
+    if (ctrl == NULL) return;
+    int ids[] = { 0, 1, 999 };
+    RenderBatch batch;
+    CHECK_EQ_INT(render_rooms_batch(ctrl, ids, 3, &batch), CONTROLLER_NOT_FOUND);
+    CHECK(batch.data == NULL && batch.offsets == NULL && batch.count == 0);
+    CHECK_EQ_INT(render_rooms_batch(ctrl, ids, 0, &batch), CONTROLLER_OK);
+    CHECK_EQ_INT(batch.count, 0);
+    render_batch_free(&batch);
+    controller_free(ctrl);
+}
+
+// Every room renders the same from both controllers.
+static void check_same_renders(const Controller *a, const Controller *b, int num_rooms){
+    for (int id = 0; id < num_rooms; id++) {
+        char *ra = NULL, *rb = NULL;
+        CHECK_EQ_INT(render_room_by_id(a, id, &ra), CONTROLLER_OK);
+        CHECK_EQ_INT(render_room_by_id(b, id, &rb), CONTROLLER_OK);
+        CHECK(ra != NULL && rb != NULL && strcmp(ra, rb) == 0);
+        free(ra);
+        free(rb);
+    }
+}
+
+static void test_template_cache_on_and_off_render_alike(void){
+    Controller *cached = make_controller(60, 5);
+    Controller *plain = make_controller(60, 5);
+    CHECK(cached != NULL && plain != NULL);
+    if (cached == NULL || plain == NULL) goto out;
+    CHECK_EQ_INT(controller_set_template_cache_limit(plain, 0), CONTROLLER_OK);
+    check_same_renders(cached, plain, 60);
+
+    // Monsters and the player move on top of the cached backgrounds.
+    unsigned seed = 3;
+    for (int i = 0; i < 50; i++) {
+        seed = seed * 1103515245u + 12345u;
+        Controller *both[] = { cached, plain };
+        for (int c = 0; c < 2; c++) {
+            if (i % 4 == 0) controller_tick(both[c]);
+            else if (i % 4 == 3) move_player_direction(both[c], (Direction)((seed >> 8) % 4));
+            else move_player_within_room(both[c], (int)(seed % 3) - 1, (int)((seed >> 4) % 3) - 1);
+        }
+        check_same_renders(cached, plain, 60);
+    }
+
+    TemplateCacheStats on, off;
+    CHECK_EQ_INT(controller_template_cache_stats(cached, &on), CONTROLLER_OK);
+    CHECK_EQ_INT(controller_template_cache_stats(plain, &off), CONTROLLER_OK);
+    CHECK(on.hits > 0 && on.entries > 0);
+    CHECK_EQ_INT(off.hits, 0);
+    CHECK_EQ_INT(off.entries, 0);
+out:
+    controller_free(cached);
+    controller_free(plain);
+}
+
+// Backgrounds are keyed by size and door layout, so a room whose doors change
+// gets a different one instead of the stale cached copy.
+static void test_template_cache_follows_door_changes(void){
+    Controller *ctrl = make_controller(30, 5);
+    CHECK(ctrl != NULL);
+    if (ctrl == NULL) return;
+    Room *room = NULL;
+    for (int id = 0; id < 30 && room == NULL; id++) {
+        const Room *r;
+        if (get_room_by_id(ctrl, id, &r) == CONTROLLER_OK && r->num_doors > 0) room = (Room *)r;
+    }
+    CHECK(room != NULL);
+    if (room == NULL) { controller_free(ctrl); return; }
+    const Door door = room->doors[room->num_doors - 1];
+    size_t at = (size_t)door.y * (size_t)(room->width + 1) + (size_t)door.x;
+    char *before = NULL, *without = NULL, *after = NULL;
+    CHECK_EQ_INT(render_room_by_id(ctrl, room->id, &before), CONTROLLER_OK);
+
+    TemplateCacheStats s0, s1, s2;
+    controller_template_cache_stats(ctrl, &s0);
+    room->num_doors--;
+    CHECK_EQ_INT(render_room_by_id(ctrl, room->id, &without), CONTROLLER_OK);
+    controller_template_cache_stats(ctrl, &s1);
+    room->num_doors++;
+    CHECK_EQ_INT(render_room_by_id(ctrl, room->id, &after), CONTROLLER_OK);
+    controller_template_cache_stats(ctrl, &s2);
+
+    if (before != NULL && without != NULL && after != NULL) {
+        CHECK(before[at] == TILE_DOOR);
+        CHECK(without[at] == TILE_WALL);
+        CHECK(strcmp(before, after) == 0);
+    }
+    CHECK(s1.misses + s1.bypassed > s0.misses + s0.bypassed);
+    CHECK(s2.hits > s1.hits);
+    free(before);
+    free(without);
+    free(after);
+    controller_free(ctrl);
+}
+
+void render_tests(void){
+    RUN_TEST(test_small_batch_matches_serial);
+    RUN_TEST(test_large_batch_matches_serial);
+    RUN_TEST(test_batch_with_missing_room_renders_nothing);
+    RUN_TEST(test_template_cache_on_and_off_render_alike);
+    RUN_TEST(test_template_cache_follows_door_changes);
+}
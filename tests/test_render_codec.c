@@ -0,0 +1,185 @@
+#include <stdlib.h>
+#include <string.h>
+#include "dungeon_controller.h"
+#include "render_codec.h"
+#include "test_util.h"
+#include "worldgen_config.h"
+
+#define MAX_FRAME 65536
+#define NUM_ROOMS 30
+
+// A frame copied out of the encoder, whose buffer is reused by the next encode.
+typedef struct {
+    uint8_t data[MAX_FRAME];
+    size_t size;
+} Frame;
+
+static Controller *make_controller(void){
+    DungeonConfig config;
+    worldgen_config_defaults(&config);
+    config.world.num_rooms = NUM_ROOMS;
+    config.world.map_width = 200;
+    config.world.map_height = 200;
+    return controller_init_with_config(&config);
+}
+
+static int player_room(const Controller *ctrl){
+    int id = -1;
+    get_player_room_id(ctrl, &id);
+    return id;
+}
+
+static int encode(const Controller *ctrl, int room_id, RenderEncoder *enc, Frame *out){
+    const uint8_t *data = NULL;
+    size_t size = 0;
+    ControllerStatusCode status = render_room_encoded(ctrl, room_id, enc, &data, &size);
+    CHECK_EQ_INT(status, CONTROLLER_OK);
+    CHECK(size >= RENDER_FRAME_HEADER_SIZE && size <= MAX_FRAME);
+    if (status != CONTROLLER_OK || size > MAX_FRAME) return -1;
+    memcpy(out->data, data, size);
+    out->size = size;
+    return 0;
+}
+
+// Checks that the decoder now holds exactly what render_room_by_id returns.
+static void check_matches_render(const Controller *ctrl, const RenderDecoder *dec, int room_id){
+    char *expected = NULL;
+    CHECK_EQ_INT(render_room_by_id(ctrl, room_id, &expected), CONTROLLER_OK);
+    int decoded_id = -1;
+    const char *text = render_decoder_text(dec, &decoded_id);
+    CHECK(text != NULL);
+    CHECK_EQ_INT(decoded_id, room_id);
+    CHECK(expected != NULL && text != NULL && strcmp(text, expected) == 0);
+    free(expected);
+}
+
+static void test_key_frames_round_trip_every_room(void){
+    Controller *ctrl = make_controller();
+    RenderEncoder *enc = render_encoder_create(false);
+    RenderDecoder *dec = render_decoder_create();
+    CHECK(ctrl != NULL && enc != NULL && dec != NULL);
+    if (ctrl == NULL || enc == NULL || dec == NULL) goto out;
+    Frame frame;
+    int rendered = 0;
+    for (int id = 0; id < NUM_ROOMS; id++) {
+        const Room *room;
+        if (get_room_by_id(ctrl, id, &room) != CONTROLLER_OK) continue;
+        if (encode(ctrl, id, enc, &frame) != 0) break;
+        CHECK_EQ_INT(frame.data[1], RENDER_FRAME_KEY);
+        CHECK_EQ_INT(render_decode(dec, frame.data, frame.size), RENDER_CODEC_OK);
+        check_matches_render(ctrl, dec, id);
+        rendered++;
+    }
+    CHECK(rendered > 0);
+out:
+    render_decoder_free(dec);
+    render_encoder_free(enc);
+    controller_free(ctrl);
+}
+
+static void test_deltas_follow_moves_and_ticks(void){
+    Controller *ctrl = make_controller();
+    RenderEncoder *enc = render_encoder_create(true);
+    RenderDecoder *dec = render_decoder_create();
+    CHECK(ctrl != NULL && enc != NULL && dec != NULL);
+    if (ctrl == NULL || enc == NULL || dec == NULL) goto out;
+    Frame frame;
+    int room = player_room(ctrl);
+    if (encode(ctrl, room, enc, &frame) != 0) goto out;
+    CHECK_EQ_INT(frame.data[1], RENDER_FRAME_KEY);
+    CHECK_EQ_INT(render_decode(dec, frame.data, frame.size), RENDER_CODEC_OK);
+    check_matches_render(ctrl, dec, room);
+
+    unsigned seed = 7;
+    for (int i = 0; i < 40; i++) {
+        seed = seed * 1103515245u + 12345u;
+        if (i % 3 == 0) controller_tick(ctrl);
+        else move_player_within_room(ctrl, (int)(seed % 3) - 1, (int)((seed >> 4) % 3) - 1);
+        if (encode(ctrl, room, enc, &frame) != 0) break;
+        CHECK_EQ_INT(frame.data[1], RENDER_FRAME_DELTA);
+        CHECK_EQ_INT(render_decode(dec, frame.data, frame.size), RENDER_CODEC_OK);
+        check_matches_render(ctrl, dec, room);
+    }
+out:
+    render_decoder_free(dec);
+    render_encoder_free(enc);
+    controller_free(ctrl);
+}
+
+static void test_missed_frame_needs_keyframe(void){
+    Controller *ctrl = make_controller();
+    RenderEncoder *enc = render_encoder_create(true);
+    RenderDecoder *dec = render_decoder_create();
+    CHECK(ctrl != NULL && enc != NULL && dec != NULL);
+    if (ctrl == NULL || enc == NULL || dec == NULL) goto out;
+    Frame first, second, third;
+    int room = player_room(ctrl);
+    if (encode(ctrl, room, enc, &first) != 0) goto out;
+    CHECK_EQ_INT(render_decode(dec, first.data, first.size), RENDER_CODEC_OK);
+
+    // The client drops the second frame, so the third has no base.
+    controller_tick(ctrl);
+    if (encode(ctrl, room, enc, &second) != 0) goto out;
+    controller_tick(ctrl);
+    if (encode(ctrl, room, enc, &third) != 0) goto out;
+    CHECK_EQ_INT(third.data[1], RENDER_FRAME_DELTA);
+    CHECK_EQ_INT(render_decode(dec, third.data, third.size), RENDER_CODEC_NEED_KEYFRAME);
+
+    // A fresh decoder that never saw a key frame cannot take a delta either.
+    RenderDecoder *fresh = render_decoder_create();
+    CHECK(fresh != NULL);
+    if (fresh != NULL) {
+        CHECK_EQ_INT(render_decode(fresh, second.data, second.size), RENDER_CODEC_NEED_KEYFRAME);
+        CHECK(render_decoder_text(fresh, NULL) == NULL);
+        render_decoder_free(fresh);
+    }
+
+    render_encoder_reset(enc);
+    Frame key;
+    if (encode(ctrl, room, enc, &key) != 0) goto out;
+    CHECK_EQ_INT(key.data[1], RENDER_FRAME_KEY);
+    CHECK_EQ_INT(render_decode(dec, key.data, key.size), RENDER_CODEC_OK);
+    check_matches_render(ctrl, dec, room);
+out:
+    render_decoder_free(dec);
+    render_encoder_free(enc);
+    controller_free(ctrl);
+}
+
+static void test_truncated_frame_is_corrupt(void){
+    Controller *ctrl = make_controller();
+    RenderEncoder *enc = render_encoder_create(true);
+    RenderDecoder *dec = render_decoder_create();
+    CHECK(ctrl != NULL && enc != NULL && dec != NULL);
+    if (ctrl == NULL || enc == NULL || dec == NULL) goto out;
+    Frame key, delta;
+    int room = player_room(ctrl);
+    if (encode(ctrl, room, enc, &key) != 0) goto out;
+    CHECK_EQ_INT(render_decode(dec, key.data, RENDER_FRAME_HEADER_SIZE - 1), RENDER_CODEC_CORRUPT);
+    CHECK_EQ_INT(render_decode(dec, key.data, key.size - 1), RENDER_CODEC_CORRUPT);
+    CHECK(render_decoder_text(dec, NULL) == NULL);
+
+    // The key frame arrives whole, then a delta is cut short: the decoder
+    // drops its state, and the next delta asks for a key frame.
+    CHECK_EQ_INT(render_decode(dec, key.data, key.size), RENDER_CODEC_OK);
+    controller_tick(ctrl);
+    move_player_within_room(ctrl, 1, 0);
+    if (encode(ctrl, room, enc, &delta) != 0) goto out;
+    CHECK_EQ_INT(delta.data[1], RENDER_FRAME_DELTA);
+    CHECK(delta.size > RENDER_FRAME_HEADER_SIZE);
+    CHECK_EQ_INT(render_decode(dec, delta.data, delta.size - 1), RENDER_CODEC_CORRUPT);
+    controller_tick(ctrl);
+    if (encode(ctrl, room, enc, &delta) != 0) goto out;
+    CHECK_EQ_INT(render_decode(dec, delta.data, delta.size), RENDER_CODEC_NEED_KEYFRAME);
+out:
+    render_decoder_free(dec);
+    render_encoder_free(enc);
+    controller_free(ctrl);
+}
+
+void render_codec_tests(void){
+    RUN_TEST(test_key_frames_round_trip_every_room);
+    RUN_TEST(test_deltas_follow_moves_and_ticks);
+    RUN_TEST(test_missed_frame_needs_keyframe);
+    RUN_TEST(test_truncated_frame_is_corrupt);
+}
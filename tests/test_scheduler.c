@@ -0,0 +1,182 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dungeon_controller.h"
+#include "scheduler.h"
+#include "test_util.h"
+#include "worldgen_config.h"
+
+#define CONTROLLERS 6
+#define COMMANDS 400
+
+// Per-controller bookkeeping for callbacks, which run on worker threads.
+typedef struct {
+    atomic_int next;            // sequence number the next command should carry
+    atomic_int out_of_order;
+    char *last_render;          // from the final SCHED_RENDER_CURRENT
+} Track;
+
+typedef struct {
+    Track *track;
+    int seq;
+} Tag;
+
+static void on_done(const SchedulerResult *result, void *user_data){
+    Tag *tag = user_data;
+    if (atomic_fetch_add(&tag->track->next, 1) != tag->seq) {
+        atomic_fetch_add(&tag->track->out_of_order, 1);
+    }
+    if (result->type == SCHED_RENDER_CURRENT) {
+        free(tag->track->last_render);
+        tag->track->last_render = result->render;
+    } else {
+        free(result->render);
+    }
+    free(result->visited_ids);
+}
+
+static Controller *make_controller(unsigned seed){
+    DungeonConfig config;
+    worldgen_config_defaults(&config);
+    config.world.num_rooms = 30;
+    config.world.map_width = 200;
+    config.world.map_height = 200;
+    config.seed = seed;
+    return controller_init_with_config(&config);
+}
+
+// The i-th command of controller `c`'s script; the same for the reference run.
+static SchedulerCommand script(size_t c, int i){
+    unsigned r = (unsigned)(i * 2654435761u) ^ (unsigned)(c * 40503u);
+    SchedulerCommand cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    if (i == COMMANDS - 1) {
+        cmd.type = SCHED_RENDER_CURRENT;
+    } else if (r % 7 == 0) {
+        cmd.type = SCHED_TICK;
+    } else if (r % 7 == 1) {
+        cmd.type = SCHED_MOVE_DIRECTION;
+        cmd.dir = (Direction)((r >> 8) % 4);
+    } else if (r % 7 == 2) {
+        cmd.type = SCHED_GET_VISITED;
+    } else {
+        cmd.type = SCHED_MOVE_WITHIN_ROOM;
+        cmd.dx = (int)((r >> 4) % 3) - 1;
+        cmd.dy = (int)((r >> 12) % 3) - 1;
+    }
+    return cmd;
+}
+
+static void run_serially(Controller *ctrl, const SchedulerCommand *cmd){
+    switch (cmd->type) {
+    case SCHED_MOVE_WITHIN_ROOM: move_player_within_room(ctrl, cmd->dx, cmd->dy); break;
+    case SCHED_MOVE_DIRECTION:   move_player_direction(ctrl, cmd->dir); break;
+    case SCHED_TICK:             controller_tick(ctrl); break;
+    default:                     break;
+    }
+}
+
+// Commands for one controller run in submission order, interleaved with other
+// controllers', and leave it exactly where a serial run of the same script does.
+static void test_commands_run_in_order_per_controller(void){
+    Controller *ctrls[CONTROLLERS];
+    Controller *reference[CONTROLLERS];
+    for (size_t c = 0; c < CONTROLLERS; c++) {
+        ctrls[c] = make_controller(100u + (unsigned)c);
+        reference[c] = make_controller(100u + (unsigned)c);
+        CHECK(ctrls[c] != NULL && reference[c] != NULL);
+    }
+    Scheduler *sched = scheduler_create(ctrls, CONTROLLERS, 4);
+    CHECK(sched != NULL);
+    Track tracks[CONTROLLERS];
+    Tag *tags = malloc((size_t)CONTROLLERS * COMMANDS * sizeof(Tag));
+    CHECK(tags != NULL);
+    if (sched == NULL || tags == NULL) {
+        scheduler_destroy(sched);
+        free(tags);
+        for (size_t c = 0; c < CONTROLLERS; c++) {
+            if (sched == NULL) controller_free(ctrls[c]);
+            controller_free(reference[c]);
+        }
+        return;
+    }
+    CHECK_EQ_INT(scheduler_count(sched), CONTROLLERS);
+    for (size_t c = 0; c < CONTROLLERS; c++) {
+        atomic_init(&tracks[c].next, 0);
+        atomic_init(&tracks[c].out_of_order, 0);
+        tracks[c].last_render = NULL;
+    }
+
+    // Round-robin submission, so every controller's queue is busy at once.
+    for (int i = 0; i < COMMANDS; i++) {
+        for (size_t c = 0; c < CONTROLLERS; c++) {
+            Tag *tag = &tags[c * COMMANDS + (size_t)i];
+            *tag = (Tag){ &tracks[c], i };
+            SchedulerCommand cmd = script(c, i);
+            cmd.on_complete = on_done;
+            cmd.user_data = tag;
+            CHECK_EQ_INT(scheduler_submit(sched, c, &cmd), CONTROLLER_OK);
+            run_serially(reference[c], &cmd);
+        }
+    }
+    scheduler_drain(sched);
+
+    for (size_t c = 0; c < CONTROLLERS; c++) {
+        CHECK_EQ_INT(atomic_load(&tracks[c].next), COMMANDS);
+        CHECK_EQ_INT(atomic_load(&tracks[c].out_of_order), 0);
+        char *expected = NULL;
+        CHECK_EQ_INT(render_current_room(reference[c], &expected), CONTROLLER_OK);
+        CHECK(expected != NULL && tracks[c].last_render != NULL &&
+              strcmp(expected, tracks[c].last_render) == 0);
+        free(expected);
+        free(tracks[c].last_render);
+
+        int ra = -1, rb = -2;
+        get_player_room_id(scheduler_controller(sched, c), &ra);
+        get_player_room_id(reference[c], &rb);
+        CHECK_EQ_INT(ra, rb);
+        controller_free(reference[c]);
+    }
+
+    SchedulerStats stats;
+    CHECK_EQ_INT(scheduler_get_stats(sched, SCHEDULER_ALL, &stats), CONTROLLER_OK);
+    CHECK_EQ_INT(stats.submitted, (uint64_t)CONTROLLERS * COMMANDS);
+    CHECK_EQ_INT(stats.completed, stats.submitted);
+    CHECK_EQ_INT(stats.queue_depth, 0);
+    CHECK(stats.max_queue_depth >= 1);
+    CHECK(stats.latency_p50_ns <= stats.latency_p99_ns && stats.latency_p99_ns <= stats.latency_max_ns);
+    CHECK_EQ_INT(scheduler_get_stats(sched, 0, &stats), CONTROLLER_OK);
+    CHECK_EQ_INT(stats.completed, COMMANDS);
+    scheduler_destroy(sched);
+    free(tags);
+}
+
+static void test_bad_submissions_are_refused(void){
+    Controller *ctrl = make_controller(7);
+    CHECK(ctrl != NULL);
+    if (ctrl == NULL) return;
+    Scheduler *sched = scheduler_create(&ctrl, 1, 1);
+    CHECK(sched != NULL);
+    if (sched == NULL) { controller_free(ctrl); return; }
+    SchedulerCommand cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.type = SCHED_TICK;
+    CHECK_EQ_INT(scheduler_submit(sched, 1, &cmd), CONTROLLER_INVALID_ARGUMENT);
+    CHECK_EQ_INT(scheduler_submit(sched, 0, NULL), CONTROLLER_INVALID_ARGUMENT);
+    CHECK(scheduler_controller(sched, 1) == NULL);
+    SchedulerStats stats;
+    CHECK_EQ_INT(scheduler_get_stats(sched, 1, &stats), CONTROLLER_INVALID_ARGUMENT);
+
+    // Without a callback, results are freed by the scheduler.
+    cmd.type = SCHED_RENDER_CURRENT;
+    CHECK_EQ_INT(scheduler_submit(sched, 0, &cmd), CONTROLLER_OK);
+    scheduler_drain(sched);
+    CHECK_EQ_INT(scheduler_get_stats(sched, 0, &stats), CONTROLLER_OK);
+    CHECK_EQ_INT(stats.completed, 1);
+    scheduler_destroy(sched);
+}
+
+void scheduler_tests(void){
+    RUN_TEST(test_commands_run_in_order_per_controller);
+    RUN_TEST(test_bad_submissions_are_refused);
+}
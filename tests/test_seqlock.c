@@ -0,0 +1,120 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "dungeon_controller.h"
+#include "test_util.h"
+#include "worldgen_config.h"
+
+#define READERS 4
+#define WRITES 20000
+#define MAX_SEEN 200000
+
+typedef struct {
+    const Controller *ctrl;
+    atomic_bool *done;
+    uint64_t *seen;             // hash of every frame read
+    size_t count;
+    int failed;                 // render calls that did not return CONTROLLER_OK
+} Reader;
+
+static uint64_t hash_frame(const char *s){
+    uint64_t h = 1469598103934665603ull;
+    for (; *s != '\0'; s++) h = (h ^ (unsigned char)*s) * 1099511628211ull;
+    return h;
+}
+
+static int compare_u64(const void *a, const void *b){
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void *read_loop(void *arg){
+    Reader *r = arg;
+    while (!atomic_load_explicit(r->done, memory_order_acquire) && r->count < MAX_SEEN) {
+        char *frame = NULL;
+        if (render_current_room(r->ctrl, &frame) != CONTROLLER_OK) {
+            r->failed++;
+            continue;
+        }
+        r->seen[r->count++] = hash_frame(frame);
+        free(frame);
+    }
+    return NULL;
+}
+
+// Every frame a reader renders while the writer moves and ticks must be one of
+// the frames the writer itself saw between operations; a torn Player or a
+// half-stepped room would render as something else.
+static void test_readers_never_see_torn_state(void){
+    DungeonConfig config;
+    worldgen_config_defaults(&config);
+    config.world.num_rooms = 40;
+    config.world.map_width = 200;
+    config.world.map_height = 200;
+    config.world.base_room_width = 12;
+    config.world.base_room_height = 12;
+    config.world.max_monsters_per_room = 12;
+    config.world.monster_spawn_chance = 100;
+    Controller *ctrl = controller_init_with_config(&config);
+    uint64_t *states = malloc((WRITES + 1) * sizeof(uint64_t));
+    CHECK(ctrl != NULL && states != NULL);
+    if (ctrl == NULL || states == NULL) goto out;
+    // Step every room on every tick, so ticks hold the write side as long as possible.
+    controller_set_active_radius(ctrl, config.world.num_rooms);
+
+    char *frame = NULL;
+    size_t num_states = 0;
+    if (render_current_room(ctrl, &frame) == CONTROLLER_OK) states[num_states++] = hash_frame(frame);
+    free(frame);
+
+    atomic_bool done;
+    atomic_init(&done, false);
+    Reader readers[READERS];
+    pthread_t threads[READERS];
+    int started = 0;
+    for (; started < READERS; started++) {
+        readers[started] = (Reader){ .ctrl = ctrl, .done = &done,
+                                     .seen = malloc(MAX_SEEN * sizeof(uint64_t)) };
+        if (readers[started].seen == NULL ||
+            pthread_create(&threads[started], NULL, read_loop, &readers[started]) != 0) {
+            free(readers[started].seen);
+            break;
+        }
+    }
+    CHECK(started > 0);
+
+    unsigned seed = 99;
+    for (int i = 0; i < WRITES; i++) {
+        seed = seed * 1103515245u + 12345u;
+        unsigned r = (seed >> 16) % 10;
+        if (r < 4) controller_tick(ctrl);
+        else if (r < 8) move_player_within_room(ctrl, (int)(seed % 3) - 1, (int)((seed >> 4) % 3) - 1);
+        else move_player_direction(ctrl, (Direction)((seed >> 8) % 4));
+        frame = NULL;
+        if (render_current_room(ctrl, &frame) == CONTROLLER_OK) states[num_states++] = hash_frame(frame);
+        free(frame);
+    }
+    atomic_store_explicit(&done, true, memory_order_release);
+
+    qsort(states, num_states, sizeof(uint64_t), compare_u64);
+    size_t frames = 0, torn = 0;
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+        CHECK_EQ_INT(readers[t].failed, 0);
+        for (size_t i = 0; i < readers[t].count; i++) {
+            torn += bsearch(&readers[t].seen[i], states, num_states, sizeof(uint64_t), compare_u64) == NULL;
+        }
+        frames += readers[t].count;
+        free(readers[t].seen);
+    }
+    CHECK(frames > 0);
+    CHECK_EQ_INT(torn, 0);
+out:
+    free(states);
+    controller_free(ctrl);
+}
+
+void seqlock_tests(void){
+    RUN_TEST(test_readers_never_see_torn_state);
+}
@@ -0,0 +1,181 @@
+#include <stdlib.h>
+#include <string.h>
+#include "dungeon_loader.h"
+#include "room.h"
+#include "simulation.h"
+#include "test_util.h"
+#include "worldgen_config.h"
+
+#define NUM_ROOMS 60
+
+// A generated dungeon with its own simulation; every World built here holds the same one.
+typedef struct {
+    Tree *tree;
+    Room *rooms[NUM_ROOMS];
+    Simulation *sim;
+    Player player;
+} World;
+
+static int make_world(World *w, int radius){
+    memset(w, 0, sizeof(*w));
+    DungeonConfig config;
+    worldgen_config_defaults(&config);
+    config.world.num_rooms = NUM_ROOMS;
+    config.world.map_width = 300;
+    config.world.map_height = 300;
+    config.world.max_monsters_per_room = 4;
+    config.world.monster_spawn_chance = 100;
+    Room *first = NULL;
+    int count = 0;
+    w->tree = load_dungeon_from_config(&config, &first, &count);
+    if (w->tree == NULL || count != NUM_ROOMS) return -1;
+    TreeIterator *iter = createIterator(w->tree);
+    for (Room *r = nextData(iter); r != NULL; r = nextData(iter)) w->rooms[r->id] = r;
+    destroyIterator(iter);
+    w->sim = simulation_create(w->tree, NUM_ROOMS - 1, radius);
+    w->player.current_room = first;
+    w->player.health = 100;
+    w->player.alive = true;
+    return w->sim != NULL ? 0 : -1;
+}
+
+static void free_world(World *w){
+    simulation_destroy(w->sim);
+    destroyTree(w->tree);
+}
+
+// Puts the player on the first interior tile of `room` holding nothing.
+static void place_player(World *w, int room_id){
+    Room *room = w->rooms[room_id];
+    w->player.current_room = room;
+    for (int y = 1; y < room->height - 1; y++) {
+        for (int x = 1; x < room->width - 1; x++) {
+            bool taken = false;
+            for (int i = 0; i < room->num_monsters; i++)
+                taken |= room->monsters[i].x == x && room->monsters[i].y == y;
+            for (int i = 0; i < room->num_items; i++)
+                taken |= room->items[i].x == x && room->items[i].y == y;
+            if (!taken) {
+                w->player.tile_x = x;
+                w->player.tile_y = y;
+                return;
+            }
+        }
+    }
+}
+
+static int mismatched_monsters(const World *a, const World *b){
+    int wrong = 0;
+    for (int id = 0; id < NUM_ROOMS; id++) {
+        const Room *ra = a->rooms[id], *rb = b->rooms[id];
+        for (int i = 0; i < ra->num_monsters; i++)
+            wrong += ra->monsters[i].x != rb->monsters[i].x || ra->monsters[i].y != rb->monsters[i].y;
+    }
+    return wrong;
+}
+
+// Stepping only the player's room and catching the rest up on demand ends in
+// the same world as stepping every room on every tick.
+static void test_lazy_catch_up_matches_eager_steps(void){
+    World lazy, eager, start;
+    CHECK_EQ_INT(make_world(&lazy, 0), 0);
+    CHECK_EQ_INT(make_world(&eager, NUM_ROOMS), 0);
+    CHECK_EQ_INT(make_world(&start, 0), 0);
+    if (lazy.sim == NULL || eager.sim == NULL || start.sim == NULL) goto out;
+
+    static const int path[] = { 0, 1, 2, 12, 13, 25, 40 };
+    int ticks = 0;
+    for (size_t p = 0; p < sizeof(path) / sizeof(path[0]); p++) {
+        int room = path[p];
+        if (room >= NUM_ROOMS) break;
+        // Entering a room catches it up first, as the controller does.
+        simulation_catch_up(lazy.sim, room, NULL);
+        place_player(&lazy, room);
+        eager.player = lazy.player;
+        eager.player.current_room = eager.rooms[room];
+        for (int t = 0; t < 17 + (int)p * 5; t++) {
+            simulation_step(lazy.sim, &lazy.player);
+            simulation_step(eager.sim, &eager.player);
+            ticks++;
+        }
+        CHECK_EQ_INT(simulation_active_count(lazy.sim), 1);
+        CHECK_EQ_INT(simulation_active_count(eager.sim), NUM_ROOMS);
+    }
+    CHECK_EQ_INT(simulation_tick(lazy.sim), ticks);
+    CHECK(mismatched_monsters(&eager, &start) > 0);    // monsters did move
+    CHECK(mismatched_monsters(&lazy, &eager) > 0);     // distant rooms are still behind
+
+    for (int id = 0; id < NUM_ROOMS; id++) simulation_catch_up(lazy.sim, id, &lazy.player);
+    CHECK_EQ_INT(mismatched_monsters(&lazy, &eager), 0);
+out:
+    free_world(&lazy);
+    free_world(&eager);
+    free_world(&start);
+}
+
+// The active region is the player's room plus everything within `radius` hops.
+static void test_active_region_follows_radius(void){
+    World w;
+    CHECK_EQ_INT(make_world(&w, 0), 0);
+    if (w.sim == NULL) { free_world(&w); return; }
+    place_player(&w, 7);
+    const Room *center = w.rooms[7];
+    simulation_step(w.sim, &w.player);
+    const int *ids;
+    CHECK_EQ_INT(simulation_active_rooms(w.sim, &ids), 1);
+    CHECK_EQ_INT(ids[0], 7);
+
+    CHECK_EQ_INT(simulation_set_radius(w.sim, 1), 0);
+    CHECK_EQ_INT(simulation_set_radius(w.sim, -1), -1);
+    simulation_step(w.sim, &w.player);
+    size_t n = simulation_active_rooms(w.sim, &ids);
+    size_t expected = 1;
+    for (int d = 0; d < NUM_DIRECTIONS; d++) expected += center->neighbor_ids[d] >= 0;
+    CHECK_EQ_INT(n, expected);
+    for (int d = 0; d < NUM_DIRECTIONS; d++) {
+        int nb = center->neighbor_ids[d];
+        bool found = nb < 0;
+        for (size_t i = 0; i < n; i++) found |= ids[i] == nb;
+        CHECK(found);
+    }
+    free_world(&w);
+}
+
+// A saved state restores every monster and the tick counter.
+static void test_save_and_load_state(void){
+    World w, copy;
+    CHECK_EQ_INT(make_world(&w, 2), 0);
+    CHECK_EQ_INT(make_world(&copy, 2), 0);
+    if (w.sim == NULL || copy.sim == NULL) goto out;
+    place_player(&w, 3);
+    for (int t = 0; t < 25; t++) simulation_step(w.sim, &w.player);
+    size_t size = simulation_state_size(w.sim);
+    void *state = malloc(size);
+    CHECK(state != NULL);
+    if (state == NULL) goto out;
+    simulation_save_state(w.sim, state);
+
+    CHECK_EQ_INT(simulation_load_state(copy.sim, state, size), 0);
+    CHECK_EQ_INT(simulation_tick(copy.sim), 25);
+    CHECK_EQ_INT(mismatched_monsters(&w, &copy), 0);
+    CHECK_EQ_INT(simulation_load_state(copy.sim, state, size - 1), -1);
+
+    // Both go on identically from the restored state.
+    copy.player = w.player;
+    copy.player.current_room = copy.rooms[3];
+    for (int t = 0; t < 10; t++) {
+        simulation_step(w.sim, &w.player);
+        simulation_step(copy.sim, &copy.player);
+    }
+    CHECK_EQ_INT(mismatched_monsters(&w, &copy), 0);
+    free(state);
+out:
+    free_world(&w);
+    free_world(&copy);
+}
+
+void simulation_tests(void){
+    RUN_TEST(test_lazy_catch_up_matches_eager_steps);
+    RUN_TEST(test_active_region_follows_radius);
+    RUN_TEST(test_save_and_load_state);
+}
@@ -0,0 +1,224 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dungeon_controller.h"
+#include "test_util.h"
+#include "trace.h"
+#include "worldgen_config.h"
+
+#define THREADS 3
+#define SPANS_PER_THREAD 50
+
+static Controller *make_controller(void){
+    DungeonConfig config;
+    worldgen_config_defaults(&config);
+    config.world.num_rooms = 20;
+    config.world.map_width = 120;
+    config.world.map_height = 120;
+    return controller_init_with_config(&config);
+}
+
+static size_t count_of(const char *text, const char *needle){
+    size_t n = 0;
+    for (const char *p = strstr(text, needle); p != NULL; p = strstr(p + 1, needle)) n++;
+    return n;
+}
+
+static size_t spans_named(const char *json, const char *name){
+    char needle[128];
+    snprintf(needle, sizeof(needle), "{\"name\":\"%s\",", name);
+    return count_of(json, needle);
+}
+
+// Brackets balance outside strings, and the document is one object.
+static bool json_well_formed(const char *json){
+    int depth = 0;
+    bool in_string = false;
+    for (const char *p = json; *p != '\0'; p++) {
+        if (in_string) {
+            if (*p == '\\' && p[1] != '\0') p++;
+            else if (*p == '"') in_string = false;
+        } else if (*p == '"') {
+            in_string = true;
+        } else if (*p == '{' || *p == '[') {
+            depth++;
+        } else if (*p == '}' || *p == ']') {
+            if (--depth < 0) return false;
+        }
+    }
+    return json[0] == '{' && depth == 0 && !in_string;
+}
+
+static char *dump(void){
+    char *json = NULL;
+    size_t len = 0;
+    CHECK_EQ_INT(trace_dump_json(&json, &len), TRACE_OK);
+    if (json != NULL) CHECK_EQ_INT(len, strlen(json));
+    return json;
+}
+
+// While tracing is off, instrumented calls record nothing.
+static void test_nothing_recorded_when_off(void){
+    trace_reset();
+    Controller *ctrl = make_controller();
+    CHECK(ctrl != NULL);
+    if (ctrl == NULL) return;
+    CHECK(!trace_enabled());
+    controller_tick(ctrl);
+    char *frame = NULL;
+    render_current_room(ctrl, &frame);
+    free(frame);
+    char *json = dump();
+    if (json != NULL) {
+        CHECK(json_well_formed(json));
+        CHECK_EQ_INT(count_of(json, "\"ph\":\"X\""), 0);
+        free(json);
+    }
+    controller_free(ctrl);
+}
+
+// Each traced call leaves one span, the load phases included, and nothing after trace_stop.
+static void test_controller_calls_leave_spans(void){
+    CHECK_EQ_INT(trace_start(0), TRACE_OK);
+    CHECK(trace_enabled());
+    Controller *ctrl = make_controller();
+    CHECK(ctrl != NULL);
+    if (ctrl == NULL) {
+        trace_reset();
+        return;
+    }
+    for (int i = 0; i < 5; i++) controller_tick(ctrl);
+    for (int i = 0; i < 3; i++) move_player_within_room(ctrl, 1, 0);
+    char *frame = NULL;
+    render_current_room(ctrl, &frame);
+    free(frame);
+    MapCanvas *canvas = NULL;
+    const char *map = NULL;
+    if (map_canvas_create(ctrl, false, &canvas) == CONTROLLER_OK) {
+        CHECK_EQ_INT(render_map(ctrl, canvas, &map, NULL), CONTROLLER_OK);
+        map_canvas_free(canvas);
+    }
+    trace_stop();
+    CHECK(!trace_enabled());
+    controller_tick(ctrl);
+
+    char *json = dump();
+    if (json != NULL) {
+        CHECK(json_well_formed(json));
+        CHECK(strncmp(json, "{\"traceEvents\":[", 16) == 0);
+        CHECK(strstr(json, "\"dropped_spans\":0}") != NULL);
+        CHECK_EQ_INT(spans_named(json, "controller_tick"), 5);
+        CHECK_EQ_INT(spans_named(json, "move_player_within_room"), 3);
+        CHECK_EQ_INT(spans_named(json, "render_current_room"), 1);
+        CHECK_EQ_INT(spans_named(json, "render_map"), 1);
+        CHECK_EQ_INT(spans_named(json, "load_dungeon"), 1);
+        CHECK(strstr(json, "\"cat\":\"simulation\"") != NULL);
+        CHECK_EQ_INT(count_of(json, "\"ph\":\"M\""), 1);       // one thread, one track
+        free(json);
+    }
+    CHECK_EQ_INT(trace_dropped(), 0);
+    controller_free(ctrl);
+    trace_reset();
+}
+
+// A full buffer keeps its first spans and counts the rest as dropped.
+static void test_full_buffer_drops_and_counts(void){
+    Controller *ctrl = make_controller();
+    CHECK(ctrl != NULL);
+    if (ctrl == NULL) return;
+    CHECK_EQ_INT(trace_start(4), TRACE_OK);
+    for (int i = 0; i < 10; i++) controller_tick(ctrl);
+    trace_stop();
+    CHECK_EQ_INT(trace_dropped(), 6);
+    char *json = dump();
+    if (json != NULL) {
+        CHECK_EQ_INT(spans_named(json, "controller_tick"), 4);
+        CHECK(strstr(json, "\"dropped_spans\":6}") != NULL);
+        free(json);
+    }
+
+    // A new session starts empty.
+    CHECK_EQ_INT(trace_start(4), TRACE_OK);
+    trace_stop();
+    CHECK_EQ_INT(trace_dropped(), 0);
+    controller_free(ctrl);
+    trace_reset();
+}
+
+static void *record_spans(void *arg){
+    (void)arg;
+    for (int i = 0; i < SPANS_PER_THREAD; i++) {
+        TRACE_BEGIN(span);
+        TRACE_END(span, "test", "worker_span");
+    }
+    return NULL;
+}
+
+// Every thread that records gets its own track.
+static void test_threads_get_own_tracks(void){
+    CHECK_EQ_INT(trace_start(0), TRACE_OK);
+    pthread_t threads[THREADS];
+    int started = 0;
+    for (; started < THREADS; started++) {
+        if (pthread_create(&threads[started], NULL, record_spans, NULL) != 0) break;
+    }
+    CHECK_EQ_INT(started, THREADS);
+    for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+    trace_stop();
+    char *json = dump();
+    if (json != NULL) {
+        CHECK(json_well_formed(json));
+        CHECK_EQ_INT(count_of(json, "\"ph\":\"M\""), started);
+        CHECK_EQ_INT(spans_named(json, "worker_span"), (size_t)started * SPANS_PER_THREAD);
+        for (int t = 1; t <= started; t++) {
+            char needle[64];
+            snprintf(needle, sizeof(needle), "\"pid\":1,\"tid\":%d}", t);
+            CHECK_EQ_INT(count_of(json, needle), SPANS_PER_THREAD);
+        }
+        free(json);
+    }
+    trace_reset();
+}
+
+// trace_write saves exactly what trace_dump_json returns.
+static void test_write_matches_dump(void){
+    CHECK_EQ_INT(trace_dump_json(NULL, NULL), TRACE_INVALID_ARGUMENT);
+    CHECK_EQ_INT(trace_write(NULL), TRACE_INVALID_ARGUMENT);
+    CHECK_EQ_INT(trace_start(0), TRACE_OK);
+    record_spans(NULL);
+    trace_stop();
+
+    char dir[256], path[320];
+    CHECK_EQ_INT(test_temp_dir(dir, sizeof(dir)), 0);
+    snprintf(path, sizeof(path), "%s/trace.json", dir);
+    CHECK_EQ_INT(trace_write(path), TRACE_OK);
+    char *json = dump();
+    FILE *f = fopen(path, "r");
+    CHECK(f != NULL && json != NULL);
+    if (f != NULL && json != NULL) {
+        size_t len = strlen(json);
+        char *saved = malloc(len + 2);
+        CHECK(saved != NULL);
+        if (saved != NULL) {
+            size_t got = fread(saved, 1, len + 1, f);
+            CHECK_EQ_INT(got, len);
+            CHECK(memcmp(saved, json, len) == 0);
+            free(saved);
+        }
+    }
+    if (f != NULL) fclose(f);
+    free(json);
+    snprintf(path, sizeof(path), "%s/missing/trace.json", dir);
+    CHECK_EQ_INT(trace_write(path), TRACE_IO_ERROR);
+    test_remove_dir(dir);
+    trace_reset();
+}
+
+void trace_tests(void){
+    RUN_TEST(test_nothing_recorded_when_off);
+    RUN_TEST(test_controller_calls_leave_spans);
+    RUN_TEST(test_full_buffer_drops_and_counts);
+    RUN_TEST(test_threads_get_own_tracks);
+    RUN_TEST(test_write_matches_dump);
+}
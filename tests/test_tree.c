@@ -0,0 +1,215 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include "test_util.h"
+#include "tree.h"
+
+#define N 1000
+
+static int values[N];
+static int destroyed;
+
+static void print_int(const void *data){
+    printf("%d ", *(const int *)data);
+}
+
+static int compare_int(const void *a, const void *b){
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static void count_destroy(void *data){
+    (void)data;
+    destroyed++;
+}
+
+static long long key_int(const void *data){
+    return *(const int *)data;
+}
+
+// Holds the even numbers 0, 2, ..., 2(N-1), inserted in a scrambled order.
+static Tree *make_tree(void){
+    Tree *tree = createTree(print_int, compare_int, count_destroy);
+    if (tree == NULL) return NULL;
+    for (int i = 0; i < N; i++) values[i] = 2 * i;
+    for (int i = 0; i < N; i++) {
+        int at = (int)((i * 7919L) % N);
+        CHECK_EQ_INT(insertData(tree, &values[at]), TREE_OK);
+    }
+    destroyed = 0;
+    return tree;
+}
+
+static bool in_range(int v, int lo, int hi){
+    return v >= lo && v <= hi;
+}
+
+// Checks that the tree holds exactly the values outside [lo, hi], in order.
+static void check_contents(Tree *tree, int lo, int hi){
+    CHECK_EQ_INT(verifyTree(tree), TREE_OK);
+    TreeIterator *iter = createIterator(tree);
+    int expected = 0;
+    int *got;
+    while ((got = iter != NULL ? nextData(iter) : NULL) != NULL) {
+        while (expected < N && in_range(values[expected], lo, hi)) expected++;
+        CHECK(expected < N);
+        if (expected == N) break;
+        CHECK_EQ_INT(*got, values[expected]);
+        expected++;
+    }
+    destroyIterator(iter);
+    while (expected < N && in_range(values[expected], lo, hi)) expected++;
+    CHECK_EQ_INT(expected, N);
+    for (int i = 0; i < N; i++) {
+        bool removed = in_range(values[i], lo, hi);
+        CHECK((findData(tree, &values[i]) == NULL) == removed);
+    }
+}
+
+static size_t expected_removed(int lo, int hi){
+    size_t n = 0;
+    for (int i = 0; i < N; i++) n += in_range(values[i], lo, hi);
+    return n;
+}
+
+static void check_remove_range(int lo, int hi, bool frozen){
+    Tree *tree = make_tree();
+    CHECK(tree != NULL);
+    if (tree == NULL) return;
+    if (frozen) CHECK_EQ_INT(freezeTree(tree, key_int), TREE_OK);
+    size_t count = 12345;
+    CHECK_EQ_INT(removeRange(tree, &lo, &hi, 1, &count), TREE_OK);
+    CHECK_EQ_INT(count, expected_removed(lo, hi));
+    CHECK_EQ_INT(destroyed, count);
+    check_contents(tree, lo, hi);
+    destroyTree(tree);
+}
+
+static void test_insert_keeps_tree_balanced(void){
+    Tree *tree = make_tree();
+    CHECK(tree != NULL);
+    if (tree == NULL) return;
+    check_contents(tree, 1, 0);
+    CHECK_EQ_INT(freezeTree(tree, key_int), TREE_OK);
+    check_contents(tree, 1, 0);
+    destroyTree(tree);
+}
+
+static void test_remove_range_middle(void){
+    check_remove_range(100, 900, false);
+    check_remove_range(101, 899, false);
+    check_remove_range(777, 777, false);
+}
+
+static void test_remove_range_edges(void){
+    check_remove_range(-50, 10, false);
+    check_remove_range(1990, 5000, false);
+    check_remove_range(0, 0, false);
+    check_remove_range(2 * (N - 1), 2 * (N - 1), false);
+}
+
+static void test_remove_range_empty_and_whole(void){
+    check_remove_range(501, 501, false);        // no value in range
+    check_remove_range(10, 5, false);           // lo after hi
+    check_remove_range(5000, 6000, false);      // past the end
+    check_remove_range(0, 2 * (N - 1), false);  // everything
+    check_remove_range(-1, 1 << 30, false);
+}
+
+static void test_remove_range_frozen(void){
+    check_remove_range(300, 1200, true);
+    check_remove_range(0, 2 * (N - 1), true);
+}
+
+// Removing many small slices, one after another, keeps the AVL shape.
+static void test_repeated_remove_range(void){
+    Tree *tree = make_tree();
+    CHECK(tree != NULL);
+    if (tree == NULL) return;
+    size_t left = N;
+    for (int lo = 3; lo < 2 * N; lo += 37) {
+        int hi = lo + 11;
+        size_t count = 0;
+        CHECK_EQ_INT(removeRange(tree, &lo, &hi, 0, &count), TREE_OK);
+        CHECK_EQ_INT(verifyTree(tree), TREE_OK);
+        left -= count;
+    }
+    CHECK_EQ_INT(destroyed, 0);
+    size_t seen = 0;
+    TreeIterator *iter = createIterator(tree);
+    while (iter != NULL && nextData(iter) != NULL) seen++;
+    destroyIterator(iter);
+    CHECK_EQ_INT(seen, left);
+    destroyTree(tree);
+}
+
+// Checks every lookup on a tree holding values[0..n-1] (the even numbers below 2n):
+// each held value is found as the very item stored, and every odd number, one
+// below the smallest and the first past the largest are not.
+static int frozen_misses(Tree *tree, int n){
+    int wrong = 0;
+    for (int i = 0; i < n; i++) wrong += findData(tree, &values[i]) != &values[i];
+    for (int v = -1; v <= 2 * n; v += 2) wrong += findData(tree, &v) != NULL;
+    int past = 2 * n;
+    wrong += findData(tree, &past) != NULL;
+    return wrong;
+}
+
+// Lookups on a frozen tree, with and without integer keys, across sizes that put
+// the last level at every fill and the prefetch bound on both sides of n.
+static void test_frozen_find_all_sizes(void){
+    static void *sorted[N];
+    for (int i = 0; i < N; i++) {
+        values[i] = 2 * i;
+        sorted[i] = &values[i];
+    }
+    static const int large[] = { 127, 128, 129, 255, 256, 257, 511, 512, 513, N };
+    int sizes[80 + sizeof(large) / sizeof(large[0])];
+    int num_sizes = 0;
+    for (int n = 0; n < 80; n++) sizes[num_sizes++] = n;
+    for (size_t i = 0; i < sizeof(large) / sizeof(large[0]); i++) sizes[num_sizes++] = large[i];
+
+    for (int s = 0; s < num_sizes; s++) {
+        int n = sizes[s];
+        Tree *tree = createTreeFromSorted(print_int, compare_int, NULL, sorted, (size_t)n);
+        CHECK(tree != NULL);
+        if (tree == NULL) continue;
+        CHECK_EQ_INT(freezeTree(tree, key_int), TREE_OK);
+        CHECK_EQ_INT(verifyTree(tree), TREE_OK);
+        CHECK_EQ_INT(frozen_misses(tree, n), 0);
+        CHECK_EQ_INT(freezeTree(tree, NULL), TREE_OK);
+        CHECK_EQ_INT(frozen_misses(tree, n), 0);
+        destroyTree(tree);
+    }
+}
+
+// Changing a frozen tree thaws it; it then behaves like any other tree.
+static void test_frozen_tree_thaws_on_change(void){
+    Tree *tree = make_tree();
+    CHECK(tree != NULL);
+    if (tree == NULL) return;
+    CHECK_EQ_INT(freezeTree(tree, key_int), TREE_OK);
+    int odd = 501;
+    CHECK_EQ_INT(insertData(tree, &odd), TREE_OK);
+    CHECK_EQ_INT(verifyTree(tree), TREE_OK);
+    CHECK(findData(tree, &odd) == &odd);
+    CHECK(findData(tree, &values[250]) == &values[250]);
+
+    CHECK_EQ_INT(freezeTree(tree, key_int), TREE_OK);
+    void *removed = NULL;
+    CHECK_EQ_INT(removeData(tree, &odd, &removed), TREE_OK);
+    CHECK(removed == &odd);
+    CHECK_EQ_INT(destroyed, 0);
+    check_contents(tree, 1, 0);
+    destroyTree(tree);
+}
+
+void tree_tests(void){
+    RUN_TEST(test_insert_keeps_tree_balanced);
+    RUN_TEST(test_remove_range_middle);
+    RUN_TEST(test_remove_range_edges);
+    RUN_TEST(test_remove_range_empty_and_whole);
+    RUN_TEST(test_remove_range_frozen);
+    RUN_TEST(test_repeated_remove_range);
+    RUN_TEST(test_frozen_find_all_sizes);
+    RUN_TEST(test_frozen_tree_thaws_on_change);
+}
@@ -0,0 +1,69 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/**
+ * Minimal helpers shared by the unit tests (see tests/test_main.c).
+ *
+ * A failed CHECK reports the file, line and expression and lets the test
+ * carry on, so one run shows every broken expectation. The test binary
+ * exits non-zero if any check failed.
+ */
+
+extern int test_failures;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ_INT(actual, expected) do { \
+        long long a_ = (long long)(actual), e_ = (long long)(expected); \
+        if (a_ != e_) { \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+            test_failures++; \
+        } \
+    } while (0)
+
+/** Runs one test case and reports whether it added failures. */
+void test_run(const char *name, void (*fn)(void));
+
+#define RUN_TEST(fn) test_run(#fn, fn)
+
+/**
+ * Creates a fresh temporary directory and writes its path into `buf`.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int test_temp_dir(char *buf, size_t size);
+
+/** Removes a directory made by test_temp_dir, with the files in it. */
+void test_remove_dir(const char *path);
+
+/**
+ * Writes `text` to `path`, replacing the file.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int test_write_file(const char *path, const char *text);
+
+// Suites, one per test file.
+void journal_tests(void);
+void render_codec_tests(void);
+void tree_tests(void);
+void dungeon_gen_tests(void);
+void config_tests(void);
+void map_tests(void);
+void render_tests(void);
+void fov_tests(void);
+void memory_tests(void);
+void seqlock_tests(void);
+void scheduler_tests(void);
+void simulation_tests(void);
+void trace_tests(void);
+
+#endif // TEST_UTIL_H